@@ -1,117 +1,17 @@
 /*
  * Filename: AVLTree.h
  * Contains: Interface of AVL Trees 
- * 
  */
 
 #pragma once
 
-#include <iostream>
+#include "OrderedTree.h"
 
-#include "BSTNode.h"
-
-class AVLTree
-{
-private:
-    /**
-     * The root of this tree.
-     */
-    BSTNode *root;
-
-public:
-    /**
-     * Default constructor. Creates an empty tree.
-     */
-    AVLTree();
-
-    /**
-     * Copy constructor. Creates a new tree as a deep copy of source
-     */
-    AVLTree(const AVLTree &source);
-
-    /**
-     * Destructor. Frees all memory owned by this.
-     */
-    ~AVLTree();
-
-    /**
-     * Assignment overload. Assigns rhs to this by deep copy.
-     */
-    AVLTree &operator=(const AVLTree &rhs);
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: the minimum value in this
-     * Does: Searches this for its minimum value, and returns it. Behavior is
-     *      undefined if this is empty
-     */
-    int minimum_value() const;
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: the maximum value in this
-     * Does: Searches this for its maximum value, and returns it. Behavior is
-     *      undefined if this is empty
-     */
-    int maximum_value() const;
-
-    /**
-     * Input: AVLTree this - the tree
-     *        int value - value to search for
-     * Returns: the number of occurences of value in this, or 0 if value is not
-     *      in this
-     * Does: searches the tree for value
-     */
-    unsigned int count_of(int value) const;
-
-    /**
-     * Input: AVLTree this - the tree
-     *        int value - value to insert
-     * Returns: N/A
-     * Does: Inserts value into this, either by creating a new node or, if
-     *      value is already in this, by incrementing that node's count
-     */
-    void insert(int value);
-
-    /**
-     * Input: AVLTree this - the tree
-     *        int value - the value to remove
-     * Returns: N/A
-     * Does: Removes value from the tree. If a node's count is greater than
-     *      1, the count is decremented and the node is not removed. Nodes
-     *      with a count of 1 are removed according to the algorithm
-     *      discussed in class, with arbitrary decisions made in the same way
-     *      as the reference implementation.
-     */
-    void remove(int value);
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: the height of this
-     * Does: computes and returns the height of this tree. (An empty tree has
-     *      height -1.)
-     */
-    int tree_height() const;
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: The number of nodes in this tree
-     * Does: Counts and returns the number of nodes in this
-     */
-    int node_count() const;
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: the total of all node values, including duplicates.
-     * Does: Computes and returns the sum of all nodes and duplicates in
-     *      this
-     */
-    int count_total() const;
-
-    /**
-     * Input: AVLTree this - the tree
-     * Returns: N/A
-     * Does: Pretty-prints the tree
-     */
-    void print_tree() const;
-};
+/**
+ * A binary search tree that is kept balanced by the AVL rules: the heights
+ *  of the two subtrees of every node differ by at most one.
+ *  See OrderedTree for its interface.
+ */
+template <typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>, typename Sum = NoSum>
+using AVLTree = OrderedTree<AVLBalance, Key, Value, Compare, Sum>;
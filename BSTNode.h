@@ -1,23 +1,148 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BalancePolicy.h"
+#include "ForkJoinPool.h"
+#include "NodePool.h"
+
+// Packed trees copy the metadata bits of parent_meta verbatim
+class PackedTree;
+
+/**
+ * The Value of a node that carries no payload. It takes no space in a node.
+ */
+struct NoValue
+{
+};
+
+/**
+ * Node Value: the payload of a node, if it has one, kept in a base class so
+ *  that a NoValue payload adds nothing to the size of a node.
+ */
+template <typename Value>
+struct BSTNodeValue
+{
+    Value value;
+
+    BSTNodeValue() : value() {}
+
+    template <typename... Args>
+    explicit BSTNodeValue(Args &&...args) : value(std::forward<Args>(args)...)
+    {
+    }
+};
+
+template <>
+struct BSTNodeValue<NoValue>
+{
+    BSTNodeValue() {}
+};
+
+/**
+ * The Sum of a tree that keeps no subtree sums. It takes no space in a node.
+ */
+struct NoSum
+{
+};
+
+/**
+ * The Sum of a tree that keeps the sum of the keys in every subtree, for
+ *  sum_in_range. Key must be an arithmetic type.
+ */
+struct KeySum
+{
+};
+
+/**
+ * Node Sum: the sum of the keys in the subtree of a node, each counted as
+ *  many times as it occurs, kept in a base class so that a NoSum tree adds
+ *  nothing to the size of a node. It is a 64-bit integer for integral keys
+ *  and a double for floating-point ones.
+ */
+template <typename Key, typename Sum>
+struct BSTNodeSum
+{
+    static_assert(std::is_same<Sum, KeySum>::value,
+                  "a tree's Sum is NoSum or KeySum");
+    static_assert(std::is_arithmetic<Key>::value,
+                  "only trees of arithmetic keys keep sums");
+
+    typedef typename std::conditional<std::is_floating_point<Key>::value,
+                                      double, std::int64_t>::type sum_type;
+
+    sum_type sum;
+
+    BSTNodeSum() : sum() {}
+
+    void add_to_sum(const Key &key, int count)
+    {
+        this->sum += (sum_type)key * count;
+    }
+
+    void resum(const BSTNodeSum &left, const BSTNodeSum &right,
+               const Key &key, int count)
+    {
+        this->sum = left.sum + right.sum + (sum_type)key * count;
+    }
+};
+
+template <typename Key>
+struct BSTNodeSum<Key, NoSum>
+{
+    typedef std::int64_t sum_type;
+
+    void add_to_sum(const Key &, int) {}
+
+    void resum(const BSTNodeSum &, const BSTNodeSum &, const Key &, int) {}
+};
 
 /**
  * Binary Search Tree Node:
- *    - data is the value of this node
+ *    - data is the key of this node; nodes are ordered by Compare, which
+ *      must be default-constructible (it is not stored)
+ *    - value is the payload of this node, unless Value is NoValue. It is
+ *      constructed with the node and left alone when the count changes
  *    - count is the number of times the data has been inserted into the
  *      tree (minus the number of times it has been removed from the tree)
- *    - height is the height of the node within the tree, increasing
- *      from leaf up to the root.
- *    - color is the color of this node (either Color::RED or Color::BLACK)
- *    - left, right are the (possibly NULL) pointers to the left and right
- *      children, respectively
- *    - parent is the (possibly NULL) pointer to the parent node
+ *    - size is the number of nodes in the subtree rooted at this node, and
+ *      total is the sum of their counts. Both are 0 in the nil sentinel,
+ *      and are kept up to date by every insertion, removal and rotation
+ *    - sum is the sum of the keys in that subtree, times their counts, if
+ *      Sum is KeySum (see BSTNodeSum). It is kept up to date the same way
+ *    - left, right are the pointers to the left and right children,
+ *      respectively. An empty child is the shared nil sentinel (see nil()),
+ *      and only the nil sentinel itself has NULL children
+ *    - parent() is the (possibly NULL) pointer to the parent node
+ *    - color() is the color of this node (either Color::RED or
+ *      Color::BLACK); only Red-Black Trees maintain it
+ *    - balance() is the AVL balance factor of this node (the height of the
+ *      right subtree minus that of the left); only AVL Trees maintain it
+ *
+ * Heights are not stored. The parent pointer, color and balance factor share
+ *  one word, which keeps a BSTNode<int> at 40 bytes with its subtree size
+ *  and total, or 48 with its sum. Key and Value must be
+ *  default-constructible, for the nil sentinel.
  */
-class BSTNode
+template <typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>, typename Sum = NoSum>
+class alignas(8) alignas(Key) BSTNode : public BSTNodeValue<Value>,
+                                         public BSTNodeSum<Key, Sum>
 {
 public:
+    typedef Key key_type;
+    typedef Value value_type;
+    typedef Compare key_compare;
+    typedef typename BSTNodeSum<Key, Sum>::sum_type sum_type;
+
     enum Color
     {
         BLACK,
@@ -31,13 +156,19 @@ public:
         RIGHT
     };
 
-    int data;
+    enum SetOperation
+    {
+        UNION,
+        INTERSECTION,
+        DIFFERENCE
+    };
+
+    Key data;
     int count;
-    int height;
-    Color color;
+    unsigned int size;
+    unsigned int total;
     BSTNode *left;
     BSTNode *right;
-    BSTNode *parent;
 
     /**
      * Default Constructor. It is implemented for you, for your convenience.
@@ -47,7 +178,7 @@ public:
      * Does: creates a new node with default values:
      *       - data = [uninitialized]
      *       - count = 0
-     *       - height = -1
+     *       - size, total, sum = 0
      *       - color = BLACK
      *       - left, right, parent = nullptr
      */
@@ -56,17 +187,192 @@ public:
     /**
      * This constructor is implemented for you, for your convenience.
      *
-     * Input: data (the value to store)
+     * Input: data (the key to store)
+     *        args (the arguments to construct the payload from, if any)
      * Returns: a newly-created tree node.
      * Does: creates a new node with default values:
-     *       - data = value
+     *       - data = data, forwarded, so an rvalue key is moved in
+     *       - value = Value(args...)
      *       - count = 1
-     *       - height = 0
+     *       - size, total = 1
+     *       - sum = data
      *       - color = BLACK
-     *       - left, right = [empty tree]
+     *       - balance = 0
+     *       - left, right = nil()
      *       - parent = nullptr
      */
-    BSTNode(int data);
+    template <typename K, typename... Args,
+              typename = typename std::enable_if<!std::is_same<
+                  typename std::decay<K>::type, BSTNode>::value>::type>
+    explicit BSTNode(K &&data, Args &&...args);
+
+    /**
+     * Input: N/A
+     * Returns: the nil sentinel: the single, shared empty tree that stands in
+     *      for every empty subtree of every tree, in the style of CLRS T.nil.
+     *      It is BLACK, has height -1, and is never modified or freed; in
+     *      particular it does not record a parent.
+     */
+    static BSTNode *nil();
+
+    /**
+     * Input: Node root - the root of a tree carved from a NodePool
+     *        ForkJoinPool workers - the pool to destroy the two subtrees of
+     *              a big tree on, or nullptr to destroy them one after the
+     *              other
+     * Returns: N/A
+     * Does: destroys the key and payload of every node of the tree rooted at
+     *      root without freeing the nodes, so that the pool can then release
+     *      them all at once. Does nothing if neither Key nor Value needs its
+     *      destructor run.
+     */
+    static void destroy_in_pool(BSTNode *root, ForkJoinPool *workers);
+
+    /**
+     * Input: Node root - the root of a tree about to be destroyed
+     * Returns: the shared ForkJoinPool if destroy_in_pool has work on root
+     *      worth forking (keys or payloads to destroy, in a tree of at least
+     *      FORK_GRAIN nodes), else nullptr. The shared pool starts its
+     *      workers on first use, so it is not asked for otherwise.
+     */
+    static ForkJoinPool *destroy_workers(const BSTNode *root);
+
+    /**
+     * Input: unsigned int nodes - the number of nodes a copy_into or
+     *              combine works on
+     * Returns: the shared ForkJoinPool if they are at least FORK_GRAIN,
+     *      else nullptr
+     */
+    static ForkJoinPool *fork_workers(unsigned int nodes);
+
+    /**
+     * Input: Node root - the root of a tree
+     *        void *slots - uninitialized memory for root->node_count()
+     *              nodes, one after the other (see NodePool::allocate_block)
+     *        ForkJoinPool workers - the pool to copy the two subtrees of each
+     *              big node on, or nullptr to copy them one after the other
+     * Returns: the root of a copy of the tree rooted at root, with parent
+     *      nullptr, or the nil sentinel if root is empty
+     * Does: copies each node into the slot at its pre-order position, so the
+     *      copy of a node is followed by the copy of its left subtree, then
+     *      of its right subtree. Each subtree thus has a range of slots of
+     *      its own, and the two subtrees of a big node are copied in
+     *      parallel. Runtime: O(n) work, O(h) span
+     */
+    static BSTNode *copy_into(const BSTNode *root, void *slots,
+                              ForkJoinPool *workers);
+
+    /**
+     * Input: ForwardIt first, last - a range of keys in order, possibly with
+     *              duplicates
+     * Returns: the root of a newly-allocated tree holding the keys of the
+     *      range, with parent nullptr, or the nil sentinel if it is empty
+     * Does: builds a perfectly balanced tree in one pass over the distinct
+     *      keys (after one pass to count them), giving each node the number
+     *      of times its key appears in a row, and letting Policy (see
+     *      BalancePolicy.h) set up each node's color or balance factor.
+     *      Nodes are allocated from the current NodePool, if there is one.
+     *      Runtime: O(n)
+     * Assumes: the range is sorted by Compare
+     */
+    template <typename Policy, typename ForwardIt>
+    static BSTNode *build_sorted(ForwardIt first, ForwardIt last);
+
+    /**
+     * Input: Node root - the root of a tree
+     *        ForwardIt first, last - a range of keys in order, possibly with
+     *              duplicates
+     * Returns: the root of a tree holding the keys of both, with parent
+     *      nullptr
+     * Does: merges the range into the tree in one in-order pass, adding to
+     *      the counts of keys already there and allocating nodes for new
+     *      ones, then relinks every node into a perfectly balanced tree as
+     *      build_sorted does. Existing nodes and their payloads stay where
+     *      they are. Runtime: O(n + m) for m keys in the range
+     * Assumes: the range is sorted by Compare
+     */
+    template <typename Policy, typename ForwardIt>
+    static BSTNode *merge_sorted(BSTNode *root, ForwardIt first,
+                                 ForwardIt last);
+
+    /**
+     * Input: Node root - the root of a tree
+     *        ForwardIt first, last - a range of keys in order, possibly with
+     *              duplicates
+     * Returns: the root of the tree without the keys of the range, with
+     *      parent nullptr. This method may return an empty tree.
+     * Does: removes one occurrence of a key for each time it appears in the
+     *      range (keys that run out are removed entirely, and keys that are
+     *      not in the tree are ignored) in one in-order pass, then relinks
+     *      the remaining nodes into a perfectly balanced tree. Runtime:
+     *      O(n + m) for m keys in the range
+     * Assumes: the range is sorted by Compare
+     */
+    template <typename Policy, typename ForwardIt>
+    static BSTNode *subtract_sorted(BSTNode *root, ForwardIt first,
+                                    ForwardIt last);
+
+    /**
+     * Input: Node left - the root of a tree
+     *        Node middle - a single node, with no children, whose key is
+     *              ordered after every key of left
+     *        Node right - the root of a tree whose keys are all ordered
+     *              after middle's
+     * Returns: the root of one tree holding the nodes of all three, with
+     *      parent nullptr
+     * Does: hangs middle, with the shorter tree as one child, at the point
+     *      of the inner edge of the taller tree where the other child is as
+     *      tall, and lets Policy (see BalancePolicy.h) rebalance on the way
+     *      back up, as after an insertion. Nothing is allocated or copied.
+     *      Runtime: O(log n) for AVL and Red-Black trees
+     */
+    template <typename Policy>
+    static BSTNode *join(BSTNode *left, BSTNode *middle, BSTNode *right);
+
+    /**
+     * Input: Node root - the root of a tree
+     *        Key value - the key to split at
+     *        Node less - set to the root of a tree of the nodes of root
+     *              whose keys are ordered before value, with parent nullptr
+     *        Node greater - set to the root of a tree of the nodes whose
+     *              keys are ordered after value, with parent nullptr
+     * Returns: the node of root holding value, with no children and parent
+     *      nullptr, or an empty tree if value is not in the tree
+     * Does: walks down to value, then joins the subtrees hanging off the
+     *      path on its way back up, each with the path node above it, into
+     *      less or greater. Nothing is allocated or copied.
+     *      Runtime: O(log n) for AVL and Red-Black trees
+     */
+    template <typename Policy>
+    static BSTNode *split(BSTNode *root, const Key &value, BSTNode *&less,
+                          BSTNode *&greater);
+
+    /**
+     * Input: SetOperation op - the operation to apply
+     *        Node a, b - the roots of two trees
+     *        vector dropped - the nodes that end up in neither tree are
+     *              appended to it, each as the root of a subtree to delete
+     *        ForkJoinPool workers - the pool to run the two halves of each
+     *              step on, or nullptr to run them one after the other
+     * Returns: the root of a tree, with parent nullptr, of
+     *        - UNION: every key of a or b, with the counts of keys in both
+     *          summed
+     *        - INTERSECTION: the keys in both a and b, with their counts
+     *          summed
+     *        - DIFFERENCE: the keys of a, with the count of each key in b
+     *          taken from it; keys whose count runs out are dropped
+     * Does: splits b at the key of the root of a, combines the left subtree
+     *      of a with the lower part and the right subtree with the upper part
+     *      (in parallel, if both trees together are big enough), then joins
+     *      the two results at the root of a, or without it if it is dropped.
+     *      Nodes are relinked, not copied, and keep their payloads; the node
+     *      of a is kept for a key in both. Work: O(m log(n/m + 1)) for trees
+     *      of m <= n nodes; span: O(log^2 n), for AVL and Red-Black trees
+     */
+    template <typename Policy>
+    static BSTNode *combine(SetOperation op, BSTNode *a, BSTNode *b,
+                            std::vector<BSTNode *> &dropped,
+                            ForkJoinPool *workers);
 
     /**
      * Copy constructor
@@ -75,7 +381,7 @@ public:
      * Does: creates a new node with the same properties as other by performing
      *      a pre-order deep copy of the tree rooted at other. The root of the
      *      new tree has parent nullptr (it is considered the ultimate root of
-     *      its tree).
+     *      its tree). Empty subtrees of other become nil() in the copy.
      */
     BSTNode(const BSTNode &other);
 
@@ -84,11 +390,22 @@ public:
      * Input: Node this - the node to free
      * Returns: N/A
      * Does: Performs a post-order delete to free all memory owned by this.
+     *      The nil sentinel is never deleted.
      *
      * Remember: this is automatically freed at the end of a destructor.
      */
     ~BSTNode();
 
+    /**
+     * Allocation functions.
+     *
+     * While a NodePool::Scope is active on the calling thread, nodes are
+     *  carved from (and returned to) that pool instead of the global heap.
+     *  A node must be deleted under the same pool it was allocated from.
+     */
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
     /**
      * This function is implemented for you, for your convenience.
      *
@@ -119,73 +436,131 @@ public:
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value for which to search in the tree
+     *        Key value - the key for which to search in the tree
      * Returns: a pointer to the node with value in the tree rooted at this
      * Does: performs a search in the tree rooted at this and returns the
      *      node with that value in the tree, or an empty tree if the value
      *      does not appear in the tree rooted at this.
      */
-    const BSTNode *search(int value) const;
+    const BSTNode *search(const Key &value) const;
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value to insert
+     *        Key value - the key to search for
+     * Returns: a pointer to the node with the smallest key that is not
+     *      ordered before value in the tree rooted at this, or an empty tree
+     *      if there is none
+     */
+    const BSTNode *lower_bound(const Key &value) const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key value - the key to search for
+     * Returns: a pointer to the node with the smallest key that is ordered
+     *      after value in the tree rooted at this, or an empty tree if there
+     *      is none
+     */
+    const BSTNode *upper_bound(const Key &value) const;
+
+    /**
+     * Input: Node this - a non-empty node
+     * Returns: a pointer to the node that follows this in order in its tree,
+     *      or an empty tree if this holds the maximum
+     * Does: goes to the minimum of the right subtree, or else climbs the
+     *      parent pointers until it leaves a left subtree. Runtime: O(1)
+     *      amortized over a whole traversal
+     */
+    const BSTNode *successor() const;
+
+    /**
+     * Input: Node this - a non-empty node
+     * Returns: a pointer to the node that precedes this in order in its
+     *      tree, or an empty tree if this holds the minimum
+     * Does: the mirror image of successor()
+     */
+    const BSTNode *predecessor() const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        K value - the key to insert, forwarded to the new node
+     *        Args args - the payload arguments, used only if value is new
      * Returns: a pointer to the root of the tree into which value has just
      *      been inserted, with parent `nullptr`
      * Does: inserts (a single occurrence of) value into the tree rooted at
      *      this. Uses the "naive BST" insertion algorithm.
      */
-    BSTNode *insert(int value);
+    template <typename K, typename... Args>
+    BSTNode *insert(K &&value, Args &&...args);
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value to insert
+     *        K value - the key to insert, forwarded to the new node
+     *        Args args - the payload arguments, used only if value is new
      * Returns: a pointer to the root of the tree into which value has just
      *      been inserted, with parent `nullptr`. The returned tree is an AVL
      *      Tree.
      * Does: inserts (a single occurrence of) value into the tree rooted at
-     *      this. Uses the AVL Tree insertion algorithm.
+     *      this. Uses the AVL Tree insertion algorithm, keeping every
+     *      node's balance factor up to date.
      */
-    BSTNode *avl_insert(int value);
+    template <typename K, typename... Args>
+    BSTNode *avl_insert(K &&value, Args &&...args);
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value to insert
+     *        K value - the key to insert, forwarded to the new node
+     *        Args args - the payload arguments, used only if value is new
      * Returns: a pointer to the root of the tree into which value has just
      *      been inserted, with parent `nullptr`. The returned tree is a
      *      Red-Black Tree.
      * Does: inserts (a single occurrence of) value into the tree rooted at
      *      this. Uses the Red-Black Tree insertion algorithm.
      */
-    BSTNode *rb_insert(int value);
+    template <typename K, typename... Args>
+    BSTNode *rb_insert(K &&value, Args &&...args);
+
+    /**
+     * Input: Node this - the root of the tree
+     *        K value - the key to insert, forwarded to the new node
+     *        Args args - the payload arguments, used only if value is new
+     * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted, with parent `nullptr`. The returned tree is a
+     *      Red-Black Tree, except that its root may be RED.
+     * Does: inserts (a single occurrence of) value into the tree rooted at
+     *      this in a single pass down, splitting 4-nodes on the way, as in
+     *      Guibas and Sedgewick's top-down Red-Black Tree insertion.
+     */
+    template <typename K, typename... Args>
+    BSTNode *rb_insert_top_down(K &&value, Args &&...args);
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value to remove
+     *        Key value - the key to remove
      * Returns: a pointer to the root of the tree from which value has just
      *      been removed, whose parent pointer is `nullptr`. This method may
      *      return an empty tree.
      * Does: removes (a single occurrence of) value from the tree rooted at
      *      this. Uses the "naive BST" removal algorithm.
      */
-    BSTNode *remove(int value);
+    BSTNode *remove(const Key &value);
 
     /**
      * Input: Node this - the root of the tree
-     *        int value - the value to remove
+     *        Key value - the key to remove
      * Returns: a pointer to the root of the tree from which value has just
      *      been removed, whose parent pointer is `nullptr`. This method may
      *      return an empty tree. The returned tree is an AVL Tree.
      * Does: removes (a single occurrence of) value from the tree rooted at
-     *      this. Uses the AVL Tree removal algorithm.
+     *      this. Uses the AVL Tree removal algorithm, keeping every node's
+     *      balance factor up to date.
      */
-    BSTNode *avl_remove(int value);
+    BSTNode *avl_remove(const Key &value);
 
     /**
      * This function is implemented for you, for your convenience.
      *
      * Input: Node this - the root of the tree
-     *        int value - the value to remove
+     *        Key value - the key to remove
      *        Neighborhood nb - reference to a BHV Neighborhood; value is
      *              replaced with the neighborhood of the removed node.
      * Returns: a pointer to the root of the tree from which value has just
@@ -194,27 +569,110 @@ public:
      * Does: removes (a single occurrence of) value from the tree rooted at
      *      this. Uses the Red-Black Tree removal algorithm.
      */
-    BSTNode *rb_remove(int value);
+    BSTNode *rb_remove(const Key &value);
+
+    /**
+     * Input: Node this - the root of the tree
+     *        bool grew - set to whether the tree rooted at this got taller
+     *        K value - the key to insert, forwarded to the new node
+     *        Args args - the payload arguments, used only if value is new
+     * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted
+     * Does: inserts (a single occurrence of) value into the tree rooted at
+     *      this, letting Policy (see BalancePolicy.h) rebalance each node on
+     *      the way back up. Runs in a loop, not by recursion.
+     */
+    template <typename Policy, typename K, typename... Args>
+    BSTNode *insert_with(bool &grew, K &&value, Args &&...args);
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key value - the key to remove
+     *        bool shrank - set to whether the tree rooted at this got shorter
+     * Returns: a pointer to the root of the tree from which value has just
+     *      been removed. This method may return an empty tree.
+     * Does: removes (a single occurrence of) value from the tree rooted at
+     *      this, letting Policy rebalance each node on the way back up. Runs
+     *      in a loop, not by recursion.
+     */
+    template <typename Policy>
+    BSTNode *remove_with(const Key &value, bool &shrank);
 
     /**
      * Input: Node this - the root of the tree
      * Returns: the height of the tree rooted at this (an empty tree has height
      *      -1).
+     * Does: visits every node, since heights are not stored. Runtime: O(n)
      */
     int node_height() const;
 
+    /**
+     * Input: Node this - the root of an AVL Tree
+     * Returns: the height of the tree rooted at this (an empty tree has height
+     *      -1).
+     * Does: follows the taller child down one path, as told by the balance
+     *      factors. Runtime: O(log n)
+     */
+    int avl_height() const;
+
     /**
      * Input: Node this - the root of the tree
      * Returns: the number of non-empty nodes in the tree rooted at this
+     * Does: reads this->size. Runtime: O(1)
      */
     unsigned int node_count() const;
 
     /**
      * Input: Node this - the root of the tree
      * Returns: the total of all counts in the tree rooted at this
+     * Does: reads this->total. Runtime: O(1)
      */
     unsigned int count_total() const;
 
+    /**
+     * Input: Node this - the root of the tree
+     *        Key value - the key to rank
+     * Returns: the number of occurrences (duplicates included) of keys in the
+     *      tree rooted at this that are ordered before value, whether or not
+     *      value itself is in the tree
+     * Does: walks one path down, adding up the totals of the left subtrees
+     *      it passes. Runtime: O(height)
+     */
+    unsigned int rank(const Key &value) const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        unsigned int k - a position, counting from 0
+     * Returns: the node holding the k-th smallest occurrence (duplicates
+     *      included) in the tree rooted at this, or an empty tree if k is not
+     *      less than count_total()
+     * Does: walks one path down, steering by the totals of the left
+     *      subtrees. Runtime: O(height)
+     */
+    const BSTNode *select(unsigned int k) const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the number of occurrences (duplicates included) of keys from
+     *      lo to hi in the tree rooted at this, or 0 if hi is ordered before
+     *      lo
+     * Does: ranks both bounds. Runtime: O(height)
+     */
+    unsigned int count_in_range(const Key &lo, const Key &hi) const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the sum of the keys from lo to hi in the tree rooted at this,
+     *      each added as many times as it occurs, or 0 if hi is ordered
+     *      before lo
+     * Does: adds up the sums of the subtrees before each bound, as rank
+     *      does the totals. Runtime: O(height)
+     * Assumes: Sum is KeySum
+     */
+    sum_type sum_in_range(const Key &lo, const Key &hi) const;
+
     /**
      * Input: Node this - the node whose parent we are searching for
      *        Node root - the root of the tree in which to search
@@ -254,7 +712,252 @@ public:
      */
     void set_child(Direction dir, BSTNode *child);
 
+    /**
+     * Input: Node this - the node
+     * Returns: the parent of this, or nullptr if this is a root or empty
+     */
+    BSTNode *parent() const;
+
+    /**
+     * Input: Node this - the node
+     *        Node parent - the new parent of this
+     * Returns: N/A
+     * Does: sets the parent of this, keeping its color and balance factor
+     */
+    void set_parent(BSTNode *parent);
+
+    /**
+     * Input: Node this - the node
+     * Returns: the color of this. Empty trees and nodes of trees that are not
+     *      Red-Black Trees are BLACK.
+     */
+    Color color() const;
+
+    /**
+     * Input: Node this - the node
+     *        Color color - the new color
+     * Returns: N/A
+     * Does: sets the color of this, keeping its parent and balance factor
+     * Assumes: this is not empty, unless color is BLACK
+     */
+    void set_color(Color color);
+
 private:
+    friend class PackedTree;
+
+    // The balance policies drive the private rebalancing steps below
+    friend struct NaiveBalance;
+    friend struct AVLBalance;
+    friend struct RBBalance;
+
+    /**
+     * Input: a, b - two keys, or values comparable with keys
+     * Returns: true iff a is ordered before b
+     */
+    template <typename A, typename B>
+    static bool key_less(const A &a, const B &b);
+
+    /**
+     * Input: Direction dir
+     * Returns: the opposite of dir, or ROOT if dir is ROOT.
+     */
+    static Direction opposite_direction(Direction dir);
+
+    /**
+     * Input: Node a
+     *        Node b
+     * Returns: N/A
+     * Does: Swaps the colors of Nodes a and b.
+     * Assumes: a and b are both non-null
+     */
+    static void swap_colors(BSTNode *a, BSTNode *b);
+
+    /**
+     * Input: Node a
+     *        Node b
+     * Returns: N/A
+     * Does: Swaps the keys, payloads and counts of Nodes a and b, leaving
+     *      their places in the tree alone. Nothing is copied.
+     * Assumes: a and b are both non-empty
+     */
+    static void swap_entries(BSTNode *a, BSTNode *b);
+
+    /**
+     * Input: NextNode next - called with no arguments, returns the next node
+     *              of the new tree in order, with its key and count set
+     *        unsigned int n - the number of nodes to take from next
+     *        int depth - the depth of the root of the new subtree
+     *        int levels - the number of complete levels of the whole tree
+     *        int height - set to the height of the new subtree
+     * Returns: the root of a perfectly balanced tree of the next n nodes,
+     *      with parent pointer undefined
+     * Does: builds the left half, then takes the middle node, then builds
+     *      the right half, so the nodes are taken in order. Each node's
+     *      links, metadata and aggregates are overwritten. Runtime: O(n)
+     */
+    template <typename Policy, typename NextNode>
+    static BSTNode *build_balanced(NextNode &next, unsigned int n, int depth,
+                                   int levels, int &height);
+
+    /**
+     * Input: NextNode next - as for build_balanced
+     *        unsigned int n - the number of nodes to take from next
+     * Returns: the root of a perfectly balanced tree of the next n nodes,
+     *      with parent nullptr, or the nil sentinel if n is 0
+     */
+    template <typename Policy, typename NextNode>
+    static BSTNode *build_balanced(NextNode &next, unsigned int n);
+
+    /**
+     * Input: Node root - the root of a tree
+     *        int height - the join_height of root (see BalancePolicy.h)
+     *        Key value - the key to split at
+     *        Node less, greater - set as for split
+     *        int less_height, greater_height - set to the join_heights of
+     *              less and greater
+     * Returns: as split
+     */
+    template <typename Policy>
+    static BSTNode *split_measured(BSTNode *root, int height, const Key &value,
+                                   BSTNode *&less, int &less_height,
+                                   BSTNode *&greater, int &greater_height);
+
+    /**
+     * Input: Node left, right - the roots of two trees, every key of left
+     *              ordered before every key of right
+     *        int left_height, right_height - their join_heights
+     *        int height - set to the join_height of the joined tree
+     * Returns: the root of a tree of the nodes of both
+     * Does: splits the minimum off right and joins the three
+     */
+    template <typename Policy>
+    static BSTNode *join_two(BSTNode *left, int left_height, BSTNode *right,
+                             int right_height, int &height);
+
+    /**
+     * Input: as the public combine, with the join_heights of a and b
+     *        int height - set to the join_height of the combined tree
+     * Returns: the root of the combined tree, with parent pointer undefined
+     */
+    template <typename Policy>
+    static BSTNode *combine(SetOperation op, BSTNode *a, int a_height,
+                            BSTNode *b, int b_height, int &height,
+                            std::vector<BSTNode *> &dropped,
+                            ForkJoinPool *workers);
+
+    /**
+     * Input: Node other - the node to copy
+     *        Node left, right - the children of the copy
+     *        Node parent - the parent of the copy, or nullptr
+     * Returns: a copy of the key, payload, counts and metadata of other
+     *      alone, linked to the given nodes
+     */
+    BSTNode(const BSTNode &other, BSTNode *left, BSTNode *right,
+            BSTNode *parent);
+
+    /**
+     * Input: Node source - a non-empty node
+     *        Node slots - uninitialized memory for the nodes of source
+     *        Node parent - the parent of the copy, or nullptr
+     *        ForkJoinPool workers - as for copy_into
+     * Returns: N/A
+     * Does: copies the tree rooted at source into slots, in pre-order
+     */
+    static void copy_subtree(const BSTNode *source, BSTNode *slots,
+                             BSTNode *parent, ForkJoinPool *workers);
+
+    /**
+     * Input: Node left, middle, right - as for join
+     * Returns: middle, with parent nullptr
+     * Does: makes left and right the children of middle and recounts it.
+     *      middle's metadata is cleared, so it is BLACK and balanced.
+     */
+    static BSTNode *link(BSTNode *left, BSTNode *middle, BSTNode *right);
+
+    /**
+     * Input: Node root - the root of the taller tree of a join
+     *        Node up - a node on the dir edge of root's tree
+     *        Node middle - the node to hang, with its metadata set
+     *        Node other - the shorter tree of the join
+     *        Direction dir - RIGHT if root's tree is the left one of the
+     *              join, and LEFT otherwise
+     *        bool grew - set to whether the joined tree is taller than
+     *              root's tree was
+     * Returns: the root of the joined tree, with parent nullptr
+     * Does: makes middle the dir child of up, with up's old dir child on
+     *      the other side of it and other on the dir side, recounts the
+     *      path up to root, then climbs it as insert_with does, handing
+     *      each node to Policy::after_insert until nothing above can change
+     */
+    template <typename Policy>
+    static BSTNode *graft(BSTNode *root, BSTNode *up, BSTNode *middle,
+                          BSTNode *other, Direction dir, bool &grew);
+
+    /**
+     * Input: Node left, middle, right - as for join, where left and right
+     *              are AVL Trees
+     *        int left_height, right_height - the heights of left and right
+     *        int height - set to the height of the joined tree
+     * Returns: the root of the joined AVL Tree, with parent nullptr
+     * Does: descends the taller tree until the rest of its inner edge is at
+     *      most one level taller than the shorter tree, then grafts middle
+     *      there, leaving avl_balance to fix the balance factors on the way
+     *      back up. Runtime: O(difference of the heights + 1)
+     */
+    static BSTNode *avl_join(BSTNode *left, int left_height, BSTNode *middle,
+                             BSTNode *right, int right_height, int &height);
+
+    /**
+     * Input: Node left, middle, right - as for join, where left and right
+     *              are Red-Black Trees, except that their roots may be RED
+     *        int left_height, right_height - the black-heights of left and
+     *              right once their roots are BLACK
+     *        int height - set to the black-height of the joined tree
+     * Returns: the root of the joined Red-Black Tree, which is BLACK and has
+     *      parent nullptr
+     * Does: blackens both roots, descends the taller tree to a BLACK node of
+     *      the shorter one's black-height, then grafts middle there as a RED
+     *      node, leaving rb_eliminate_red_red_violation to fix any red-red
+     *      violation on the way back up. Runtime: O(difference of the
+     *      black-heights + 1)
+     */
+    static BSTNode *rb_join(BSTNode *left, int left_height, BSTNode *middle,
+                            BSTNode *right, int right_height, int &height);
+
+    /**
+     * Input: Node this - the root of a Red-Black tree
+     * Returns: the number of BLACK nodes on each path down from this, not
+     *      counting the nil sentinel. Runtime: O(log n)
+     */
+    int rb_black_height() const;
+
+    /**
+     * Input: Node root - the root of a tree
+     *        vector nodes - the vector to append to
+     * Returns: N/A
+     * Does: appends the nodes of the tree rooted at root, in order
+     */
+    static void append_in_order(BSTNode *root, std::vector<BSTNode *> &nodes);
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key bound - the key to stop at
+     *        bool inclusive - whether occurrences of bound itself are taken
+     * Returns: the number of occurrences of keys ordered before bound (or,
+     *      if inclusive, not after it) in the tree rooted at this
+     */
+    unsigned int count_before(const Key &bound, bool inclusive) const;
+
+    /**
+     * Input: Node this - the root of the tree
+     *        Key bound - the key to stop at
+     *        bool inclusive - whether occurrences of bound itself are taken
+     * Returns: the sum of the occurrences of keys ordered before bound (or,
+     *      if inclusive, not after it) in the tree rooted at this
+     * Assumes: Sum is KeySum
+     */
+    sum_type sum_before(const Key &bound, bool inclusive) const;
+
     enum Shape
     {
         SHAPE_NONE,
@@ -409,6 +1112,16 @@ private:
          */
         BHVNeighborhood(BSTNode *p, Direction dir);
 
+        /**
+         * Input: Neighborhood this - a neighborhood with p and dir set
+         * Returns: N/A
+         * Does: recomputes s, c, d and del_case from p and dir alone. Once n
+         *  has been deleted, p's child towards dir is the nil sentinel, which
+         *  does not know its parent, so the neighborhood can only be
+         *  re-examined from above.
+         */
+        void find_case();
+
         /**
          * This function is implemented for you, for your convenience.
          *
@@ -426,18 +1139,18 @@ private:
      * This function is implemented for you, for your convenience.
      *
      * Input: Node this - the root of the tree
-     *        int value - the value to remove
+     *        Key value - the key to remove
      *        Neighborhood nb - reference to a BHV Neighborhood; value is
      *              replaced with the neighborhood of the removed node (after
-     *              this function, nb.n and nb.p's child to nb.dir are each an
-     *              invalid pointer, pointing to the deleted node).
+     *              this function, nb.n is an invalid pointer, pointing to the
+     *              deleted node, and nb.p's child to nb.dir is empty).
      * Returns: a pointer to the root of the tree from which value has just
      *      been removed, whose parent pointer is `nullptr`. This method may
      *      return an empty tree. The returned tree is a Red-Black Tree.
      * Does: removes (a single occurrence of) value from the tree rooted at
      *      this. Uses the Red-Black Tree removal algorithm.
      */
-    BSTNode *rb_remove_helper(int value, BHVNeighborhood &nb);
+    BSTNode *rb_remove_helper(const Key &value, BHVNeighborhood &nb);
 
     /**
      * This function is implemented for you, for your convenience.
@@ -473,12 +1186,35 @@ private:
 
     /**
      * Input: Node this - the root of an almost-balanced AVL Tree.
+     *        int balance - the new balance factor of this, from -2 to 2
      * Returns: the balanced tree.
-     * Does: If unbalanced, balances the tree rooted at node.
-     * Assumes: the height difference between this's left and right children
-     *      is no more than 2.
+     * Does: If balance is -2 or 2, balances the tree rooted at node with a
+     *      single or double rotation and sets the balance factors of the
+     *      rotated nodes. Otherwise just stores balance in this.
+     * Assumes: the children of this are AVL Trees with correct balance
+     *      factors.
+     */
+    BSTNode *avl_balance(int balance);
+
+    /**
+     * Input: Node this - the root of an AVL Tree
+     *        Direction dir - the side whose subtree just grew by one level
+     *        bool grew - set to whether the tree rooted at this grew
+     * Returns: the root of the rebalanced tree
+     * Does: updates the balance factor of this after an insertion below it,
+     *      rotating if needed.
+     */
+    BSTNode *avl_regrow(Direction dir, bool &grew);
+
+    /**
+     * Input: Node this - the root of an AVL Tree
+     *        Direction dir - the side whose subtree just shrank by one level
+     *        bool shrank - set to whether the tree rooted at this shrank
+     * Returns: the root of the rebalanced tree
+     * Does: updates the balance factor of this after a removal below it,
+     *      rotating if needed.
      */
-    BSTNode *avl_balance();
+    BSTNode *avl_reshrink(Direction dir, bool &shrank);
 
     /**
      * Input: Node this - the root of a Red-Black tree.
@@ -498,25 +1234,85 @@ private:
     BSTNode *rb_eliminate_red_red_violation();
 
     /**
-     * This function is implemented for you, for your convenience.
-     *
+     * Input: Node node - a RED node of a Red-Black tree
+     * Returns: N/A
+     * Does: If node's parent is RED too, rotates so that a BLACK node is the
+     *      parent of both. Used by rb_insert_top_down.
+     * Assumes: node's grandparent is BLACK and its other child is BLACK
+     */
+    static void rb_fix_top_down(BSTNode *node);
+
+    /**
      * Input: Node this - the root of the tree.
-     * Returns: integer value signifying the height difference.
-     * Does: calculates the difference in the height of the left and right
-     *      subtree of this, computed as (this.right.height - this.left.height)
+     * Returns: the AVL balance factor of this: the difference in the height
+     *      of the right and left subtrees of this, from -1 to 1.
      */
-    int height_diff() const;
+    int balance() const;
+
+    /**
+     * Input: Node this - the root of the tree.
+     *        int balance - the new balance factor, from -1 to 1
+     * Returns: N/A
+     * Does: stores balance in this, keeping its parent and color
+     */
+    void set_balance(int balance);
 
     /**
      * Input: Node this - the root of the tree to make consistent
      * Returns: N/A
      * Does: Updates the tree rooted at this to be locally consistent, in the
      *      following way:
-     *        - this.height = 1 + MAX(this.left.height, this.right.height)
      *        - this.left.parent = this
      *        - this.right.parent = this
-     *  If this is empty, this.height is set to -1 and nothing is done to its
-     *      children.
+     *        - this.size, this.total and this.sum are recomputed from the
+     *          children
+     *  If this is empty, or a child is the nil sentinel, nothing is done to
+     *      it.
      */
     void make_locally_consistent();
+
+    /**
+     * Input: Node node - a node whose subtree just gained or lost entries
+     *        Node top - the parent of the root of node's tree
+     *        int nodes - the change in the number of nodes under node
+     *        int counts - the change in the number of occurrences of key
+     *              under node
+     *        Key key - the key whose occurrences changed
+     * Returns: N/A
+     * Does: adds nodes to the size, counts to the total and counts times key
+     *      to the sum of node and of each of its ancestors below top.
+     *      Runtime: O(depth of node)
+     */
+    static void add_to_path(BSTNode *node, BSTNode *top, int nodes,
+                            int counts, const Key &key);
+
+    /*
+     * The parent pointer, with the metadata of this packed into its low bits
+     *  (which are always zero, since nodes are 8-byte aligned):
+     *    - bit 0 is the Red-Black color (1 for RED)
+     *    - bits 1-2 are the AVL balance factor, as a two-bit two's
+     *      complement number
+     *  so a node whose metadata is all zero is BLACK and balanced.
+     */
+    std::uintptr_t parent_meta;
+
+    static const std::uintptr_t COLOR_BIT = 0x1;
+    static const std::uintptr_t BALANCE_MASK = 0x6;
+    static const int BALANCE_SHIFT = 1;
+    static const std::uintptr_t META_MASK = 0x7;
+
+    /*
+     * combine, copy_into and destroy_in_pool only fork when the trees they
+     *  work on have this many nodes between them, so that each task is worth
+     *  the cost of queueing it.
+     */
+    static const unsigned int FORK_GRAIN = 4096;
 };
+
+#include "BSTNode.tpp"
+
+static_assert(sizeof(BSTNode<int>) == 40,
+              "a BSTNode<int> should be its links and four ints");
+static_assert(sizeof(BSTNode<int, NoValue, std::less<int>, KeySum>) == 48,
+              "a summed BSTNode<int> should be its links, four ints and its "
+              "sum");
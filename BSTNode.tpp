@@ -0,0 +1,2702 @@
+/*
+ * Filename: BSTNode.tpp
+ * Contains: Implementation of Binary Search Tree Nodes, included at the end
+ *      of BSTNode.h since BSTNode is a class template
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * A pseudo-assert macro that immediately returns from the enclosing function
+ *  if e is false.
+ */
+#define ABORT_UNLESS(e) \
+    if (!(e))           \
+    {                   \
+        return;         \
+    }
+
+/**
+ * This function is implemented for you, for your convenience.
+ *
+ * Input: Node node - the node to decorate
+ * Returns: the decorator to print with this node using its to_string function.
+ *      The decorator is either nothing, '*', 'r', or 'R' (computed as node is
+ *      BLACK with count <=1, BLACK with count >1, RED with count =1, or RED
+ *      with count >1).
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+std::string decorator_string(const BSTNode<Key, Value, Compare, Sum> *node)
+{
+    typedef BSTNode<Key, Value, Compare, Sum> Node;
+    std::string dec = "";
+    if (node && !node->is_empty())
+    {
+        if (node->color() == Node::Color::RED)
+        {
+            if (node->count > 1)
+            {
+                dec = "R";
+            }
+            else
+            {
+                dec = "r";
+            }
+        }
+        else
+        {
+            if (node->count > 1)
+            {
+                dec = "*";
+            }
+        }
+    }
+    return dec;
+}
+
+/**
+ * This function is implemented for you, for your convenience.
+ *
+ * Input: Node node - the node to get the value label for
+ * Returns: node's key as a string, as printed by operator<<, or empty_string
+ *      if node is an empty tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+std::string value_string(const BSTNode<Key, Value, Compare, Sum> *node)
+{
+    std::string value = "";
+    if (node && !node->is_empty())
+    {
+        std::ostringstream out;
+        out << node->data;
+        value = out.str();
+    }
+    return value;
+}
+
+/**
+ * This function is implemented for you, for your conveninence.
+ *
+ * Input: Node a
+ *        Node b
+ * Returns: N/A
+ * Does: Swaps the colors of Nodes a and b.
+ * Assumes: a and b are both non-null
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::swap_colors(BSTNode *a, BSTNode *b)
+{
+    Color t = a->color();
+    a->set_color(b->color());
+    b->set_color(t);
+}
+
+/**
+ * This function is implemented for you, for your convenience.
+ *
+ * It is implemented in two different ways (one of them commented out):
+ *    - The commented-out version makes explicit that LEFT is the opposite of
+ *      RIGHT, and that ROOT has no opposite
+ *    - The uncommented version uses the fact that enum values in C++ are given
+ *      integer values in increasing order starting at 0 and can be implicitly
+ *      converted into an int. Since the Direction enum is defined in order
+ *      LEFT, ROOT, RIGHT, the values are LEFT=0, ROOT=1, RIGHT=2.
+ * Both exhibit constant time and space complexity so are asymptotically
+ *  equivalent.
+ *
+ * Input: Direction dir
+ * Returns: the opposite of dir, or ROOT if dir is ROOT.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+typename BSTNode<Key, Value, Compare, Sum>::Direction
+BSTNode<Key, Value, Compare, Sum>::opposite_direction(Direction dir)
+{
+    // Direction opp = dir;
+    // if (dir == LEFT)
+    // {
+    //     opp = RIGHT;
+    // }
+    // else if (dir == RIGHT)
+    // {
+    //     opp = LEFT;
+    // }
+    // return opp;
+    return Direction(RIGHT - dir);
+}
+
+/*
+ * Keys are compared only through Compare, so a key type needs no operators
+ *  of its own. For the default std::less<int> this is a plain <.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::swap_entries(BSTNode *a, BSTNode *b)
+{
+    using std::swap;
+    swap(a->data, b->data);
+    swap(static_cast<BSTNodeValue<Value> &>(*a),
+         static_cast<BSTNodeValue<Value> &>(*b));
+    swap(a->count, b->count);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key bound - the key to stop at
+     *        bool inclusive - whether occurrences of bound itself are taken
+ * Returns: the number of occurrences of keys before (or up to) bound
+ * Purpose: every time the search goes right, the node it leaves and that
+     *      node's whole left subtree come before bound. Runtime: O(height)
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+unsigned int
+BSTNode<Key, Value, Compare, Sum>::count_before(const Key &bound,
+                                                bool inclusive) const
+{
+    unsigned int before = 0;
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (inclusive ? !key_less(bound, curr->data)
+                      : key_less(curr->data, bound))
+        {
+            before += curr->left->total + curr->count;
+            curr = curr->right;
+        }
+        else
+        {
+            curr = curr->left;
+        }
+    }
+    return before;
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key bound - the key to stop at
+     *        bool inclusive - whether occurrences of bound itself are taken
+ * Returns: the sum of the occurrences of keys before (or up to) bound
+ * Purpose: the same walk as count_before, adding up sums instead of totals
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+typename BSTNode<Key, Value, Compare, Sum>::sum_type
+BSTNode<Key, Value, Compare, Sum>::sum_before(const Key &bound,
+                                              bool inclusive) const
+{
+    static_assert(std::is_same<Sum, KeySum>::value,
+                  "only trees whose Sum is KeySum keep sums");
+    sum_type before = 0;
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (inclusive ? !key_less(bound, curr->data)
+                      : key_less(curr->data, bound))
+        {
+            before += curr->left->sum + (sum_type)curr->data * curr->count;
+            curr = curr->right;
+        }
+        else
+        {
+            curr = curr->left;
+        }
+    }
+    return before;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename A, typename B>
+bool BSTNode<Key, Value, Compare, Sum>::key_less(const A &a, const B &b)
+{
+    return Compare()(a, b);
+}
+
+/*
+ * These BSTNode constructors use intializer lists. They are complete and you
+ *  may not modify them.
+ *
+ * More info here: https://en.cppreference.com/w/cpp/language/constructor
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::BSTNode()
+    : count(0), size(0), total(0), left(nullptr), right(nullptr),
+      parent_meta(0) {}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename K, typename... Args, typename>
+BSTNode<Key, Value, Compare, Sum>::BSTNode(K &&data, Args &&...args)
+    : BSTNodeValue<Value>(std::forward<Args>(args)...),
+      data(std::forward<K>(data)), count(1), size(1), total(1), left(nil()),
+      right(nil()), parent_meta(0)
+{
+    this->add_to_sum(this->data, 1);
+}
+
+/*
+ * Parameters: N/A
+ * Returns: the shared empty tree
+ * Purpose: every empty subtree of every tree is this one node, in the style of
+ *      CLRS T.nil. It is never written to and never freed, so it has count 0,
+ *      height -1, color BLACK and nullptr children and parent forever.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *BSTNode<Key, Value, Compare, Sum>::nil()
+{
+    static BSTNode sentinel;
+    return &sentinel;
+}
+
+/*
+ * Parameters: Node root - the root of a tree carved from a NodePool
+ *             ForkJoinPool workers - the pool to fork on, or nullptr
+ * Returns: N/A
+ * Purpose: a tree frees its nodes by releasing its pool, which skips
+ *      ~BSTNode, so keys and payloads that own memory of their own (strings,
+ *      say) must be destroyed first. The children of each node are unhooked
+ *      before its destructor runs so that ~BSTNode does not free them, and
+ *      the walk uses an explicit stack because a BST may be a long path.
+ *      A node is only split across two tasks if both of its subtrees are
+ *      big, so the forks nest no deeper than a balanced tree is tall, even
+ *      in a BST that is a long path.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::destroy_in_pool(BSTNode *root,
+                                                        ForkJoinPool *workers)
+{
+    if (std::is_trivially_destructible<Key>::value &&
+        std::is_trivially_destructible<BSTNodeValue<Value>>::value)
+    {
+        return;
+    }
+    if (workers && !root->is_empty() &&
+        std::min(root->left->size, root->right->size) >= FORK_GRAIN / 2)
+    {
+        BSTNode *left = root->left;
+        BSTNode *right = root->right;
+        root->left = nil();
+        root->right = nil();
+        root->~BSTNode();
+        workers->fork_join([&]() { destroy_in_pool(left, workers); },
+                           [&]() { destroy_in_pool(right, workers); });
+        return;
+    }
+    std::vector<BSTNode *> stack;
+    if (!root->is_empty())
+    {
+        stack.push_back(root);
+    }
+    while (!stack.empty())
+    {
+        BSTNode *node = stack.back();
+        stack.pop_back();
+        if (!node->left->is_empty())
+        {
+            stack.push_back(node->left);
+        }
+        if (!node->right->is_empty())
+        {
+            stack.push_back(node->right);
+        }
+        node->left = nil();
+        node->right = nil();
+        node->~BSTNode();
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+ForkJoinPool *
+BSTNode<Key, Value, Compare, Sum>::destroy_workers(const BSTNode *root)
+{
+    if (std::is_trivially_destructible<Key>::value &&
+        std::is_trivially_destructible<BSTNodeValue<Value>>::value)
+    {
+        return nullptr;
+    }
+    return fork_workers(root->size);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+ForkJoinPool *
+BSTNode<Key, Value, Compare, Sum>::fork_workers(unsigned int nodes)
+{
+    return nodes >= FORK_GRAIN ? &ForkJoinPool::shared() : nullptr;
+}
+
+/*
+ * Parameters: Node root - the root of the tree to copy
+ *             void *slots - memory for its nodes
+ *             ForkJoinPool workers - the pool to fork on, or nullptr
+ * Returns: the root of the copy
+ * Purpose: the nodes of the copy sit in the order a pre-order walk visits
+ *      them, so a walk down the copy moves forward through memory.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::copy_into(const BSTNode *root, void *slots,
+                                             ForkJoinPool *workers)
+{
+    if (root->is_empty())
+    {
+        return nil();
+    }
+    BSTNode *copy = static_cast<BSTNode *>(slots);
+    copy_subtree(root, copy, nullptr, workers);
+    return copy;
+}
+
+/*
+ * Parameters: Node source - the root of the subtree to copy
+ *             Node slots - memory for its nodes
+ *             Node parent - the parent of the copy
+ *             ForkJoinPool workers - the pool to fork on, or nullptr
+ * Returns: N/A
+ * Purpose: the sizes of source's subtrees say where the copies of its
+ *      children start, so the copy of source can be linked to them before
+ *      they exist, and the two subtrees written to their ranges by two
+ *      tasks. As in destroy_in_pool, only a node whose subtrees are both big
+ *      is split across two tasks.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::copy_subtree(const BSTNode *source,
+                                                     BSTNode *slots,
+                                                     BSTNode *parent,
+                                                     ForkJoinPool *workers)
+{
+    while (true)
+    {
+        const BSTNode *left = source->left;
+        const BSTNode *right = source->right;
+        BSTNode *left_slots = slots + 1;
+        BSTNode *right_slots = left_slots + left->size;
+        BSTNode *copy = ::new (static_cast<void *>(slots)) BSTNode(
+            *source, left->is_empty() ? nil() : left_slots,
+            right->is_empty() ? nil() : right_slots, parent);
+
+        if (workers && std::min(left->size, right->size) >= FORK_GRAIN / 2)
+        {
+            workers->fork_join(
+                [&]() { copy_subtree(left, left_slots, copy, workers); },
+                [&]() { copy_subtree(right, right_slots, copy, workers); });
+            return;
+        }
+
+        // Recurse into the smaller subtree and loop on the larger, so a BST
+        //  that is a long path does not run out of stack
+        bool left_larger = left->size >= right->size;
+        const BSTNode *smaller = left_larger ? right : left;
+        if (!smaller->is_empty())
+        {
+            copy_subtree(smaller, left_larger ? right_slots : left_slots,
+                         copy, workers);
+        }
+        source = left_larger ? left : right;
+        if (source->is_empty())
+        {
+            return;
+        }
+        slots = left_larger ? left_slots : right_slots;
+        parent = copy;
+    }
+}
+
+/*
+ * Parameters: ForwardIt first, last - a range of keys in order
+ * Returns: the root of a perfectly balanced tree of the keys of the range
+ * Purpose: the distinct keys are counted first, since the size of each
+     *      half must be known before its first node is built. Each node
+     *      takes a run of equal keys.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename ForwardIt>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::build_sorted(ForwardIt first, ForwardIt last)
+{
+    unsigned int n = 0;
+    for (ForwardIt it = first; it != last;)
+    {
+        ForwardIt run = it;
+        while (it != last && !key_less(*run, *it))
+        {
+            ++it;
+        }
+        n++;
+    }
+
+    auto next = [&first, last]() {
+        BSTNode *node = new BSTNode(*first);
+        for (++first; first != last && !key_less(node->data, *first); ++first)
+        {
+            node->count++;
+        }
+        return node;
+    };
+    return build_balanced<Policy>(next, n);
+}
+
+/*
+ * Parameters: Node root - the root of a tree
+     *        ForwardIt first, last - a range of keys in order
+ * Returns: the root of the balanced tree holding the keys of both
+ * Purpose: the nodes of the tree are listed first, so that relinking them
+     *      cannot disturb the walk, and then merged with the runs of the
+     *      range as they are handed to build_balanced.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename ForwardIt>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::merge_sorted(BSTNode *root, ForwardIt first,
+                                                ForwardIt last)
+{
+    std::vector<BSTNode *> nodes;
+    append_in_order(root, nodes);
+
+    std::vector<BSTNode *> merged;
+    merged.reserve(nodes.size() + std::distance(first, last));
+    typename std::vector<BSTNode *>::iterator old = nodes.begin();
+    while (first != last)
+    {
+        while (old != nodes.end() && key_less((*old)->data, *first))
+        {
+            merged.push_back(*old++);
+        }
+        BSTNode *node;
+        if (old != nodes.end() && !key_less(*first, (*old)->data))
+        {
+            node = *old++;
+            node->count++;
+        }
+        else
+        {
+            node = new BSTNode(*first);
+        }
+        for (++first; first != last && !key_less(node->data, *first); ++first)
+        {
+            node->count++;
+        }
+        merged.push_back(node);
+    }
+    merged.insert(merged.end(), old, nodes.end());
+
+    typename std::vector<BSTNode *>::iterator next_node = merged.begin();
+    auto next = [&next_node]() { return *next_node++; };
+    return build_balanced<Policy>(next, (unsigned int)merged.size());
+}
+
+/*
+ * Parameters: Node root - the root of a tree
+     *        ForwardIt first, last - a range of keys in order
+ * Returns: the root of the balanced tree of what is left
+ * Purpose: as merge_sorted, the nodes are listed before anything changes,
+     *      so that a node whose count runs out can be deleted at once; the
+     *      walk would otherwise climb through it.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename ForwardIt>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::subtract_sorted(BSTNode *root,
+                                                   ForwardIt first,
+                                                   ForwardIt last)
+{
+    std::vector<BSTNode *> nodes;
+    append_in_order(root, nodes);
+
+    std::vector<BSTNode *> kept;
+    kept.reserve(nodes.size());
+    for (BSTNode *node : nodes)
+    {
+        while (first != last && key_less(*first, node->data))
+        {
+            ++first;
+        }
+        int removed = 0;
+        for (; first != last && !key_less(node->data, *first); ++first)
+        {
+            removed++;
+        }
+        if (removed < node->count)
+        {
+            node->count -= removed;
+            kept.push_back(node);
+        }
+        else
+        {
+            node->left = nil();
+            node->right = nil();
+            delete node;
+        }
+    }
+
+    typename std::vector<BSTNode *>::iterator next_node = kept.begin();
+    auto next = [&next_node]() { return *next_node++; };
+    return build_balanced<Policy>(next, (unsigned int)kept.size());
+}
+
+/*
+ * Parameters: Node left, middle, right - the trees to join, in order
+ * Returns: the root of the joined tree
+ * Purpose: the heights Policy measures the trees by are found here, once;
+     *      split keeps track of them instead, as it goes down.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::join(BSTNode *left, BSTNode *middle,
+                                        BSTNode *right)
+{
+    int height;
+    return Policy::join(left, Policy::join_height(left), middle, right,
+                        Policy::join_height(right), height);
+}
+
+/*
+ * Parameters: Node root - the root of a tree
+     *        Key value - the key to split at
+     *        Node less, greater - set to the two halves
+ * Returns: the node holding value, or an empty tree
+ * Purpose: the nodes on the path down are kept with their heights, and
+     *      joined from the bottom up: a node the walk left to the left goes
+     *      into greater along with its right subtree, and one it left to the
+     *      right goes into less along with its left subtree. Each half only
+     *      grows, so the joins into it climb no higher than the height of
+     *      the next subtree joined, and for AVL and Red-Black trees the
+     *      costs of all the joins add up to O(log n).
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::split(BSTNode *root, const Key &value,
+                                         BSTNode *&less, BSTNode *&greater)
+{
+    int less_height, greater_height;
+    return split_measured<Policy>(root, Policy::join_height(root), value,
+                                  less, less_height, greater, greater_height);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::split_measured(BSTNode *root, int height,
+                                                  const Key &value,
+                                                  BSTNode *&less,
+                                                  int &less_height,
+                                                  BSTNode *&greater,
+                                                  int &greater_height)
+{
+    // Kept between calls, so that a split allocates nothing once a path has
+    //  been that long
+    static thread_local std::vector<std::pair<BSTNode *, int>> path;
+    path.clear();
+    BSTNode *node = root;
+    while (!node->is_empty())
+    {
+        Direction dir;
+        if (key_less(value, node->data))
+        {
+            dir = LEFT;
+        }
+        else if (key_less(node->data, value))
+        {
+            dir = RIGHT;
+        }
+        else
+        {
+            break;
+        }
+        path.emplace_back(node, height);
+        height = Policy::child_join_height(node, height, dir);
+        node = node->child(dir);
+    }
+
+    less_height = height;
+    greater_height = height;
+    less = nil();
+    greater = nil();
+    if (!node->is_empty())
+    {
+        less_height = Policy::child_join_height(node, height, LEFT);
+        greater_height = Policy::child_join_height(node, height, RIGHT);
+        less = node->left;
+        greater = node->right;
+        link(nil(), node, nil());
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        BSTNode *above = it->first;
+        if (key_less(value, above->data))
+        {
+            BSTNode *right = above->right;
+            int right_height =
+                Policy::child_join_height(above, it->second, RIGHT);
+            greater = Policy::join(greater, greater_height, above, right,
+                                   right_height, greater_height);
+        }
+        else
+        {
+            BSTNode *left = above->left;
+            int left_height =
+                Policy::child_join_height(above, it->second, LEFT);
+            less = Policy::join(left, left_height, above, less, less_height,
+                                less_height);
+        }
+    }
+
+    // Subtrees that were never joined still point at the node above them
+    if (!less->is_empty())
+    {
+        less->set_parent(nullptr);
+    }
+    if (!greater->is_empty())
+    {
+        greater->set_parent(nullptr);
+    }
+    return node;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::combine(SetOperation op, BSTNode *a,
+                                           BSTNode *b,
+                                           std::vector<BSTNode *> &dropped,
+                                           ForkJoinPool *workers)
+{
+    int height;
+    BSTNode *root =
+        combine<Policy>(op, a, Policy::join_height(a), b,
+                        Policy::join_height(b), height, dropped, workers);
+    if (!root->is_empty())
+    {
+        root->set_parent(nullptr);
+    }
+    return root;
+}
+
+/*
+ * Parameters: SetOperation op - the operation to apply
+     *        Node a, b - the trees to combine
+     *        int a_height, b_height - their join_heights
+     *        int height - set to the join_height of the result
+     *        vector dropped - collects the nodes to delete
+     *        ForkJoinPool workers - the pool to fork on, if any
+ * Returns: the root of the combined tree
+ * Purpose: the two recursive calls touch disjoint subtrees, and only read
+     *      the nil sentinel, so they can run on different threads; nodes are
+     *      dropped into a list rather than deleted, since a NodePool is not
+     *      thread-safe. Splitting b at each key of a costs O(log(n/m + 1))
+     *      per node of a once the subtrees shrink, as in Blelloch, Ferizovic
+     *      and Sun's "Just Join for Parallel Ordered Sets".
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::combine(SetOperation op, BSTNode *a,
+                                           int a_height, BSTNode *b,
+                                           int b_height, int &height,
+                                           std::vector<BSTNode *> &dropped,
+                                           ForkJoinPool *workers)
+{
+    if (a->is_empty() || b->is_empty())
+    {
+        BSTNode *kept = nil();
+        height = Policy::join_height(kept);
+        if (op == UNION || (op == DIFFERENCE && !a->is_empty()))
+        {
+            kept = a->is_empty() ? b : a;
+            height = a->is_empty() ? b_height : a_height;
+        }
+        else if (!b->is_empty())
+        {
+            dropped.push_back(b);
+        }
+        else if (!a->is_empty())
+        {
+            dropped.push_back(a);
+        }
+        return kept;
+    }
+
+    BSTNode *a_left = a->left;
+    BSTNode *a_right = a->right;
+    int a_left_height = Policy::child_join_height(a, a_height, LEFT);
+    int a_right_height = Policy::child_join_height(a, a_height, RIGHT);
+    BSTNode *less, *greater;
+    int less_height, greater_height;
+    BSTNode *match = split_measured<Policy>(b, b_height, a->data, less,
+                                            less_height, greater,
+                                            greater_height);
+
+    BSTNode *left, *right;
+    int left_height, right_height;
+    auto combine_left = [&]() {
+        left = combine<Policy>(op, a_left, a_left_height, less, less_height,
+                               left_height, dropped, workers);
+    };
+    if (workers && a->size + b->size >= FORK_GRAIN)
+    {
+        std::vector<BSTNode *> right_dropped;
+        workers->fork_join(combine_left, [&]() {
+            right = combine<Policy>(op, a_right, a_right_height, greater,
+                                    greater_height, right_height,
+                                    right_dropped, workers);
+        });
+        dropped.insert(dropped.end(), right_dropped.begin(),
+                       right_dropped.end());
+    }
+    else
+    {
+        combine_left();
+        right = combine<Policy>(op, a_right, a_right_height, greater,
+                                greater_height, right_height, dropped,
+                                workers);
+    }
+
+    // A node with no count would pass for the nil sentinel, so a's count is
+    //  only changed if a is kept
+    bool kept = (op != INTERSECTION);
+    if (!match->is_empty())
+    {
+        int count = a->count + ((op == DIFFERENCE) ? -match->count
+                                                   : match->count);
+        kept = (count > 0);
+        if (kept)
+        {
+            a->count = count;
+        }
+        dropped.push_back(match);
+    }
+    if (kept)
+    {
+        return Policy::join(left, left_height, a, right, right_height,
+                            height);
+    }
+    dropped.push_back(link(nil(), a, nil()));
+    return join_two<Policy>(left, left_height, right, right_height, height);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::join_two(BSTNode *left, int left_height,
+                                            BSTNode *right, int right_height,
+                                            int &height)
+{
+    if (right->is_empty())
+    {
+        height = left_height;
+        return left;
+    }
+    BSTNode *less, *rest;
+    int less_height, rest_height;
+    BSTNode *middle = split_measured<Policy>(
+        right, right_height, right->minimum_value()->data, less, less_height,
+        rest, rest_height);
+    return Policy::join(left, left_height, middle, rest, rest_height, height);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::link(BSTNode *left, BSTNode *middle,
+                                        BSTNode *right)
+{
+    middle->parent_meta = 0;
+    middle->left = left;
+    middle->right = right;
+    middle->make_locally_consistent();
+    return middle;
+}
+
+/*
+ * Parameters: Node root - the root of the taller tree
+     *        Node up - the node to hang middle under
+     *        Node middle - the node to hang
+     *        Node other - the shorter tree
+     *        Direction dir - the side of up to hang middle on
+     *        bool grew - set to whether the joined tree got taller
+ * Returns: the root of the joined tree
+ * Purpose: hanging middle adds the nodes of other to every subtree on the
+     *      path, which is more than a change of one key, so the path is
+     *      recounted rather than adjusted with add_to_path. As in
+     *      insert_with, this is done before any rotation.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::graft(BSTNode *root, BSTNode *up,
+                                         BSTNode *middle, BSTNode *other,
+                                         Direction dir, bool &grew)
+{
+    middle->set_child(opposite_direction(dir), up->child(dir));
+    middle->set_child(dir, other);
+    middle->make_locally_consistent();
+    up->set_child(dir, middle);
+    for (BSTNode *node = up; node; node = node->parent())
+    {
+        node->make_locally_consistent();
+    }
+
+    grew = true;
+    BSTNode *node = up;
+    while (true)
+    {
+        BSTNode *above = node->parent();
+        Direction above_dir =
+            !above ? ROOT : (above->left == node ? LEFT : RIGHT);
+
+        node = Policy::after_insert(node, dir, grew);
+        if (!above)
+        {
+            return node;
+        }
+        if (!grew)
+        {
+            return root;
+        }
+        node = above;
+        dir = above_dir;
+    }
+}
+
+/*
+ * Parameters: Node left, middle, right - the trees to join, in order
+     *        int left_height, right_height - their heights
+     *        int height - set to the height of the joined tree
+ * Returns: the root of the joined AVL Tree
+ * Purpose: each step down the inner edge of the taller tree lowers the
+     *      height by one or two, as the balance factor says, so the node it
+     *      stops at is as tall as the shorter tree or one level taller, and
+     *      middle over the two is one level taller than that node was.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_join(BSTNode *left, int left_height,
+                                            BSTNode *middle, BSTNode *right,
+                                            int right_height, int &height)
+{
+    if (!left->is_empty())
+    {
+        left->set_parent(nullptr);
+    }
+    if (!right->is_empty())
+    {
+        right->set_parent(nullptr);
+    }
+    middle->parent_meta = 0;
+
+    if (left_height > right_height + 1 || right_height > left_height + 1)
+    {
+        Direction dir = (left_height > right_height) ? RIGHT : LEFT;
+        BSTNode *root = (dir == RIGHT) ? left : right;
+        BSTNode *other = (dir == RIGHT) ? right : left;
+        int other_height = std::min(left_height, right_height);
+        height = std::max(left_height, right_height);
+
+        BSTNode *up = nullptr;
+        BSTNode *spot = root;
+        int spot_height = height;
+        while (spot_height > other_height + 1)
+        {
+            bool lower = (dir == RIGHT) ? spot->balance() < 0
+                                        : spot->balance() > 0;
+            spot_height -= lower ? 2 : 1;
+            up = spot;
+            spot = spot->child(dir);
+        }
+        int balance = other_height - spot_height;
+        middle->set_balance(dir == RIGHT ? balance : -balance);
+
+        bool grew;
+        root = graft<AVLBalance>(root, up, middle, other, dir, grew);
+        height += grew ? 1 : 0;
+        return root;
+    }
+
+    link(left, middle, right);
+    middle->set_balance(right_height - left_height);
+    height = 1 + std::max(left_height, right_height);
+    return middle;
+}
+
+/*
+ * Parameters: Node left, middle, right - the trees to join, in order
+     *        int left_height, right_height - their black-heights
+     *        int height - set to the black-height of the joined tree
+ * Returns: the root of the joined Red-Black Tree
+ * Purpose: a RED middle over a BLACK node and a tree of the same
+     *      black-height leaves every black-height as it was, so the only
+     *      violation left is between middle and a RED parent, which is just
+     *      what an insertion leaves behind.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_join(BSTNode *left, int left_height,
+                                           BSTNode *middle, BSTNode *right,
+                                           int right_height, int &height)
+{
+    if (!left->is_empty())
+    {
+        left->set_parent(nullptr);
+        left->set_color(BLACK);
+    }
+    if (!right->is_empty())
+    {
+        right->set_parent(nullptr);
+        right->set_color(BLACK);
+    }
+    middle->parent_meta = 0;
+
+    if (left_height != right_height)
+    {
+        Direction dir = (left_height > right_height) ? RIGHT : LEFT;
+        BSTNode *root = (dir == RIGHT) ? left : right;
+        BSTNode *other = (dir == RIGHT) ? right : left;
+        int other_height = std::min(left_height, right_height);
+        height = std::max(left_height, right_height);
+
+        BSTNode *up = nullptr;
+        BSTNode *spot = root;
+        int spot_height = height;
+        while (spot->color() == RED || spot_height > other_height)
+        {
+            spot_height -= (spot->color() == BLACK) ? 1 : 0;
+            up = spot;
+            spot = spot->child(dir);
+        }
+        middle->set_color(RED);
+
+        bool grew;
+        root = graft<RBBalance>(root, up, middle, other, dir, grew);
+        if (root->color() == RED)
+        {
+            root->set_color(BLACK);
+            height++;
+        }
+        return root;
+    }
+
+    link(left, middle, right);
+    height = left_height + 1;
+    return middle;
+}
+
+/*
+ * Parameters: NextNode next - supplies the nodes in order
+     *        unsigned int n - the number of nodes
+ * Returns: the root of a perfectly balanced tree of n nodes
+ * Purpose: a tree of n nodes built by halving has its first
+     *      floor(log2(n + 1)) levels complete; the rest of its nodes are on
+     *      one level below them, which the policy may need to know.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename NextNode>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::build_balanced(NextNode &next,
+                                                  unsigned int n)
+{
+    int levels = 0;
+    while ((n + 1) >> (levels + 1))
+    {
+        levels++;
+    }
+
+    int height;
+    BSTNode *root = build_balanced<Policy>(next, n, 0, levels, height);
+    if (!root->is_empty())
+    {
+        root->set_parent(nullptr);
+    }
+    return root;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename NextNode>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::build_balanced(NextNode &next,
+                                                  unsigned int n, int depth,
+                                                  int levels,
+                                                  int &height)
+{
+    if (n == 0)
+    {
+        height = -1;
+        return nil();
+    }
+
+    unsigned int n_left = (n - 1) / 2;
+    int left_height, right_height;
+    BSTNode *left =
+        build_balanced<Policy>(next, n_left, depth + 1, levels, left_height);
+    BSTNode *node = next();
+    BSTNode *right = build_balanced<Policy>(next, n - 1 - n_left, depth + 1,
+                                            levels, right_height);
+
+    // A reused node may still be RED, or unbalanced
+    node->parent_meta = 0;
+    node->left = left;
+    node->right = right;
+    node->make_locally_consistent();
+
+    height = 1 + std::max(left_height, right_height);
+    Policy::on_build(node, depth == levels, right_height - left_height);
+    return node;
+}
+
+/*
+ * Parameters: Node root - the root of a tree
+     *        vector nodes - the vector to append to
+ * Returns: N/A
+ * Purpose: follows successor() from the minimum, which takes no stack.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::append_in_order(
+    BSTNode *root, std::vector<BSTNode *> &nodes)
+{
+    nodes.reserve(nodes.size() + root->node_count());
+    for (const BSTNode *node = root->minimum_value(); !node->is_empty();
+         node = node->successor())
+    {
+        nodes.push_back(const_cast<BSTNode *>(node));
+    }
+}
+
+/*
+ * Parameters: other, node
+ * Returns: the root of a tree that is a copy of the tree rooted at other
+ * Purpose: creates a new node with the same properties as other by performing
+     *      a pre-order deep copy of the tree rooted at other. The root of the
+     *      new tree has parent nullptr (it is considered the ultimate root of
+     *      its tree).
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::BSTNode(const BSTNode &other)
+    : BSTNodeValue<Value>(static_cast<const BSTNodeValue<Value> &>(other)),
+      BSTNodeSum<Key, Sum>(other),
+      data(other.data), count(other.count), size(other.size),
+      total(other.total), left(nullptr), right(nullptr),
+      parent_meta(other.parent_meta & META_MASK) //color and balance, no parent
+{
+
+    if (other.is_empty())
+    {
+        return;
+    }
+
+    //copy left subtree
+    if(!other.left->is_empty())
+    {
+        this->left = new BSTNode(*other.left);
+        this->left->set_parent(this);
+    }
+    else {
+        this->left = nil();
+    }
+    //copy right subtree
+    if(!other.right->is_empty()){
+        this->right = new BSTNode(*other.right);
+        this->right->set_parent(this); 
+    }
+    else 
+    {
+        this->right = nil();
+    }
+}
+
+/*
+ * Parameters: other, left, right, parent
+ * Returns: a copy of other alone
+ * Purpose: copies the key, payload, counts, color and balance of other, but
+ *      none of its links, so that copy_subtree can place its children
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::BSTNode(const BSTNode &other, BSTNode *left,
+                                           BSTNode *right, BSTNode *parent)
+    : BSTNodeValue<Value>(static_cast<const BSTNodeValue<Value> &>(other)),
+      BSTNodeSum<Key, Sum>(other),
+      data(other.data), count(other.count), size(other.size),
+      total(other.total), left(left), right(right),
+      parent_meta(reinterpret_cast<std::uintptr_t>(parent) |
+                  (other.parent_meta & META_MASK))
+{
+}
+
+/*
+ * Parameters: node this - the node to free
+ * Returns: N/A
+ * Purpose: Performs a post-order delete to free all memory owned by this.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::~BSTNode()
+{
+    // The shared nil sentinel is never freed
+    if (this->left != nil())
+    {
+        delete this->left;
+    }
+    if (this->right != nil())
+    {
+        delete this->right;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void *BSTNode<Key, Value, Compare, Sum>::operator new(std::size_t size)
+{
+    NodePool *pool = NodePool::current();
+    if (pool)
+    {
+        assert(size <= pool->slot_size());
+        return pool->allocate();
+    }
+    return ::operator new(size);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::operator delete(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    NodePool *pool = NodePool::current();
+    if (pool)
+    {
+        pool->deallocate(ptr);
+    }
+    else
+    {
+        ::operator delete(ptr);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+std::string BSTNode<Key, Value, Compare, Sum>::to_string() const
+{
+    return value_string(this) + decorator_string(this);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ * Returns: a pointer to the node with the minimum value in the tree rooted
+    *      at this
+ * Purpose: finds the minimum value of the tree
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::minimum_value() const
+{
+    if (this->is_empty())
+    {
+        return this; 
+    }
+    //left traversal- search through the left side of the bst to find the minimum value
+    const BSTNode* current = this; 
+    while (!current->left->is_empty())
+    {
+        current = current->left;
+    }
+    return current;
+}
+
+/*
+ * Parameters: node this - the root of the tree
+ * Returns: a pointer to the node with the maximum value in the tree rooted
+     *      at this.
+ * Purpose: finds the maximum value of the tree
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::maximum_value() const
+{
+    //to find the maximum value, need to look through the right side of the bst to find the largest value 
+    const BSTNode* current = this; 
+    while (!current->right->is_empty())
+    {
+        current = current->right;
+    }
+    return current;
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ Key value - the value for which to search in the tree
+ * Returns: a pointer to the node with value in the tree rooted at this
+ * Purpose: performs a search in the tree rooted at this and returns the
+     *      node with that value in the tree, or an empty tree if the value
+     *      does not appear in the tree rooted at this.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::search(const Key &value) const
+{
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (key_less(value, curr->data))
+        {
+            curr = curr->left;
+        }
+        else if (key_less(curr->data, value))
+        {
+            curr = curr->right;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return curr;
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the key to search for
+ * Returns: the node with the smallest key not ordered before value
+ * Purpose: remembers the last node at which the search went left, which is
+     *      the answer once the search falls off the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::lower_bound(const Key &value) const
+{
+    const BSTNode *bound = nil();
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (key_less(curr->data, value))
+        {
+            curr = curr->right;
+        }
+        else
+        {
+            bound = curr;
+            curr = curr->left;
+        }
+    }
+    return bound;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::upper_bound(const Key &value) const
+{
+    const BSTNode *bound = nil();
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (key_less(value, curr->data))
+        {
+            bound = curr;
+            curr = curr->left;
+        }
+        else
+        {
+            curr = curr->right;
+        }
+    }
+    return bound;
+}
+
+/*
+ * Parameters: Node this - a non-empty node
+ * Returns: the next node in order, or the nil sentinel after the maximum
+ * Purpose: a full traversal crosses each edge once down and once up, so the
+     *      steps take O(1) time on average.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::successor() const
+{
+    if (!this->right->is_empty())
+    {
+        return this->right->minimum_value();
+    }
+    const BSTNode *child = this;
+    const BSTNode *up = this->parent();
+    while (up && up->right == child)
+    {
+        child = up;
+        up = up->parent();
+    }
+    return up ? up : nil();
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::predecessor() const
+{
+    if (!this->left->is_empty())
+    {
+        return this->left->maximum_value();
+    }
+    const BSTNode *child = this;
+    const BSTNode *up = this->parent();
+    while (up && up->left == child)
+    {
+        child = up;
+        up = up->parent();
+    }
+    return up ? up : nil();
+}
+
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to insert
+ * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted, with parent `nullptr`
+ * Purpose: inserts (a single occurrence of) value into the tree rooted at
+     *      this. Uses the "naive BST" insertion algorithm.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename K, typename... Args>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::insert(K &&value, Args &&...args)
+{
+    bool grew = false;
+    return this->template insert_with<NaiveBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to insert
+ * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted, with parent `nullptr`. The returned tree is an AVL
+     *      Tree.
+ * Purpose: inserts (a single occurrence of) value into the tree rooted at
+     *      this. Uses the AVL Tree insertion algorithm.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename K, typename... Args>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_insert(K &&value, Args &&...args)
+{
+    bool grew = false;
+    return this->template insert_with<AVLBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to insert
+ * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted, with parent `nullptr`. The returned tree is a
+     *      Red-Black Tree.
+ * Purpose: inserts (a single occurrence of) value into the tree rooted at
+     *      this. Uses the Red-Black Tree insertion algorithm.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename K, typename... Args>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_insert(K &&value, Args &&...args)
+{
+    bool grew = false;
+    return this->template insert_with<RBBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+/*
+ * Parameters: Node this - the root of a Red-Black Tree
+     *        Key value - the value to insert
+ * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted, with parent `nullptr`. The returned tree is a
+     *      Red-Black Tree, except that its root may be RED.
+ * Purpose: the top-down insertion of Guibas and Sedgewick. On the way down,
+     *      every node with two RED children (a 4-node) is split by flipping
+     *      its colors, and a split that leaves two REDs in a row is fixed at
+     *      once with one or two rotations. That keeps the parent of each node
+     *      entered from being a 4-node, so the new RED leaf can always be
+     *      fixed where it lands, and nothing is revisited on the way back up.
+     *      The splits change the shape of the tree even when value is already
+     *      in it.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename K, typename... Args>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_insert_top_down(K &&value, Args &&...args)
+{
+    if (this->is_empty())
+    {
+        return new BSTNode(std::forward<K>(value), std::forward<Args>(args)...);
+    }
+
+    BSTNode *top = this->parent();
+    BSTNode *curr = this;
+    while (true)
+    {
+        // Split a 4-node on the way down
+        if (curr->left->color() == RED && curr->right->color() == RED)
+        {
+            curr->set_color(RED);
+            curr->left->set_color(BLACK);
+            curr->right->set_color(BLACK);
+            rb_fix_top_down(curr);
+        }
+
+        Direction dir;
+        if (key_less(value, curr->data))
+        {
+            dir = LEFT;
+        }
+        else if (key_less(curr->data, value))
+        {
+            dir = RIGHT;
+        }
+        else
+        {
+            curr->count ++;
+            add_to_path(curr, top, 0, 1, curr->data);
+            break;
+        }
+        if (curr->child(dir)->is_empty())
+        {
+            BSTNode *node = new BSTNode(std::forward<K>(value),
+                                        std::forward<Args>(args)...);
+            node->set_color(RED);
+            curr->set_child(dir, node);
+            add_to_path(curr, top, 1, 1, node->data);
+            rb_fix_top_down(node);
+            break;
+        }
+        curr = curr->child(dir);
+    }
+
+    // A fix-up may have rotated this down a level or two
+    BSTNode *root = this;
+    while (root->parent() != top)
+    {
+        root = root->parent();
+    }
+    return root;
+}
+
+/*
+ * Parameters: Node node - a RED node of a Red-Black Tree
+ * Returns: N/A
+ * Purpose: if the parent of node is also RED, rotates node's grandparent
+     *      (which must be BLACK, with a BLACK child on the other side) so that
+     *      a BLACK node takes its place with the two REDs as its children.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::rb_fix_top_down(BSTNode *node)
+{
+    BSTNode *p = node->parent();
+    if (!p || p->color() == BLACK)
+    {
+        return;
+    }
+    BSTNode *g = p->parent();
+    Direction pdir = (g->left == p) ? LEFT : RIGHT;
+    Direction ndir = (p->left == node) ? LEFT : RIGHT;
+    if (ndir == pdir)
+    {
+        // LL or RR: p takes g's place
+        g->dir_rotate(opposite_direction(pdir));
+        p->set_color(BLACK);
+    }
+    else
+    {
+        // LR or RL: node takes g's place
+        p->dir_rotate(pdir);
+        g->dir_rotate(opposite_direction(pdir));
+        node->set_color(BLACK);
+    }
+    g->set_color(RED);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        bool grew - set to whether the tree rooted at this got taller
+     *        Key value - the value to insert
+ * Returns: a pointer to the root of the tree into which value has just
+     *      been inserted
+ * Purpose: the one BST insertion shared by every balance policy. It walks
+     *      down to the new node's parent, then back up the parent pointers,
+     *      handing each node on the path to Policy::after_insert with the
+     *      side that grew, until the policy reports that nothing above can
+     *      change. Nothing recurses, so the stack stays flat however deep a
+     *      naive tree gets. Both policy calls are resolved at compile time,
+     *      so each policy gets its own copy of this loop with its rebalancing
+     *      inlined.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy, typename K, typename... Args>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::insert_with(bool &grew, K &&value,
+                                               Args &&...args)
+{
+    /********************************
+     ***** BST Insertion Begins *****
+     ********************************/
+    grew = false;
+    if (this->is_empty())
+    {
+        grew = true;
+        BSTNode *node =
+            new BSTNode(std::forward<K>(value), std::forward<Args>(args)...);
+        Policy::on_create(node);
+        return node;
+    }
+
+    BSTNode *top = this->parent();
+    BSTNode *curr = this;
+    Direction dir = ROOT;
+    while (!curr->is_empty())
+    {
+        if (key_less(value, curr->data))
+        {
+            dir = LEFT;
+        }
+        else if (key_less(curr->data, value))
+        {
+            dir = RIGHT;
+        }
+        else
+        {
+            // Only the count changed, so the shape of the tree did not
+            curr->count ++;
+            add_to_path(curr, top, 0, 1, curr->data);
+            return this;
+        }
+        if (curr->child(dir)->is_empty())
+        {
+            break;
+        }
+        curr = curr->child(dir);
+    }
+
+    BSTNode *node =
+        new BSTNode(std::forward<K>(value), std::forward<Args>(args)...);
+    Policy::on_create(node);
+    curr->set_child(dir, node);
+    add_to_path(curr, top, 1, 1, node->data);
+    grew = true;
+
+    /********************************
+     ****** BST Insertion Ends ******
+     ********************************/
+
+    // Climb back up while the policy still has work to do
+    BSTNode *root = curr;
+    while (true)
+    {
+        BSTNode *up = root->parent();
+        Direction up_dir =
+            (up == top) ? ROOT : (up->left == root ? LEFT : RIGHT);
+
+        // Rotations keep up's child pointer and the new root's parent right
+        root = Policy::after_insert(root, dir, grew);
+        if (up == top)
+        {
+            return root;
+        }
+        if (!grew)
+        {
+            // The rotations, if any, were below this, so this is still the root
+            return this;
+        }
+        root = up;
+        dir = up_dir;
+    }
+}
+
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to remove
+ * Returns: a pointer to the root of the tree from which value has just
+     *      been removed, whose parent pointer is `nullptr`. This method may
+     *      return an empty tree.
+ * Purpose:removes (a single occurrence of) value from the tree rooted at
+     *      this. Uses the "naive BST" removal algorithm.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::remove(const Key &value)
+{
+    bool shrank = false;
+    return this->template remove_with<NaiveBalance>(value, shrank);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to remove
+ * Returns:  a pointer to the root of the tree from which value has just
+     *      been removed, whose parent pointer is `nullptr`. This method may
+     *      return an empty tree. The returned tree is an AVL Tree.
+ * Purpose:removes (a single occurrence of) value from the tree rooted at
+     *      this. Uses the AVL Tree removal algorithm.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_remove(const Key &value)
+{
+    bool shrank = false;
+    return this->template remove_with<AVLBalance>(value, shrank);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        Key value - the value to remove
+     *        bool shrank - set to whether the tree rooted at this got shorter
+ * Returns:  a pointer to the root of the tree from which value has just
+     *      been removed. This method may return an empty tree.
+ * Purpose: the BST removal shared by the balance policies that repair the
+     *      tree bottom-up. Like insert_with, it walks down to the node to
+     *      unlink, then back up the parent pointers, telling
+     *      Policy::after_remove which side of each node shrank, until the
+     *      policy reports that nothing above can change.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+template <typename Policy>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::remove_with(const Key &value, bool &shrank)
+{
+    /********************************
+     ****** BST Removal Begins ******
+     ********************************/
+    shrank = false;
+    BSTNode *top = this->parent();
+    BSTNode *curr = this;
+    Direction dir = ROOT;
+    while (!curr->is_empty())
+    {
+        if (key_less(value, curr->data))
+        {
+            dir = LEFT;
+            curr = curr->left;
+        }
+        else if (key_less(curr->data, value))
+        {
+            dir = RIGHT;
+            curr = curr->right;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (curr->is_empty())
+    {
+        return this;
+    }
+    if (curr->count > 1)
+    {
+        curr->count--;
+        add_to_path(curr, top, 0, -1, curr->data);
+        return this;
+    }
+
+    // One node and one occurrence of value leave every subtree on the path
+    add_to_path(curr, top, -1, -1, curr->data);
+
+    //both children exist: trade places with the successor, which keeps
+    //the key being removed in order as the minimum of the right subtree,
+    //then remove the successor's node, which has no left child, instead
+    if (!curr->left->is_empty() && !curr->right->is_empty())
+    {
+        BSTNode *succ = curr->right;
+        dir = RIGHT;
+        while (!succ->left->is_empty())
+        {
+            succ = succ->left;
+            dir = LEFT;
+        }
+        // succ's entry moves up out of the subtrees between the two
+        add_to_path(succ->parent(), curr, -1, -succ->count, succ->data);
+        swap_entries(curr, succ);
+        curr = succ;
+    }
+
+    // curr has at most one child, which takes its place
+    BSTNode *up = curr->parent();
+    BSTNode *child = curr->left->is_empty() ? curr->right : curr->left;
+    if (!child->is_empty())
+    {
+        child->set_parent(up);
+    }
+    curr->left = nil();
+    curr->right = nil();
+    delete curr;
+    shrank = true;
+    if (up == top)
+    {
+        return child;
+    }
+    up->set_child(dir, child);
+
+    /********************************
+     ******* BST Removal Ends *******
+     ********************************/
+
+    // Climb back up while the policy still has work to do
+    BSTNode *root = up;
+    while (true)
+    {
+        BSTNode *above = root->parent();
+        Direction above_dir =
+            (above == top) ? ROOT : (above->left == root ? LEFT : RIGHT);
+
+        root = Policy::after_remove(root, dir, shrank);
+        if (above == top)
+        {
+            return root;
+        }
+        if (!shrank)
+        {
+            // The rotations, if any, were below this, so this is still the root
+            return this;
+        }
+        root = above;
+        dir = above_dir;
+    }
+}
+
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_remove(const Key &value)
+{
+    // This is implemented for you.
+    BHVNeighborhood nb(this, ROOT);
+    BSTNode *root = this->rb_remove_helper(value, nb);
+    nb.fix_blackheight_imbalance();
+
+    // The fix-up may have rotated the old root down a level
+    while (root->parent())
+    {
+        root = root->parent();
+    }
+    return root;
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ * Returns:  the height of the tree rooted at this (an empty tree has height
+     *      -1).
+ * Purpose: returns the height
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+int BSTNode<Key, Value, Compare, Sum>::node_height() const
+{   
+    if(this->is_empty())
+    {
+        return -1; 
+    }
+    else
+    {
+        return 1 + std::max(this->left->node_height(),
+                            this->right->node_height());
+    }
+}
+
+/*
+ * Parameters: Node this - the root of an AVL Tree
+ * Returns:  the height of the tree rooted at this (an empty tree has height
+     *      -1).
+ * Purpose: follows the taller child at each level, as told by the balance
+     *      factors, so only one root-to-leaf path is visited
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+int BSTNode<Key, Value, Compare, Sum>::avl_height() const
+{
+    int height = -1;
+    const BSTNode *node = this;
+    while (!node->is_empty())
+    {
+        height++;
+        node = (node->balance() > 0) ? node->right : node->left;
+    }
+    return height;
+}
+
+/*
+ * Parameters: Node this - the root of a Red-Black tree
+ * Returns: the number of BLACK nodes on each path down from this
+ * Purpose: every path down crosses the same number of BLACK nodes, so the
+     *      leftmost one is as good as any
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+int BSTNode<Key, Value, Compare, Sum>::rb_black_height() const
+{
+    int height = 0;
+    for (const BSTNode *node = this; !node->is_empty(); node = node->left)
+    {
+        height += (node->color() == BLACK) ? 1 : 0;
+    }
+    return height;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+unsigned int BSTNode<Key, Value, Compare, Sum>::node_count() const
+{
+    return this->size;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+unsigned int BSTNode<Key, Value, Compare, Sum>::count_total() const
+{
+    return this->total;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+unsigned int BSTNode<Key, Value, Compare, Sum>::rank(const Key &value) const
+{
+    return this->count_before(value, false);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+     *        unsigned int k - a position, counting from 0
+ * Returns: the node holding the k-th smallest occurrence, or an empty tree
+ * Purpose: the left subtree holds the first left->total occurrences and this
+     *      node the next count of them, so each step either stops or moves
+     *      down with k made relative to the subtree. Runtime: O(height)
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::select(unsigned int k) const
+{
+    const BSTNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (k < curr->left->total)
+        {
+            curr = curr->left;
+        }
+        else if (k - curr->left->total < (unsigned int)curr->count)
+        {
+            return curr;
+        }
+        else
+        {
+            k -= curr->left->total + curr->count;
+            curr = curr->right;
+        }
+    }
+    return curr;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+unsigned int
+BSTNode<Key, Value, Compare, Sum>::count_in_range(const Key &lo,
+                                                  const Key &hi) const
+{
+    if (key_less(hi, lo))
+    {
+        return 0;
+    }
+    return this->count_before(hi, true) - this->count_before(lo, false);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+typename BSTNode<Key, Value, Compare, Sum>::sum_type
+BSTNode<Key, Value, Compare, Sum>::sum_in_range(const Key &lo,
+                                                const Key &hi) const
+{
+    if (key_less(hi, lo))
+    {
+        return 0;
+    }
+    return this->sum_before(hi, true) - this->sum_before(lo, false);
+}
+
+/*
+ * Parameters: Node this - the node whose parent we are searching for
+     *        Node root - the root of the tree in which to search
+ * Returns:  a pointer to the parent of this in the tree rooted at root, or
+     *      nullptr if this is the root of the tree
+ * Purpose: Searches the tree rooted at root for this, then returns that
+     *      node's parent.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+const BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::parent_in(BSTNode *root) const
+{   
+    return root->parent();
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+bool BSTNode<Key, Value, Compare, Sum>::is_empty() const
+{
+    bool empty_by_count = this->count == 0;
+    bool empty_by_children = !this->left && !this->right;
+
+    // Assert some invariants about binary search trees
+    assert(!this->left == !this->right);
+    assert(empty_by_count == empty_by_children);
+
+    // Return any of the equivalent checks
+    return empty_by_count;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::child(Direction dir) const
+{
+    BSTNode *child = nullptr;
+    if (dir == LEFT)
+    {
+        child = this->left;
+    }
+    else if (dir == RIGHT)
+    {
+        child = this->right;
+    }
+    return child;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::set_child(Direction dir, BSTNode *child)
+{
+    if (dir != ROOT)
+    {
+        if (dir == LEFT)
+        {
+            this->left = child;
+        }
+        else if (dir == RIGHT)
+        {
+            this->right = child;
+        }
+        if (!child->is_empty())
+        {
+            child->set_parent(this);
+        }
+    }
+    else
+    {
+        assert(false);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::parent() const
+{
+    return reinterpret_cast<BSTNode *>(this->parent_meta & ~META_MASK);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::set_parent(BSTNode *parent)
+{
+    this->parent_meta = reinterpret_cast<std::uintptr_t>(parent) |
+                        (this->parent_meta & META_MASK);
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+typename BSTNode<Key, Value, Compare, Sum>::Color
+BSTNode<Key, Value, Compare, Sum>::color() const
+{
+    return (this->parent_meta & COLOR_BIT) ? RED : BLACK;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::set_color(Color color)
+{
+    // The nil sentinel is always BLACK and must never be written
+    assert(!this->is_empty() || color == BLACK);
+    if (color == RED)
+    {
+        this->parent_meta |= COLOR_BIT;
+    }
+    else if (this->parent_meta & COLOR_BIT)
+    {
+        this->parent_meta &= ~COLOR_BIT;
+    }
+}
+
+/*************************
+ * BEGIN PRIVATE SECTION *
+ *************************/
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::RRVNeighborhood::RRVNeighborhood(
+    BSTNode *root)
+    : g{root}, p{nullptr}, x{nullptr}, y{nullptr}, shape{SHAPE_NONE}
+{
+    // Stop if g is RED or empty. (If g has no grandchildren, every branch
+    //  below stops on its own when it finds no red-red violation.)
+    ABORT_UNLESS((this->g->color() == BLACK) &&
+                 !this->g->is_empty());
+
+    if (this->g->left->color() == BLACK)
+    {
+        // If there is a red-red violation, it's to the right
+        this->y = this->g->left;
+        this->p = this->g->right;
+
+        // Stop if g has two BLACK children
+        ABORT_UNLESS(this->p->color() == RED);
+
+        if (this->p->left->color() == RED)
+        {
+            this->shape = RL;
+            this->x = this->p->left;
+        }
+        else
+        {
+            // Stop if there is no red-red violation
+            ABORT_UNLESS(this->p->right->color() == RED);
+
+            this->shape = RR;
+            this->x = this->p->right;
+        }
+    }
+    else if (this->g->right->color() == BLACK)
+    {
+        // If there is a red-red violation, it's to the left
+        this->y = this->g->right;
+        this->p = this->g->left;
+
+        if (this->p->left->color() == RED)
+        {
+            this->shape = Shape::LL;
+            this->x = this->p->left;
+        }
+        else
+        {
+            // Stop if there is no red-red violation
+            ABORT_UNLESS(p->right->color() == RED);
+
+            this->shape = LR;
+            this->x = this->p->right;
+        }
+    }
+    else
+    {
+        // Both children of g are RED. Find the red-red violation
+        BSTNode *lc = this->g->left;
+        BSTNode *llc = lc->left;
+        BSTNode *lrc = lc->right;
+        BSTNode *rc = this->g->right;
+        BSTNode *rlc = rc->left;
+        BSTNode *rrc = rc->right;
+
+        if (llc && llc->color() == RED)
+        {
+            this->shape = LL;
+            this->p = lc;
+            this->x = llc;
+            this->y = rc;
+        }
+
+        if (lrc && lrc->color() == RED)
+        {
+            // Stop if there are multiple red-red violations
+            ABORT_UNLESS(this->shape == SHAPE_NONE);
+
+            this->shape = LR;
+            this->p = lc;
+            this->x = lrc;
+            this->y = rc;
+        }
+
+        if (rlc && rlc->color() == RED)
+        {
+            // Stop if there are multiple red-red violations
+            ABORT_UNLESS(this->shape == Shape::SHAPE_NONE);
+
+            this->shape = Shape::RL;
+            this->p = rc;
+            this->x = rlc;
+            this->y = lc;
+        }
+
+        if (rrc && rrc->color() == RED)
+        {
+            // Stop if there are multiple red-red violations
+            ABORT_UNLESS(this->shape == SHAPE_NONE);
+
+            this->shape = RR;
+            this->p = rc;
+            this->x = rrc;
+            this->y = lc;
+        }
+
+        // Stop if there is no red-red violation
+        ABORT_UNLESS(this->shape != SHAPE_NONE);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum>::BHVNeighborhood::BHVNeighborhood(
+    BSTNode *n, Direction dir)
+    : n{n}, p{nullptr}, s{nullptr}, c{nullptr}, d{nullptr},
+      del_case{CASE_NONE}, dir{dir}
+{
+    ABORT_UNLESS(this->n && !this->n->is_empty() &&
+                 this->n->color() == BLACK);
+
+    this->p = this->n->parent();
+
+    if (!this->p)
+    {
+        this->del_case = CASE_1;
+        assert(dir == ROOT);
+        this->dir = ROOT;
+    }
+    else
+    {
+        this->find_case();
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::BHVNeighborhood::find_case()
+{
+    assert(!this->p->is_empty());
+    assert(this->dir != ROOT);
+
+    this->s = this->p->child(opposite_direction(dir));
+    this->c = this->s->child(dir);
+    this->d = this->s->child(opposite_direction(dir));
+
+    if (this->p->color() == BLACK &&
+        this->s->color() == BLACK &&
+        this->c && this->c->color() == BLACK &&
+        this->d && this->d->color() == BLACK)
+    {
+        this->del_case = CASE_2;
+    }
+    else if (this->p->color() == BLACK &&
+             this->s->color() == RED)
+    {
+        assert(this->c && this->c->color() == BLACK &&
+               this->d && this->d->color() == BLACK);
+
+        this->del_case = CASE_3;
+    }
+    else if (this->p->color() == RED &&
+             this->s->color() == BLACK &&
+             this->c->color() == BLACK &&
+             this->d->color() == BLACK)
+    {
+        this->del_case = CASE_4;
+    }
+    else if (this->s->color() == BLACK &&
+             this->c->color() == RED &&
+             this->d->color() == BLACK)
+    {
+        this->del_case = CASE_5;
+    }
+    else if (this->s->color() == BLACK &&
+             this->d->color() == RED)
+    {
+        this->del_case = CASE_6;
+    }
+    else
+    {
+        this->del_case = CASE_NONE;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare,
+             Sum>::BHVNeighborhood::fix_blackheight_imbalance()
+{
+    /*
+     * This is implemented for you. Study it carefully so you understand what
+     *  is going on when a node is deleted from a Red-Black Tree.
+     */
+    BSTNode::BHVNeighborhood nb = *this;
+    while (nb.p)
+    {
+        BSTNode::Direction pdir = ROOT;
+        if (nb.p->parent())
+        {
+            if (nb.p == nb.p->parent()->left)
+            {
+                pdir = LEFT;
+            }
+            else if (nb.p == nb.p->parent()->right)
+            {
+                pdir = RIGHT;
+            }
+            else
+            {
+                // Should never happen: nb.p is non-null.
+                assert(false);
+            }
+        }
+        BSTNode *grandparent = nb.p->parent();
+
+        switch (nb.del_case)
+        {
+        case CASE_2:
+            nb.s->set_color(RED);
+            nb = BSTNode::BHVNeighborhood(nb.p, pdir);
+            break;
+        case CASE_3:
+            nb.s = nb.p->dir_rotate(nb.dir);
+            if (pdir != ROOT)
+            {
+                grandparent->set_child(pdir, nb.s);
+            }
+            swap_colors(nb.p, nb.s);
+            nb.find_case();
+            assert(nb.del_case >= CASE_4);
+            break;
+        case CASE_4:
+            swap_colors(nb.p, nb.s);
+            return;
+        case CASE_5:
+            nb.p->set_child(opposite_direction(nb.dir),
+                            nb.s->dir_rotate(opposite_direction(nb.dir)));
+            swap_colors(nb.c, nb.s);
+            nb.find_case();
+            assert(nb.del_case == CASE_6);
+            break;
+        case CASE_6:
+            nb.s = nb.p->dir_rotate(nb.dir);
+            if (pdir != ROOT)
+            {
+                grandparent->set_child(pdir, nb.s);
+            }
+            swap_colors(nb.p, nb.s);
+            nb.d->set_color(BLACK);
+            return;
+        default:
+            // CASE_NONE or CASE_1 (should never happen; nb.p is non-null)
+            assert(false);
+            break;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_remove_helper(const Key &value,
+                                                    BHVNeighborhood &nb)
+{
+    // This is implemented for you
+    BSTNode *root = this;
+    BSTNode *top = this->parent();
+    BSTNode *node = this;
+    while (!node->is_empty())
+    {
+        if (key_less(value, node->data))
+        {
+            nb.dir = LEFT;
+            node = node->left;
+        }
+        else if (key_less(node->data, value))
+        {
+            nb.dir = RIGHT;
+            node = node->right;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (node->is_empty())
+    {
+        return root;
+    }
+
+    // We found the value. Remove it.
+    if (node->count > 1)
+    {
+        node->count--;
+        add_to_path(node, top, 0, -1, node->data);
+        return root;
+    }
+
+    // One node and one occurrence of value leave every subtree on the path
+    add_to_path(node, top, -1, -1, node->data);
+
+    if (!node->left->is_empty() && !node->right->is_empty())
+    {
+        /*
+         * node has two children.
+         *
+         * Find the successor to use as a replacement and trade entries with
+         * it, so that the key being removed (with its count of 1) is now in
+         * the successor's node, which has no left child. Remove that node
+         * instead.
+         */
+        BSTNode *replacement = node->right;
+        nb.dir = RIGHT;
+        while (!replacement->left->is_empty())
+        {
+            replacement = replacement->left;
+            nb.dir = LEFT;
+        }
+        add_to_path(replacement->parent(), node, -1, -replacement->count,
+                    replacement->data);
+        swap_entries(node, replacement);
+        node = replacement;
+    }
+
+    BSTNode *up = node->parent();
+    BSTNode *child = nil();
+    if (node->left->is_empty() && node->right->is_empty())
+    {
+        // node has no children. We may have to do extra work.
+
+        // Get its neighborhood
+        nb = BHVNeighborhood(node, nb.dir);
+    }
+    else
+    {
+        // node has one child. Promote node's child
+        child = node->left->is_empty() ? node->right : node->left;
+        child->set_color(node->color());
+        child->set_parent(up);
+        node->left = nil();
+        node->right = nil();
+    }
+
+    // Delete node; its parent now points at its child or the nil sentinel
+    if (node == root)
+    {
+        root = child;
+    }
+    else
+    {
+        up->set_child(nb.dir, child);
+    }
+    delete node;
+    return root;
+}
+
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::dir_rotate(Direction dir)
+{
+    // This is implemented for you.
+    BSTNode *root = this;
+    if (dir == LEFT)
+    {
+        root = root->left_rotate();
+    }
+    else if (dir == RIGHT)
+    {
+        root = root->right_rotate();
+    }
+    return root;
+}
+
+/*
+ * Parameters: Node this - the root of the tree.
+ * Returns:  pointer to the root of rotated tree, whose parent pointer is
+     *      the parent of this.
+ * Purpose:  right rotate tree rooted at this
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::right_rotate()
+{
+    BSTNode *newroot = left;
+    BSTNode *up = this->parent();
+    left = newroot->right; 
+    
+    // Update parents
+    if (up != nullptr)
+    {
+        (up->left == this) ? (up->left = newroot) : (up->right = newroot);
+    }
+   
+    newroot->right = this; 
+    newroot->set_parent(up); 
+    this->set_parent(newroot); 
+    
+    // Update the parent of the subtree that changed hands
+    this->make_locally_consistent();
+    newroot->make_locally_consistent();
+    return newroot;
+}
+
+/*
+ * Parameters: Node this - the root of the tree.
+ * Returns:  pointer to the root of rotated tree, whose parent pointer is
+     *      the parent of this.
+ * Purpose:  left rotate tree rooted at this
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::left_rotate()
+{
+    BSTNode *newroot = right;
+    BSTNode *up = this->parent();
+    right = newroot->left; 
+    
+    // Update parents
+    if (up != nullptr)
+    {
+        (up->left == this) ? (up->left = newroot) : (up->right = newroot);
+    }
+   
+    newroot->left = this; 
+    newroot->set_parent(up); 
+    this->set_parent(newroot); 
+    
+    // Update the parent of the subtree that changed hands
+    this->make_locally_consistent();
+    newroot->make_locally_consistent();
+    return newroot;
+}
+
+/*
+ * Parameters: Node this - the root of an almost-balanced AVL Tree.
+     *        int balance - the height difference of this's subtrees, which
+     *              is -2 or +2 and therefore cannot be stored in this yet
+ * Returns:  the balanced tree.
+ * Purpose:  balances the tree rooted at this with a single or double
+     *      rotation, and sets the balance factor of every rotated node.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_balance(int balance)
+{
+    if(balance > 1)//if the tree is right heavy
+    {
+        BSTNode *r = this->right;
+        
+        if (r->balance() >= 0)//RR
+        {
+            // r is balanced only after a removal; then the rotation
+            // leaves the tree as tall as it was
+            int r_balance = r->balance();
+            BSTNode *root = left_rotate();
+            this->set_balance(1 - r_balance);
+            root->set_balance(r_balance - 1);
+            return root;
+        }
+        else //RL
+        {
+            int rl_balance = r->left->balance();
+            this->right = r->right_rotate();
+            BSTNode *root = left_rotate();
+            this->set_balance(rl_balance > 0 ? -1 : 0);
+            r->set_balance(rl_balance < 0 ? 1 : 0);
+            root->set_balance(0);
+            return root;
+        }
+    }
+    else if (balance < -1) //left heavy 
+    {
+        BSTNode *l = this->left;
+        
+        if (l->balance() <= 0) //LL
+        {
+            int l_balance = l->balance();
+            BSTNode *root = right_rotate();
+            this->set_balance(-1 - l_balance);
+            root->set_balance(l_balance + 1);
+            return root;
+        }
+        else //LR
+        {
+            int lr_balance = l->right->balance();
+            this->left = l->left_rotate();
+            BSTNode *root = right_rotate();
+            this->set_balance(lr_balance < 0 ? 1 : 0);
+            l->set_balance(lr_balance > 0 ? -1 : 0);
+            root->set_balance(0);
+            return root;
+        }
+    }
+    this->set_balance(balance);
+    return this;
+}
+
+/*
+ * Parameters: Node this - the root of an AVL Tree
+     *        Direction dir - the side whose subtree just got one level taller
+     *        bool grew - set to whether the tree rooted at this got taller
+ * Returns:  the root of the rebalanced tree
+ * Purpose:  updates this's balance factor after an insertion below it,
+     *      rotating if the tree became unbalanced. After an insertion a
+     *      rotation always restores the original height.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_regrow(Direction dir, bool &grew)
+{
+    int balance = this->balance() + (dir == RIGHT ? 1 : -1);
+    grew = (balance == 1 || balance == -1);
+    return this->avl_balance(balance);
+}
+
+/*
+ * Parameters: Node this - the root of an AVL Tree
+     *        Direction dir - the side whose subtree just got one level shorter
+     *        bool shrank - set to whether the tree rooted at this got shorter
+ * Returns:  the root of the rebalanced tree
+ * Purpose:  updates this's balance factor after a removal below it,
+     *      rotating if the tree became unbalanced. A rotation shortens the
+     *      tree unless the taller child was itself balanced.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::avl_reshrink(Direction dir, bool &shrank)
+{
+    int balance = this->balance() + (dir == LEFT ? 1 : -1);
+    if (balance == 2 || balance == -2)
+    {
+        BSTNode *taller = this->child(balance > 0 ? RIGHT : LEFT);
+        shrank = (taller->balance() != 0);
+    }
+    else
+    {
+        shrank = (balance == 0);
+    }
+    return this->avl_balance(balance);
+}
+
+/*
+ * Parameters: Node this - the root of a Red-Black tree.
+ * Returns:  A pointer to the root of the balanced tree
+ * Purpose:  Eliminates the red-red violation (if there is one) in the
+     *      neighborhood of this, meaning this and its children and one of its
+     *      grandchildren (the grandchild that is the cause of a red-red
+     *      violation, if there is one). The black-height of the returned tree
+     *      is the same as the black-height of this and the returned node is
+     *      the root of a Red-Black tree, with the possible exception that it
+     *      is RED. If there is no violation, return this unchanged.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+BSTNode<Key, Value, Compare, Sum> *
+BSTNode<Key, Value, Compare, Sum>::rb_eliminate_red_red_violation()
+{
+    /*
+     * Get this's neighborhood (children + grandchildren), which might have
+     *  shape NONE if this is BLACK or this.height <= 1 or there is no red-red
+     *  violation in the neighborhood of this.
+     */
+    RRVNeighborhood nb(this);
+
+    if (nb.shape != SHAPE_NONE)
+    {
+        if(nb.y->color() == BLACK)
+        {
+            if(nb.shape == LL)
+            {
+                nb.g->right_rotate();
+                nb.g->set_color(RED); 
+                nb.p->set_color(BLACK); 
+            }   
+            else if(nb.shape == RR)
+            {
+                nb.g->left_rotate(); 
+                nb.g->set_color(RED); 
+                nb.p->set_color(BLACK); 
+            } 
+            else if(nb.shape == LR)
+            {
+                nb.p = nb.p->left_rotate();
+                nb.g->right_rotate();
+                swap_colors(nb.p, nb.g);
+                // nb.g->set_color(RED); 
+                // nb.x->set_color(BLACK);
+            } 
+            else if(nb.shape == RL)
+            {
+
+                nb.p = nb.p->right_rotate();
+                nb.g->left_rotate();
+                swap_colors(nb.g,nb.p);
+                // nb.g->set_color(RED); 
+                // nb.x->set_color(BLACK); 
+            } 
+            this->make_locally_consistent();
+            return nb.p;
+        }
+        else if (nb.y->color() == RED)
+        {
+            nb.g->set_color(RED); 
+            nb.y->set_color(BLACK); 
+            nb.p->set_color(BLACK); 
+            return this;
+        }
+        
+    }
+    return this;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+int BSTNode<Key, Value, Compare, Sum>::balance() const
+{
+    // Sign-extend the two-bit field: 00 is 0, 01 is +1 and 11 is -1
+    int bits = (int)((this->parent_meta & BALANCE_MASK) >> BALANCE_SHIFT);
+    return (bits ^ 2) - 2;
+}
+
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::set_balance(int balance)
+{
+    assert(balance >= -1 && balance <= 1);
+    std::uintptr_t bits = ((std::uintptr_t)balance << BALANCE_SHIFT) &
+                          BALANCE_MASK;
+    if ((this->parent_meta & BALANCE_MASK) != bits)
+    {
+        this->parent_meta = (this->parent_meta & ~BALANCE_MASK) | bits;
+    }
+}
+
+/*
+ * Parameters:  Node this - the root of the tree to make consistent
+ * Returns: N/A
+ * Purpose:  Updates the tree rooted at this to be locally consistent, in the
+     *      following way:
+     *        - this.left.parent = this
+     *        - this.right.parent = this
+     *        - this.size, this.total and this.sum are recomputed from the
+     *          children
+     *  If this is empty, or a child is the nil sentinel, nothing is done to
+     *      it. A rotation calls this on the node it lowers and then on the
+     *      node it raises, so both are recounted bottom-up, and since the
+     *      rotated subtree holds the same entries as before, nothing above
+     *      it needs recounting.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::make_locally_consistent()
+{
+    if(!this->is_empty())
+    {
+        // The nil sentinel is shared, so it never records a parent
+        if (!this->left->is_empty())
+        {
+            this->left->set_parent(this); 
+        }
+        if (!this->right->is_empty())
+        {
+            this->right->set_parent(this); 
+        }
+        this->size = this->left->size + this->right->size + 1;
+        this->total = this->left->total + this->right->total + this->count;
+        this->resum(*this->left, *this->right, this->data, this->count);
+    }
+}
+
+/*
+ * Parameters: Node node - a node whose subtree just gained or lost entries
+     *        Node top - the parent of the root of node's tree
+     *        int nodes, counts - the changes in size and total
+     *        Key key - the key whose count changed by counts
+ * Returns: N/A
+ * Purpose: each insertion or removal changes the size, total and sum of
+     *      exactly the nodes on one path, so they are adjusted in place
+     *      rather than recomputed, which would read every sibling on the
+     *      path too. This is done before any rebalancing, so that rotations
+     *      always find their children's aggregates correct.
+ */
+template <typename Key, typename Value, typename Compare, typename Sum>
+void BSTNode<Key, Value, Compare, Sum>::add_to_path(BSTNode *node, BSTNode *top,
+                                                    int nodes, int counts,
+                                                    const Key &key)
+{
+    for (; node != top; node = node->parent())
+    {
+        node->size += nodes;
+        node->total += counts;
+        node->add_to_sum(key, counts);
+    }
+}
+
+#undef ABORT_UNLESS
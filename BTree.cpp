@@ -0,0 +1,458 @@
+/*
+ * Filename: BTree.cpp
+ * Contains: Implementation of B-Trees
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+#include "BTree.h"
+
+using namespace std;
+
+/*
+ * Parameters: Node node - a node of a B-Tree
+ *             int depth - the depth of node
+ *             ostream out - the stream to print to
+ * Returns: N/A
+ * Purpose: prints node indented by its depth, followed by its children.
+ */
+static void print_node(const BTreeNode *node, int depth, ostream &out)
+{
+    out << string(4 * depth, ' ') << node->to_string() << "\n";
+    if (!node->leaf)
+    {
+        for (int i = 0; i <= node->size; i++)
+        {
+            print_node(node->child(i), depth + 1, out);
+        }
+    }
+}
+
+/******************************
+ * BEGIN PUBLIC BTREE SECTION *
+ ******************************/
+
+/*
+ * Every node of the tree is carved from this->leaves or this->branches, so
+ *  destroying the tree releases their chunks in one pass instead of walking
+ *  the nodes.
+ */
+BTree::BTree()
+    : leaves(sizeof(BTreeNode), alignof(BTreeNode)),
+      branches(sizeof(BTreeBranch), alignof(BTreeBranch)), root(nullptr) {}
+
+BTree::BTree(const BTree &source)
+    : leaves(sizeof(BTreeNode), alignof(BTreeNode)),
+      branches(sizeof(BTreeBranch), alignof(BTreeBranch)), root(nullptr)
+{
+    if (source.root)
+    {
+        this->root = this->copy_node(source.root);
+    }
+}
+
+BTree::~BTree()
+{
+    // Nothing to do: the pools free every node when they are destroyed.
+}
+
+/*
+ * Parameters: the source tree that needs to be copied
+ * Returns: a pointer to the tree
+ * Purpose:  Assignment overload. Assigns rhs to this by deep copy.
+ */
+BTree &BTree::operator=(const BTree &source)
+{
+    // Check for self-assignment
+    if (this != &source)
+    {
+        // Drop the existing tree all at once, then copy into the empty pools
+        this->leaves.release();
+        this->branches.release();
+        this->root = nullptr;
+
+        if (source.root)
+        {
+            this->root = this->copy_node(source.root);
+        }
+    }
+    return *this;
+}
+
+int BTree::minimum_value() const
+{
+    const BTreeNode *curr = this->root;
+    while (!curr->leaf)
+    {
+        curr = curr->child(0);
+    }
+    return curr->keys[0];
+}
+
+int BTree::maximum_value() const
+{
+    const BTreeNode *curr = this->root;
+    while (!curr->leaf)
+    {
+        curr = curr->child(curr->size);
+    }
+    return curr->keys[curr->size - 1];
+}
+
+unsigned int BTree::count_of(int value) const
+{
+    const BTreeNode *curr = this->root;
+    while (curr)
+    {
+        int i = curr->lower_bound(value);
+        if (i < curr->size && curr->keys[i] == value)
+        {
+            return curr->counts[i];
+        }
+        curr = curr->leaf ? nullptr : curr->child(i);
+    }
+    return 0;
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             int value - value to insert
+ * Returns: N/A
+ * Purpose: splits every full node on the way down, so that the leaf reached
+ *      has room for value and no split ever has to travel back up (CLRS
+ *      18.2). A full root is split first, which is the only way the tree
+ *      grows taller.
+ */
+void BTree::insert(int value)
+{
+    if (!this->root)
+    {
+        this->root = this->new_node(true);
+    }
+    if (this->root->size == BTreeNode::MAX_KEYS)
+    {
+        BTreeBranch *top = static_cast<BTreeBranch *>(this->new_node(false));
+        top->children[0] = this->root;
+        this->root = top;
+        this->split_child(top, 0);
+    }
+
+    BTreeNode *curr = this->root;
+    while (true)
+    {
+        int i = curr->lower_bound(value);
+        if (i < curr->size && curr->keys[i] == value)
+        {
+            curr->counts[i]++;
+            return;
+        }
+        if (curr->leaf)
+        {
+            curr->insert_key(i, value, 1);
+            return;
+        }
+
+        BTreeBranch *branch = static_cast<BTreeBranch *>(curr);
+        if (branch->children[i]->size == BTreeNode::MAX_KEYS)
+        {
+            this->split_child(branch, i);
+            if (branch->keys[i] == value)
+            {
+                branch->counts[i]++;
+                return;
+            }
+            if (branch->keys[i] < value)
+            {
+                i++;
+            }
+        }
+        curr = branch->children[i];
+    }
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             int value - the value to remove
+ * Returns: N/A
+ * Purpose: finds value first, so that a value that is absent or that only
+ *      needs its count decremented leaves the shape of the tree alone.
+ */
+void BTree::remove(int value)
+{
+    BTreeNode *curr = this->root;
+    while (curr)
+    {
+        int i = curr->lower_bound(value);
+        if (i < curr->size && curr->keys[i] == value)
+        {
+            if (curr->counts[i] > 1)
+            {
+                curr->counts[i]--;
+            }
+            else
+            {
+                this->erase(value);
+            }
+            return;
+        }
+        curr = curr->leaf ? nullptr : curr->child(i);
+    }
+}
+
+int BTree::tree_height() const
+{
+    return this->root ? this->root->node_height() : -1;
+}
+
+int BTree::node_count() const
+{
+    return this->root ? this->root->node_count() : 0;
+}
+
+int BTree::count_total() const
+{
+    return this->root ? this->root->count_total() : 0;
+}
+
+void BTree::print_tree() const
+{
+    if (!this->root)
+    {
+        std::cout << "[]\n";
+        return;
+    }
+    print_node(this->root, 0, std::cout);
+}
+
+/*******************************
+ * BEGIN PRIVATE BTREE SECTION *
+ *******************************/
+
+BTreeNode *BTree::new_node(bool leaf)
+{
+    if (leaf)
+    {
+        return new (this->leaves.allocate()) BTreeNode(true);
+    }
+    return new (this->branches.allocate()) BTreeBranch();
+}
+
+void BTree::delete_node(BTreeNode *node)
+{
+    if (node->leaf)
+    {
+        this->leaves.deallocate(node);
+    }
+    else
+    {
+        this->branches.deallocate(node);
+    }
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             Node source - the root of a B-Tree
+ * Returns: the root of a deep copy of source, allocated from this
+ * Purpose: copies each node whole, then replaces its children with copies.
+ *      A B-Tree is shallow, so recursion is fine here.
+ */
+BTreeNode *BTree::copy_node(const BTreeNode *source)
+{
+    if (source->leaf)
+    {
+        return new (this->leaves.allocate()) BTreeNode(*source);
+    }
+
+    const BTreeBranch *branch = static_cast<const BTreeBranch *>(source);
+    BTreeBranch *copy = new (this->branches.allocate()) BTreeBranch(*branch);
+    for (int i = 0; i <= copy->size; i++)
+    {
+        copy->children[i] = this->copy_node(branch->children[i]);
+    }
+    return copy;
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             Branch parent - a branch of this that is not full
+ *             int i - index of a full child of parent
+ * Returns: N/A
+ * Purpose: the full child keeps its first MIN_KEYS keys, its median moves up
+ *      into parent, and the rest move to a new sibling.
+ */
+void BTree::split_child(BTreeBranch *parent, int i)
+{
+    BTreeNode *full = parent->children[i];
+    BTreeNode *sibling = this->new_node(full->leaf);
+    int median = BTreeNode::MIN_KEYS;
+
+    sibling->size = full->size - median - 1;
+    copy(full->keys + median + 1, full->keys + full->size, sibling->keys);
+    copy(full->counts + median + 1, full->counts + full->size,
+         sibling->counts);
+    if (!full->leaf)
+    {
+        BTreeBranch *from = static_cast<BTreeBranch *>(full);
+        copy(from->children + median + 1, from->children + full->size + 1,
+             static_cast<BTreeBranch *>(sibling)->children);
+    }
+    full->size = median;
+
+    parent->insert_key(i, full->keys[median], full->counts[median]);
+    parent->insert_child(i + 1, sibling);
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             Branch parent - a branch of this
+ *             int i - index of a key of parent whose children both hold
+ *                 MIN_KEYS keys
+ * Returns: N/A
+ * Purpose: the merged child holds 2 * MIN_KEYS + 1 == MAX_KEYS keys.
+ */
+void BTree::merge_children(BTreeBranch *parent, int i)
+{
+    BTreeNode *left = parent->children[i];
+    BTreeNode *right = parent->children[i + 1];
+
+    left->keys[left->size] = parent->keys[i];
+    left->counts[left->size] = parent->counts[i];
+    copy(right->keys, right->keys + right->size, left->keys + left->size + 1);
+    copy(right->counts, right->counts + right->size,
+         left->counts + left->size + 1);
+    if (!left->leaf)
+    {
+        BTreeBranch *from = static_cast<BTreeBranch *>(right);
+        copy(from->children, from->children + right->size + 1,
+             static_cast<BTreeBranch *>(left)->children + left->size + 1);
+    }
+    left->size += 1 + right->size;
+
+    parent->erase_key(i);
+    parent->erase_child(i + 1);
+    this->delete_node(right);
+}
+
+/*
+ * Parameters: BTree this - the tree
+ *             int value - a value in this whose count is 1
+ * Returns: N/A
+ * Purpose: every node entered below the root holds more than MIN_KEYS keys,
+ *      so a key can always be taken from it without another pass. A key in
+ *      a branch is swapped for its predecessor or successor, which is then
+ *      removed from the leaf it came from. Only an emptied root makes the
+ *      tree shorter.
+ */
+void BTree::erase(int value)
+{
+    BTreeNode *curr = this->root;
+    while (true)
+    {
+        int i = curr->lower_bound(value);
+        bool found = i < curr->size && curr->keys[i] == value;
+        if (curr->leaf)
+        {
+            if (found)
+            {
+                curr->erase_key(i);
+            }
+            break;
+        }
+
+        BTreeBranch *branch = static_cast<BTreeBranch *>(curr);
+        if (found)
+        {
+            BTreeNode *left = branch->children[i];
+            BTreeNode *right = branch->children[i + 1];
+            if (left->size > BTreeNode::MIN_KEYS)
+            {
+                const BTreeNode *pred = left;
+                while (!pred->leaf)
+                {
+                    pred = pred->child(pred->size);
+                }
+                branch->keys[i] = pred->keys[pred->size - 1];
+                branch->counts[i] = pred->counts[pred->size - 1];
+                value = branch->keys[i];
+                curr = left;
+            }
+            else if (right->size > BTreeNode::MIN_KEYS)
+            {
+                const BTreeNode *succ = right;
+                while (!succ->leaf)
+                {
+                    succ = succ->child(0);
+                }
+                branch->keys[i] = succ->keys[0];
+                branch->counts[i] = succ->counts[0];
+                value = branch->keys[i];
+                curr = right;
+            }
+            else
+            {
+                this->merge_children(branch, i);
+                curr = left;
+            }
+            continue;
+        }
+
+        BTreeNode *next = branch->children[i];
+        if (next->size == BTreeNode::MIN_KEYS)
+        {
+            BTreeNode *before = i > 0 ? branch->children[i - 1] : nullptr;
+            BTreeNode *after = i < branch->size ? branch->children[i + 1]
+                                                : nullptr;
+            if (before && before->size > BTreeNode::MIN_KEYS)
+            {
+                // Rotate the last key of the left sibling through the parent
+                next->insert_key(0, branch->keys[i - 1], branch->counts[i - 1]);
+                if (!next->leaf)
+                {
+                    static_cast<BTreeBranch *>(next)->insert_child(
+                        0, before->child(before->size));
+                }
+                branch->keys[i - 1] = before->keys[before->size - 1];
+                branch->counts[i - 1] = before->counts[before->size - 1];
+                before->size--;
+            }
+            else if (after && after->size > BTreeNode::MIN_KEYS)
+            {
+                // Rotate the first key of the right sibling through the parent
+                next->keys[next->size] = branch->keys[i];
+                next->counts[next->size] = branch->counts[i];
+                if (!next->leaf)
+                {
+                    static_cast<BTreeBranch *>(next)->children[next->size + 1] =
+                        after->child(0);
+                }
+                next->size++;
+                branch->keys[i] = after->keys[0];
+                branch->counts[i] = after->counts[0];
+                after->erase_key(0);
+                if (!after->leaf)
+                {
+                    static_cast<BTreeBranch *>(after)->erase_child(0);
+                }
+            }
+            else if (after)
+            {
+                this->merge_children(branch, i);
+            }
+            else
+            {
+                this->merge_children(branch, i - 1);
+                next = before;
+            }
+        }
+        curr = next;
+    }
+
+    if (this->root->size == 0)
+    {
+        BTreeNode *old_root = this->root;
+        this->root = old_root->leaf ? nullptr : old_root->child(0);
+        this->delete_node(old_root);
+    }
+}
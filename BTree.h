@@ -0,0 +1,174 @@
+/*
+ * Filename: BTree.h
+ * Contains: Interface of B-Trees
+ */
+
+#pragma once
+
+#include <iostream>
+
+#include "BTreeNode.h"
+#include "NodePool.h"
+
+class BTree
+{
+private:
+    /**
+     * The slab allocators that own the leaves and the branches of this
+     *  tree. Their slots are cache-line aligned.
+     */
+    NodePool leaves;
+    NodePool branches;
+
+    /**
+     * The root of this tree, or nullptr if this is empty.
+     */
+    BTreeNode *root;
+
+    /**
+     * Input: BTree this - the tree
+     *        bool leaf - whether the new node is a leaf
+     * Returns: a new node with no keys, carved from the matching pool
+     */
+    BTreeNode *new_node(bool leaf);
+
+    /**
+     * Input: BTree this - the tree
+     *        Node node - a node of this, already unlinked from the tree
+     * Returns: N/A
+     * Does: returns node to the pool it was carved from
+     */
+    void delete_node(BTreeNode *node);
+
+    /**
+     * Input: BTree this - the tree
+     *        Node source - the root of a B-Tree
+     * Returns: the root of a deep copy of source, allocated from this
+     */
+    BTreeNode *copy_node(const BTreeNode *source);
+
+    /**
+     * Input: BTree this - the tree
+     *        Branch parent - a branch of this that is not full
+     *        int i - index of a full child of parent
+     * Returns: N/A
+     * Does: moves the median key of the child up into parent at i, and the
+     *      keys after it into a new sibling at i + 1
+     */
+    void split_child(BTreeBranch *parent, int i);
+
+    /**
+     * Input: BTree this - the tree
+     *        Branch parent - a branch of this
+     *        int i - index of a key of parent whose children both hold
+     *            MIN_KEYS keys
+     * Returns: N/A
+     * Does: moves the key at i and every key of the right child into the
+     *      left child, and frees the right child
+     */
+    void merge_children(BTreeBranch *parent, int i);
+
+    /**
+     * Input: BTree this - the tree
+     *        int value - a value in this whose count is 1
+     * Returns: N/A
+     * Does: removes value from this in one pass down from the root, making
+     *      sure every node entered has a key to spare (CLRS 18.3)
+     */
+    void erase(int value);
+
+public:
+    /**
+     * Default constructor. Creates an empty tree.
+     */
+    BTree();
+
+    /**
+     * Copy constructor. Creates a new tree as a deep copy of source
+     */
+    BTree(const BTree &source);
+
+    /**
+     * Destructor. Frees all memory owned by this.
+     */
+    ~BTree();
+
+    /**
+     * Assignment overload. Assigns rhs to this by deep copy.
+     */
+    BTree &operator=(const BTree &rhs);
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: the minimum value in this
+     * Does: Searches this for its minimum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    int minimum_value() const;
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: the maximum value in this
+     * Does: Searches this for its maximum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    int maximum_value() const;
+
+    /**
+     * Input: BTree this - the tree
+     *        int value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches the tree for value
+     */
+    unsigned int count_of(int value) const;
+
+    /**
+     * Input: BTree this - the tree
+     *        int value - value to insert
+     * Returns: N/A
+     * Does: Inserts value into this, either by adding a new key or, if value
+     *      is already in this, by incrementing that key's count. Full nodes
+     *      are split on the way down, so the insertion takes a single pass.
+     */
+    void insert(int value);
+
+    /**
+     * Input: BTree this - the tree
+     *        int value - the value to remove
+     * Returns: N/A
+     * Does: Removes value from the tree. If a key's count is greater than
+     *      1, the count is decremented and the key is not removed.
+     */
+    void remove(int value);
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: the height of this
+     * Does: returns the number of levels of nodes below the root. (An empty
+     *      tree has height -1.)
+     */
+    int tree_height() const;
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: The number of distinct values in this tree
+     * Does: Counts and returns the number of keys in this; like the nodes of
+     *      a binary tree, each key holds one distinct value
+     */
+    int node_count() const;
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Does: Computes and returns the sum of all counts in this
+     */
+    int count_total() const;
+
+    /**
+     * Input: BTree this - the tree
+     * Returns: N/A
+     * Does: Prints the tree one node per line, each indented by its depth
+     */
+    void print_tree() const;
+};
@@ -0,0 +1,211 @@
+/*
+ * Filename: BTreeNode.cpp
+ * Contains: Implementation of B-Tree Nodes
+ */
+
+#include "BTreeNode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static_assert(sizeof(BTreeNode) == 128, "a B-Tree leaf should be two cache lines");
+static_assert(sizeof(BTreeBranch) == 256, "a B-Tree branch should be four cache lines");
+
+BTreeNode::BTreeNode(bool leaf) : size(0), leaf(leaf) {}
+
+/*
+ * In-node search. keys and size together fill the node's first cache line,
+ *  so the keys can be compared with value 4, 8 or 16 at a time, and since
+ *  they are sorted, the number that are less than value is the lower bound.
+ *  Lanes at and past size (including the lane that loads size itself) are
+ *  masked off. The widest routine this CPU supports is picked by asking
+ *  CPUID, on the first search (see lower_bound_resolve below).
+ */
+static int lower_bound_scalar(const int *keys, int size, int value)
+{
+    int i = 0;
+    while (i < size && keys[i] < value)
+    {
+        i++;
+    }
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2")))
+static int lower_bound_sse2(const int *keys, int size, int value)
+{
+    const __m128i *lanes = reinterpret_cast<const __m128i *>(keys);
+    __m128i needle = _mm_set1_epi32(value);
+    unsigned int less = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i lt = _mm_cmpgt_epi32(needle, _mm_load_si128(lanes + i));
+        less |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(lt)) << (4 * i);
+    }
+    return __builtin_popcount(less & ((1u << size) - 1));
+}
+
+__attribute__((target("avx2")))
+static int lower_bound_avx2(const int *keys, int size, int value)
+{
+    const __m256i *lanes = reinterpret_cast<const __m256i *>(keys);
+    __m256i needle = _mm256_set1_epi32(value);
+    __m256i lo = _mm256_cmpgt_epi32(needle, _mm256_load_si256(lanes));
+    __m256i hi = _mm256_cmpgt_epi32(needle, _mm256_load_si256(lanes + 1));
+    unsigned int less =
+        (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(lo)) |
+        (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8;
+    return __builtin_popcount(less & ((1u << size) - 1));
+}
+
+#endif
+
+static int lower_bound_resolve(const int *keys, int size, int value);
+
+/*
+ * The routine lower_bound() calls. It starts out as lower_bound_resolve, so
+ *  that the first search (even one made during static initialization) picks
+ *  the real routine and stores it here. Threads that race to resolve it all
+ *  store the same routine.
+ */
+static atomic<int (*)(const int *, int, int)> node_lower_bound(
+    lower_bound_resolve);
+
+static int lower_bound_resolve(const int *keys, int size, int value)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    int (*routine)(const int *, int, int) =
+        __builtin_cpu_supports("avx2")   ? lower_bound_avx2
+        : __builtin_cpu_supports("sse2") ? lower_bound_sse2
+                                         : lower_bound_scalar;
+#else
+    int (*routine)(const int *, int, int) = lower_bound_scalar;
+#endif
+    node_lower_bound.store(routine, memory_order_relaxed);
+    return routine(keys, size, value);
+}
+
+static_assert(offsetof(BTreeNode, keys) == 0 &&
+                  offsetof(BTreeNode, size) == 4 * BTreeNode::MAX_KEYS &&
+                  BTreeNode::MAX_KEYS == 15,
+              "in-node search loads the keys and size as one 64-byte line");
+
+int BTreeNode::lower_bound(int value) const
+{
+    return node_lower_bound.load(memory_order_relaxed)(this->keys, this->size,
+                                                      value);
+}
+
+BTreeNode *BTreeNode::child(int i) const
+{
+    return static_cast<const BTreeBranch *>(this)->children[i];
+}
+
+void BTreeNode::insert_key(int i, int key, int count)
+{
+    copy_backward(this->keys + i, this->keys + this->size,
+                  this->keys + this->size + 1);
+    copy_backward(this->counts + i, this->counts + this->size,
+                  this->counts + this->size + 1);
+    this->keys[i] = key;
+    this->counts[i] = count;
+    this->size++;
+}
+
+void BTreeNode::erase_key(int i)
+{
+    copy(this->keys + i + 1, this->keys + this->size, this->keys + i);
+    copy(this->counts + i + 1, this->counts + this->size, this->counts + i);
+    this->size--;
+}
+
+int BTreeNode::node_count() const
+{
+    int total = this->size;
+    if (!this->leaf)
+    {
+        for (int i = 0; i <= this->size; i++)
+        {
+            total += this->child(i)->node_count();
+        }
+    }
+    return total;
+}
+
+int BTreeNode::count_total() const
+{
+    int total = 0;
+    for (int i = 0; i < this->size; i++)
+    {
+        total += this->counts[i];
+    }
+    if (!this->leaf)
+    {
+        for (int i = 0; i <= this->size; i++)
+        {
+            total += this->child(i)->count_total();
+        }
+    }
+    return total;
+}
+
+/*
+ * Parameters: Node this - the root of a B-Tree
+ * Returns: the number of edges on the path from this to a leaf
+ * Purpose: all leaves are at the same depth, so following the leftmost
+ *      child is enough. Runtime: O(log n)
+ */
+int BTreeNode::node_height() const
+{
+    int height = 0;
+    const BTreeNode *curr = this;
+    while (!curr->leaf)
+    {
+        curr = curr->child(0);
+        height++;
+    }
+    return height;
+}
+
+std::string BTreeNode::to_string() const
+{
+    std::string value = "[";
+    for (int i = 0; i < this->size; i++)
+    {
+        if (i > 0)
+        {
+            value += " ";
+        }
+        value += std::to_string(this->keys[i]);
+        if (this->counts[i] > 1)
+        {
+            value += "*";
+        }
+    }
+    return value + "]";
+}
+
+BTreeBranch::BTreeBranch() : BTreeNode(false) {}
+
+void BTreeBranch::insert_child(int i, BTreeNode *child)
+{
+    copy_backward(this->children + i, this->children + this->size,
+                  this->children + this->size + 1);
+    this->children[i] = child;
+}
+
+void BTreeBranch::erase_child(int i)
+{
+    copy(this->children + i + 1, this->children + this->size + 2,
+         this->children + i);
+}
@@ -0,0 +1,143 @@
+/*
+ * Filename: BTreeNode.h
+ * Contains: Interface of B-Tree Nodes
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * B-Tree Node:
+ *    - keys[0..size) are the distinct values stored in this node, in
+ *      increasing order
+ *    - counts[i] is the number of times keys[i] has been inserted into the
+ *      tree (minus the number of times it has been removed from the tree)
+ *    - leaf is true iff this node has no children. Every node that is not a
+ *      leaf is a BTreeBranch, and has size + 1 children
+ *
+ * keys and size fill the first cache line of a node and counts and leaf the
+ *  second, so a search reads one line per level and touches the second only
+ *  when it finds its value. A leaf is 128 bytes; a branch adds a child
+ *  pointer per gap between keys and is 256 bytes.
+ */
+class alignas(64) BTreeNode
+{
+public:
+    /**
+     * Every node but the root holds between MIN_KEYS and MAX_KEYS keys.
+     *  Splitting a full node leaves MIN_KEYS keys on either side of the key
+     *  moved up.
+     */
+    static const int MAX_KEYS = 15;
+    static const int MIN_KEYS = MAX_KEYS / 2;
+
+    int keys[MAX_KEYS];
+    int size;
+    int counts[MAX_KEYS];
+    bool leaf;
+
+    /**
+     * Input: bool leaf - whether the node is a leaf
+     * Returns: a newly-created node with no keys
+     */
+    explicit BTreeNode(bool leaf);
+
+    /**
+     * Input: Node this - the node
+     *        int value - value to search for
+     * Returns: the index of the first key in this that is not less than
+     *      value, or size if there is none. This is also the index of the
+     *      child whose subtree may hold value.
+     * Does: compares value with every key at once using SSE2 or AVX2 where
+     *      the CPU has them, and a linear scan otherwise
+     */
+    int lower_bound(int value) const;
+
+    /**
+     * Input: Node this - a node that is not a leaf
+     *        int i - index of a child, 0 <= i <= size
+     * Returns: the i-th child of this
+     */
+    BTreeNode *child(int i) const;
+
+    /**
+     * Input: Node this - the node, which is not full
+     *        int i - where to insert, 0 <= i <= size
+     *        int key, count - the entry to insert
+     * Returns: N/A
+     * Does: shifts keys[i..size) and their counts up one place and stores
+     *      the entry at i
+     */
+    void insert_key(int i, int key, int count);
+
+    /**
+     * Input: Node this - the node
+     *        int i - index of the entry to erase, 0 <= i < size
+     * Returns: N/A
+     * Does: shifts keys(i..size) and their counts down one place
+     */
+    void erase_key(int i);
+
+    /**
+     * Input: Node this - the root of a B-Tree
+     * Returns: The number of keys in this tree
+     */
+    int node_count() const;
+
+    /**
+     * Input: Node this - the root of a B-Tree
+     * Returns: the sum of the counts of all keys in this tree
+     */
+    int count_total() const;
+
+    /**
+     * Input: Node this - the root of a B-Tree
+     * Returns: the number of edges on the path from this to a leaf; every
+     *      leaf of a B-Tree is at the same depth
+     */
+    int node_height() const;
+
+    /**
+     * Input: Node this - the node
+     * Returns: the keys of this in brackets, with an asterisk after each key
+     *      whose count is more than 1, e.g. "[2* 4 9]"
+     */
+    std::string to_string() const;
+};
+
+/**
+ * B-Tree Branch: a B-Tree Node that is not a leaf.
+ *    - children[0..size] are the roots of its subtrees. Every key in
+ *      children[i] lies between keys[i - 1] and keys[i].
+ */
+class alignas(64) BTreeBranch : public BTreeNode
+{
+public:
+    BTreeNode *children[MAX_KEYS + 1];
+
+    /**
+     * Input: N/A
+     * Returns: a newly-created branch with no keys and no children
+     */
+    BTreeBranch();
+
+    /**
+     * Input: Branch this - the branch, whose size has just been incremented
+     *            by insert_key
+     *        int i - where to insert, 0 <= i <= size
+     *        Node child - the child to insert
+     * Returns: N/A
+     * Does: shifts children[i..size) up one place and stores child at i
+     */
+    void insert_child(int i, BTreeNode *child);
+
+    /**
+     * Input: Branch this - the branch, whose size has just been decremented
+     *            by erase_key
+     *        int i - index of the child to erase, 0 <= i <= size + 1
+     * Returns: N/A
+     * Does: shifts children(i..size + 1] down one place
+     */
+    void erase_child(int i);
+};
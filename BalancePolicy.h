@@ -0,0 +1,207 @@
+/*
+ * Filename: BalancePolicy.h
+ * Contains: Interface of the balance policies of OrderedTree
+ */
+
+#pragma once
+
+#include <utility>
+
+/*
+ * A balance policy is a struct of static functions that OrderedTree and the
+ *  shared BSTNode descent (insert_with and remove_with) call at fixed points.
+ *  Every function is a template on the node type, so a policy works for any
+ *  key, value and comparator, and every call is resolved at compile time:
+ *
+ *    - insert(root, value, args...) inserts value into the tree rooted at
+ *      root; every policy here but RBTopDownBalance does so with
+ *      BSTNode::insert_with, which calls the next two
+ *    - on_create(node) is called on each new node
+ *    - on_build(node, bottom, balance) is called instead on each node of a
+ *      tree built at once from sorted keys (see BSTNode::build_sorted),
+ *      after its children. bottom is whether node is on the partial bottom
+ *      level of the tree, below the complete ones, and balance is the
+ *      height of node's right subtree minus that of its left
+ *    - after_insert(root, dir, grew) is called on each node on the path back
+ *      up from an insertion, after its dir child was replaced. It returns the
+ *      root of the rebalanced subtree, and sets grew to whether the nodes
+ *      above it may still need rebalancing; the climb stops once it is false
+ *    - remove(root, value) removes value from the tree rooted at root
+ *    - after_remove(root, dir, shrank) is after_insert for remove_with
+ *    - fix_root(root) restores any invariant of the root of a whole tree
+ *    - height(root) returns the height of the tree rooted at root
+ *    - join_height(root) returns the height that join measures the tree
+ *      rooted at root by, and child_join_height(node, height, dir) that of
+ *      node's dir child, given node's, so that BSTNode::split can keep track
+ *      of it on the way down
+ *    - join(left, left_height, middle, right, right_height, height) joins
+ *      left, the single node middle and right, whose keys are in that
+ *      order, into one tree, and sets height to its join_height
+ *
+ * A new policy that needs private BSTNode rebalancing steps must also be
+ *  made a friend of BSTNode.
+ */
+
+/**
+ * Naive Balance: never rebalances, so the tree is a plain BST, and an
+ *  insertion or removal never climbs back up.
+ */
+struct NaiveBalance
+{
+    template <typename Node, typename K, typename... Args>
+    static Node *insert(Node *root, K &&value, Args &&...args);
+
+    template <typename Node>
+    static void on_create(Node *node);
+
+    template <typename Node>
+    static void on_build(Node *node, bool bottom, int balance);
+
+    template <typename Node>
+    static Node *after_insert(Node *root, typename Node::Direction dir,
+                              bool &grew);
+
+    template <typename Node>
+    static Node *remove(Node *root, const typename Node::key_type &value);
+
+    template <typename Node>
+    static Node *after_remove(Node *root, typename Node::Direction dir,
+                              bool &shrank);
+
+    template <typename Node>
+    static void fix_root(Node *root);
+
+    /**
+     * Input: Node root - the root of a tree
+     * Returns: the height of the tree rooted at root, counting every node
+     */
+    template <typename Node>
+    static int height(const Node *root);
+
+    /**
+     * Joining by simply making middle the root needs no heights, so they
+     *  are all 0.
+     */
+    template <typename Node>
+    static int join_height(const Node *root);
+
+    template <typename Node>
+    static int child_join_height(const Node *node, int height,
+                                 typename Node::Direction dir);
+
+    template <typename Node>
+    static Node *join(Node *left, int left_height, Node *middle, Node *right,
+                      int right_height, int &height);
+};
+
+/**
+ * AVL Balance: keeps every node's balance factor between -1 and 1 by
+ *  updating it, and rotating, on the way back up from each change.
+ */
+struct AVLBalance
+{
+    template <typename Node, typename K, typename... Args>
+    static Node *insert(Node *root, K &&value, Args &&...args);
+
+    template <typename Node>
+    static void on_create(Node *node);
+
+    template <typename Node>
+    static void on_build(Node *node, bool bottom, int balance);
+
+    template <typename Node>
+    static Node *after_insert(Node *root, typename Node::Direction dir,
+                              bool &grew);
+
+    template <typename Node>
+    static Node *remove(Node *root, const typename Node::key_type &value);
+
+    template <typename Node>
+    static Node *after_remove(Node *root, typename Node::Direction dir,
+                              bool &shrank);
+
+    template <typename Node>
+    static void fix_root(Node *root);
+
+    /**
+     * Input: Node root - the root of an AVL Tree
+     * Returns: the height of the tree rooted at root, found by following the
+     *      balance factors down one path
+     */
+    template <typename Node>
+    static int height(const Node *root);
+
+    /**
+     * Joins measure trees by their height (see BSTNode::avl_join).
+     */
+    template <typename Node>
+    static int join_height(const Node *root);
+
+    template <typename Node>
+    static int child_join_height(const Node *node, int height,
+                                 typename Node::Direction dir);
+
+    template <typename Node>
+    static Node *join(Node *left, int left_height, Node *middle, Node *right,
+                      int right_height, int &height);
+};
+
+/**
+ * Red-Black Balance: new nodes are RED, red-red violations are eliminated on
+ *  the way back up from an insertion, and the root is always BLACK. Removal
+ *  uses BSTNode::rb_remove, which fixes black-height imbalances itself, so
+ *  this policy has no after_remove.
+ */
+struct RBBalance
+{
+    template <typename Node, typename K, typename... Args>
+    static Node *insert(Node *root, K &&value, Args &&...args);
+
+    template <typename Node>
+    static void on_create(Node *node);
+
+    template <typename Node>
+    static void on_build(Node *node, bool bottom, int balance);
+
+    template <typename Node>
+    static Node *after_insert(Node *root, typename Node::Direction dir,
+                              bool &grew);
+
+    template <typename Node>
+    static Node *remove(Node *root, const typename Node::key_type &value);
+
+    template <typename Node>
+    static void fix_root(Node *root);
+
+    template <typename Node>
+    static int height(const Node *root);
+
+    /**
+     * Joins measure trees by their black-height, counting a RED root as if
+     *  it were BLACK, as it will be once joined (see BSTNode::rb_join).
+     */
+    template <typename Node>
+    static int join_height(const Node *root);
+
+    template <typename Node>
+    static int child_join_height(const Node *node, int height,
+                                 typename Node::Direction dir);
+
+    template <typename Node>
+    static Node *join(Node *left, int left_height, Node *middle, Node *right,
+                      int right_height, int &height);
+};
+
+/**
+ * Top-Down Red-Black Balance: the same trees as RBBalance, but an insertion
+ *  splits 4-nodes on its way down (BSTNode::rb_insert_top_down) and finishes
+ *  in that one pass, instead of fixing red-red violations on the way back
+ *  up. Removal is the same as RBBalance's.
+ */
+struct RBTopDownBalance : RBBalance
+{
+    template <typename Node, typename K, typename... Args>
+    static Node *insert(Node *root, K &&value, Args &&...args);
+};
+
+#include "BalancePolicy.tpp"
@@ -0,0 +1,280 @@
+/*
+ * Filename: BalancePolicy.tpp
+ * Contains: Implementation of the balance policies of OrderedTree
+ */
+
+/***********************
+ * BEGIN NAIVE BALANCE *
+ ***********************/
+
+template <typename Node, typename K, typename... Args>
+Node *NaiveBalance::insert(Node *root, K &&value, Args &&...args)
+{
+    bool grew = false;
+    return root->template insert_with<NaiveBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+template <typename Node>
+void NaiveBalance::on_create(Node *)
+{
+}
+
+template <typename Node>
+void NaiveBalance::on_build(Node *, bool, int)
+{
+}
+
+template <typename Node>
+Node *NaiveBalance::after_insert(Node *root, typename Node::Direction,
+                                 bool &grew)
+{
+    grew = false;
+    return root;
+}
+
+template <typename Node>
+Node *NaiveBalance::remove(Node *root, const typename Node::key_type &value)
+{
+    bool shrank = false;
+    return root->template remove_with<NaiveBalance>(value, shrank);
+}
+
+template <typename Node>
+Node *NaiveBalance::after_remove(Node *root, typename Node::Direction,
+                                 bool &shrank)
+{
+    shrank = false;
+    return root;
+}
+
+template <typename Node>
+void NaiveBalance::fix_root(Node *)
+{
+}
+
+template <typename Node>
+int NaiveBalance::height(const Node *root)
+{
+    return root->node_height();
+}
+
+template <typename Node>
+int NaiveBalance::join_height(const Node *)
+{
+    return 0;
+}
+
+template <typename Node>
+int NaiveBalance::child_join_height(const Node *, int,
+                                    typename Node::Direction)
+{
+    return 0;
+}
+
+template <typename Node>
+Node *NaiveBalance::join(Node *left, int, Node *middle, Node *right, int,
+                         int &height)
+{
+    height = 0;
+    return Node::link(left, middle, right);
+}
+
+/*********************
+ * BEGIN AVL BALANCE *
+ *********************/
+
+template <typename Node, typename K, typename... Args>
+Node *AVLBalance::insert(Node *root, K &&value, Args &&...args)
+{
+    bool grew = false;
+    return root->template insert_with<AVLBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+/*
+ * A new node is a leaf, which is balanced; the zeroed metadata of a new node
+ *  already says so.
+ */
+template <typename Node>
+void AVLBalance::on_create(Node *)
+{
+}
+
+template <typename Node>
+void AVLBalance::on_build(Node *node, bool, int balance)
+{
+    node->set_balance(balance);
+}
+
+template <typename Node>
+Node *AVLBalance::after_insert(Node *root, typename Node::Direction dir,
+                               bool &grew)
+{
+    if (grew)
+    {
+        root = root->avl_regrow(dir, grew); //balance factor and rotations
+    }
+    return root;
+}
+
+template <typename Node>
+Node *AVLBalance::remove(Node *root, const typename Node::key_type &value)
+{
+    bool shrank = false;
+    return root->template remove_with<AVLBalance>(value, shrank);
+}
+
+template <typename Node>
+Node *AVLBalance::after_remove(Node *root, typename Node::Direction dir,
+                               bool &shrank)
+{
+    if (shrank)
+    {
+        root = root->avl_reshrink(dir, shrank); //balance factor and rotation
+    }
+    return root;
+}
+
+template <typename Node>
+void AVLBalance::fix_root(Node *)
+{
+}
+
+template <typename Node>
+int AVLBalance::height(const Node *root)
+{
+    return root->avl_height();
+}
+
+template <typename Node>
+int AVLBalance::join_height(const Node *root)
+{
+    return root->avl_height();
+}
+
+/*
+ * A child is one level shorter than its parent, or two if the balance
+ *  factor leans the other way.
+ */
+template <typename Node>
+int AVLBalance::child_join_height(const Node *node, int height,
+                                  typename Node::Direction dir)
+{
+    int balance = node->balance();
+    bool shorter = (dir == Node::LEFT) ? balance > 0 : balance < 0;
+    return height - (shorter ? 2 : 1);
+}
+
+template <typename Node>
+Node *AVLBalance::join(Node *left, int left_height, Node *middle,
+                       Node *right, int right_height, int &height)
+{
+    return Node::avl_join(left, left_height, middle, right, right_height,
+                          height);
+}
+
+/***************************
+ * BEGIN RED-BLACK BALANCE *
+ ***************************/
+
+template <typename Node, typename K, typename... Args>
+Node *RBBalance::insert(Node *root, K &&value, Args &&...args)
+{
+    bool grew = false;
+    return root->template insert_with<RBBalance>(
+        grew, std::forward<K>(value), std::forward<Args>(args)...);
+}
+
+template <typename Node>
+void RBBalance::on_create(Node *node)
+{
+    node->set_color(Node::RED);
+}
+
+/*
+ * The first levels of a built tree are complete, so every path down through
+ *  them crosses the same number of BLACK nodes; the nodes below them, on the
+ *  partial bottom level, are leaves, and making them RED keeps every path's
+ *  black-height the same.
+ */
+template <typename Node>
+void RBBalance::on_build(Node *node, bool bottom, int)
+{
+    if (bottom)
+    {
+        node->set_color(Node::RED);
+    }
+}
+
+/*
+ * A red-red violation can only be between the root of a subtree that changed
+ *  and one of its children, so once that root is BLACK there is nothing left
+ *  to fix above it.
+ */
+template <typename Node>
+Node *RBBalance::after_insert(Node *root, typename Node::Direction,
+                              bool &grew)
+{
+    root = root->rb_eliminate_red_red_violation();
+    grew = root->color() == Node::RED;
+    return root;
+}
+
+template <typename Node>
+Node *RBBalance::remove(Node *root, const typename Node::key_type &value)
+{
+    return root->rb_remove(value);
+}
+
+template <typename Node>
+void RBBalance::fix_root(Node *root)
+{
+    if (!root->is_empty())
+    {
+        root->set_color(Node::BLACK);
+    }
+}
+
+template <typename Node>
+int RBBalance::height(const Node *root)
+{
+    return root->node_height();
+}
+
+template <typename Node>
+int RBBalance::join_height(const Node *root)
+{
+    return root->rb_black_height() + (root->color() == Node::RED ? 1 : 0);
+}
+
+/*
+ * Below a BLACK node, a path crosses one BLACK node fewer; below a RED one,
+ *  as many, but the RED node was counted as if it were BLACK. Either way a
+ *  child is one lower, unless it is itself RED and so counted as BLACK.
+ */
+template <typename Node>
+int RBBalance::child_join_height(const Node *node, int height,
+                                 typename Node::Direction dir)
+{
+    return height - 1 + (node->child(dir)->color() == Node::RED ? 1 : 0);
+}
+
+template <typename Node>
+Node *RBBalance::join(Node *left, int left_height, Node *middle, Node *right,
+                      int right_height, int &height)
+{
+    return Node::rb_join(left, left_height, middle, right, right_height,
+                         height);
+}
+
+/************************************
+ * BEGIN TOP-DOWN RED-BLACK BALANCE *
+ ************************************/
+
+template <typename Node, typename K, typename... Args>
+Node *RBTopDownBalance::insert(Node *root, K &&value, Args &&...args)
+{
+    return root->rb_insert_top_down(std::forward<K>(value),
+                                    std::forward<Args>(args)...);
+}
@@ -0,0 +1,177 @@
+/*
+ * Filename: CombiningTree.h
+ * Contains: Interface of Combining Trees, which let one thread at a time
+ *      apply the updates of every thread waiting on a tree
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/**
+ * A lock around a Tree (a BSTree, AVLTree or RBTree) that is handed over by
+ *  flat combining (Hendler, Incze, Shavit and Tzafrir, SPAA 2010) rather
+ *  than by each thread in turn:
+ *    - a thread that wants to search or update the tree writes its request
+ *      into a slot of its own, then tries to take the lock
+ *    - whichever thread gets the lock becomes the combiner. It collects the
+ *      requests waiting in every slot, sorts them into key order, applies
+ *      them in one pass over the tree, and writes each count back into its
+ *      slot, before letting the lock go
+ *    - the other threads wait on their own slots, not on the lock, and
+ *      return as soon as their answers are in
+ *
+ * So the lock changes hands once per batch rather than once per update, and
+ *  the descents of a batch go down the tree in order, through nodes the one
+ *  before has just brought into the cache.
+ *
+ * Threads may call any member at once. New keys get a default payload,
+ *  since a payload could not be built from arguments in another thread's
+ *  call.
+ */
+template <typename Tree>
+class CombiningTree
+{
+private:
+    typedef typename Tree::key_type Key;
+    typedef typename Tree::key_compare Compare;
+
+    /**
+     * The states of a slot: FREE for anyone to claim; CLAIMED while its
+     *  thread writes a request into it; PENDING until a combiner applies
+     *  the request; DONE until its thread reads the answer and frees it.
+     */
+    static constexpr int FREE = 0;
+    static constexpr int CLAIMED = 1;
+    static constexpr int PENDING = 2;
+    static constexpr int DONE = 3;
+
+    /**
+     * The requests a slot may hold.
+     */
+    static constexpr int INSERT = 0;
+    static constexpr int REMOVE = 1;
+    static constexpr int COUNT = 2;
+
+    /**
+     * How many times a combiner looks over the slots again for requests
+     *  that came in while it was applying the last batch.
+     */
+    static constexpr int COMBINE_PASSES = 3;
+
+    /**
+     * One thread's request, on a cache line of its own so that threads
+     *  publishing requests do not write to the same line. The value is the
+     *  caller's own, which it keeps alive while it waits.
+     */
+    struct alignas(64) Slot
+    {
+        std::atomic<int> state;
+        int request;
+        const Key *value;
+        unsigned int count;
+
+        Slot();
+    };
+
+    std::mutex lock;
+    Tree tree;
+    std::vector<Slot> slots;
+
+    /**
+     * The pending slots of the batch being applied, kept between batches
+     *  so that it is only allocated once. Used under lock.
+     */
+    std::vector<Slot *> batch;
+
+    /**
+     * Input: N/A
+     * Returns: a number of the calling thread's own, used to spread the
+     *      threads over the slots
+     */
+    static unsigned int thread_index();
+
+    /**
+     * Input: CombiningTree this - the tree
+     *        int request - INSERT, REMOVE or COUNT
+     *        Key value - the value to apply it to
+     * Returns: the count of value once the request is applied
+     * Does: publishes the request in a free slot and waits for it to be
+     *      combined, combining it if the lock comes free; if every slot is
+     *      taken, takes the lock and applies the request itself
+     */
+    unsigned int apply(int request, const Key &value);
+
+    /**
+     * Input: CombiningTree this - the tree
+     * Returns: N/A
+     * Does: applies every pending request in key order, and marks its slot
+     *      DONE, looking over the slots up to COMBINE_PASSES times
+     * Assumes: this->lock is held
+     */
+    void combine();
+
+public:
+    /**
+     * Input: unsigned int slot_count - the number of slots; threads beyond
+     *            it still work, but take the lock in turn
+     * Returns: an empty tree
+     */
+    explicit CombiningTree(unsigned int slot_count = 64);
+
+    CombiningTree(const CombiningTree &) = delete;
+    CombiningTree &operator=(const CombiningTree &) = delete;
+
+    /**
+     * Input: CombiningTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches for value in a combined batch
+     */
+    unsigned int count_of(const Key &value);
+
+    /**
+     * Input: CombiningTree this - the tree
+     *        Key value - value to insert
+     * Returns: the count of value after the insert
+     * Does: Inserts value in a combined batch. Runtime: O(log n), plus the
+     *      wait for the batch
+     */
+    unsigned int insert(const Key &value);
+
+    /**
+     * Input: CombiningTree this - the tree
+     *        Key value - value to remove
+     * Returns: the count of value after the removal, which is 0 if it was
+     *      not in this
+     * Does: Removes one occurrence of value in a combined batch.
+     *      Runtime: O(log n), plus the wait for the batch
+     */
+    unsigned int remove(const Key &value);
+
+    /**
+     * Input: CombiningTree this - the tree
+     * Returns: The number of nodes in the tree
+     * Does: reads the tree under its lock
+     */
+    int node_count();
+
+    /**
+     * Input: CombiningTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Does: reads the tree under its lock
+     */
+    int count_total();
+
+    /**
+     * Input: CombiningTree this - the tree
+     * Returns: the height of the tree
+     * Does: reads the tree under its lock
+     */
+    int tree_height();
+};
+
+#include "CombiningTree.tpp"
@@ -0,0 +1,217 @@
+/*
+ * Filename: CombiningTree.tpp
+ * Contains: Implementation of Combining Trees
+ */
+
+#include <algorithm>
+#include <thread>
+
+/*
+ * A slot's request is written by its thread between CLAIMED and PENDING,
+ *  and its count by the combiner between PENDING and DONE. Each hand-over is
+ *  a release store read with acquire, so neither field needs to be atomic.
+ */
+
+template <typename Tree>
+CombiningTree<Tree>::Slot::Slot()
+    : state(FREE), request(COUNT), value(nullptr), count(0)
+{
+}
+
+/**************************************
+ * BEGIN PUBLIC COMBININGTREE SECTION *
+ **************************************/
+
+template <typename Tree>
+CombiningTree<Tree>::CombiningTree(unsigned int slot_count)
+    : lock(), tree(), slots(std::max(slot_count, 1u)), batch()
+{
+    this->batch.reserve(this->slots.size());
+}
+
+template <typename Tree>
+unsigned int CombiningTree<Tree>::count_of(const Key &value)
+{
+    return this->apply(COUNT, value);
+}
+
+template <typename Tree>
+unsigned int CombiningTree<Tree>::insert(const Key &value)
+{
+    return this->apply(INSERT, value);
+}
+
+template <typename Tree>
+unsigned int CombiningTree<Tree>::remove(const Key &value)
+{
+    return this->apply(REMOVE, value);
+}
+
+template <typename Tree>
+int CombiningTree<Tree>::node_count()
+{
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->tree.node_count();
+}
+
+template <typename Tree>
+int CombiningTree<Tree>::count_total()
+{
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->tree.count_total();
+}
+
+template <typename Tree>
+int CombiningTree<Tree>::tree_height()
+{
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->tree.tree_height();
+}
+
+/***************************************
+ * BEGIN PRIVATE COMBININGTREE SECTION *
+ ***************************************/
+
+/*
+ * Parameters: N/A
+ * Returns: the calling thread's number
+ * Purpose: threads are numbered in the order they first ask, so that the
+ *      first threads of a program each start at a slot of their own.
+ */
+template <typename Tree>
+unsigned int CombiningTree<Tree>::thread_index()
+{
+    static std::atomic<unsigned int> next(0);
+    thread_local unsigned int index =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+/*
+ * Parameters: CombiningTree this - the tree
+ *             int request - INSERT, REMOVE or COUNT
+ *             Key value - the value to apply it to
+ * Returns: the count of value afterwards
+ * Purpose: the thread claims the first free slot from its own onwards. Once
+ *      the request is pending, the thread only tries the lock, never waits
+ *      on it: whoever holds it will pick the request up, and if nobody
+ *      does, the thread gets the lock and combines the batch itself. It
+ *      yields between tries, since the combiner may need its core.
+ */
+template <typename Tree>
+unsigned int CombiningTree<Tree>::apply(int request, const Key &value)
+{
+    unsigned int size = this->slots.size();
+    unsigned int start = thread_index() % size;
+    Slot *slot = nullptr;
+    for (unsigned int i = 0; i < size && !slot; i++)
+    {
+        Slot &candidate = this->slots[(start + i) % size];
+        int state = FREE;
+        if (candidate.state.load(std::memory_order_relaxed) == FREE &&
+            candidate.state.compare_exchange_strong(
+                state, CLAIMED, std::memory_order_acquire))
+        {
+            slot = &candidate;
+        }
+    }
+
+    if (!slot)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        unsigned int count = this->tree.count_of(value);
+        if (request == INSERT)
+        {
+            this->tree.insert(value);
+            count++;
+        }
+        else if (request == REMOVE && count > 0)
+        {
+            this->tree.remove(value);
+            count--;
+        }
+        this->combine();
+        return count;
+    }
+
+    slot->request = request;
+    slot->value = &value;
+    slot->state.store(PENDING, std::memory_order_release);
+    while (slot->state.load(std::memory_order_acquire) != DONE)
+    {
+        if (this->lock.try_lock())
+        {
+            this->combine();
+            this->lock.unlock();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    unsigned int count = slot->count;
+    slot->state.store(FREE, std::memory_order_release);
+    return count;
+}
+
+/*
+ * Parameters: CombiningTree this - the tree
+ * Returns: N/A
+ * Purpose: equal keys sort next to each other, so a run of requests for
+ *      one key looks its count up once and then follows it along the run,
+ *      rather than searching again after each update. A remove of a key
+ *      that is not there is answered without touching the tree. Once a
+ *      slot is DONE its thread may return and its key go away, so the end
+ *      of a run is found by looking ahead to the next slot, before this
+ *      one is marked.
+ */
+template <typename Tree>
+void CombiningTree<Tree>::combine()
+{
+    Compare less;
+    for (int pass = 0; pass < COMBINE_PASSES; pass++)
+    {
+        this->batch.clear();
+        for (Slot &slot : this->slots)
+        {
+            if (slot.state.load(std::memory_order_acquire) == PENDING)
+            {
+                this->batch.push_back(&slot);
+            }
+        }
+        if (this->batch.empty())
+        {
+            return;
+        }
+        std::sort(this->batch.begin(), this->batch.end(),
+                  [&less](const Slot *a, const Slot *b) {
+                      return less(*a->value, *b->value);
+                  });
+
+        unsigned int count = 0;
+        bool run_starts = true;
+        for (std::size_t i = 0; i < this->batch.size(); i++)
+        {
+            Slot *slot = this->batch[i];
+            const Key &value = *slot->value;
+            if (run_starts)
+            {
+                count = this->tree.count_of(value);
+            }
+            run_starts = i + 1 == this->batch.size() ||
+                         less(value, *this->batch[i + 1]->value);
+            if (slot->request == INSERT)
+            {
+                this->tree.insert(value);
+                count++;
+            }
+            else if (slot->request == REMOVE && count > 0)
+            {
+                this->tree.remove(value);
+                count--;
+            }
+            slot->count = count;
+            slot->state.store(DONE, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,371 @@
+/*
+ * Filename: ConcurrentAVLTree.h
+ * Contains: Interface of Concurrent AVL Trees, balanced trees that any
+ *      number of threads read and update at once
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "EpochReclaimer.h"
+
+/**
+ * A balanced tree with the keys and counts of AVLTree that any number of
+ *  threads may search and update at once. It follows Bronson, Casper, Chafi
+ *  and Olukotun, "A Practical Concurrent Binary Search Tree" (PPoPP 2010):
+ *    - every node has a lock and a version. An update locks only the nodes
+ *      it changes, so updates to keys in different parts of the tree do not
+ *      wait for each other
+ *    - searches take no locks. They descend hand over hand, checking that
+ *      each node they came through has kept its version, and go back up
+ *      only as far as the last node that has
+ *    - a rotation marks the node it moves down as shrinking while it works,
+ *      since that is the only change that can hide a key from a search
+ *      below the node; searches wait for it to finish
+ *    - removing the last occurrence of a key whose node has two children
+ *      only sets its count to 0. The routing node left behind is unlinked
+ *      once it has fewer children
+ *    - balance is relaxed: after each update, heights are fixed and
+ *      rotations made on the way back up, locking a parent, a node and one
+ *      or two of its children at a time, so the tree is an AVL tree again
+ *      once the updates stop
+ *
+ * Unlinked nodes are retired to the shared EpochReclaimer, and every search
+ *  and update runs in one of its Guards, so no node is freed while a thread
+ *  may still be looking at it. There are no payloads: a node stays in place
+ *  while its key comes and goes, and a payload could not be replaced under
+ *  the threads reading it.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class ConcurrentAVLTree
+{
+private:
+    struct Node;
+
+    /**
+     * The part of a node that links it into the tree. The tree's root
+     *  holder is a bare Link, with no key, whose right child is the root,
+     *  so that the root has a parent to lock like any other node.
+     */
+    struct Link
+    {
+        /**
+         * The number of times the node's key is in the tree; 0 for a
+         *  routing node.
+         */
+        std::atomic<int> count;
+
+        /**
+         * The height of the subtree rooted here, counting a leaf as 1, as
+         *  last fixed; it may be stale while updates are under way.
+         */
+        std::atomic<int> height;
+
+        /**
+         * Bumped each time a rotation moves this node down; see UNLINKED
+         *  and SHRINKING.
+         */
+        std::atomic<std::uint64_t> version;
+
+        std::atomic<Link *> parent;
+        std::atomic<Node *> left;
+        std::atomic<Node *> right;
+
+        /**
+         * Held while any of the fields above are changed, except that a
+         *  node's parent is set by whoever holds the lock of that parent.
+         */
+        std::mutex lock;
+
+        Link(int count, int height, Link *parent);
+
+        /**
+         * Input: int dir - negative for the left child, positive for the
+         *            right
+         * Returns: the child on that side, or nullptr
+         */
+        Node *child(int dir) const;
+
+        /**
+         * Input: int dir - negative for the left child, positive for the
+         *            right
+         *        Node node - the new child, or nullptr
+         * Returns: N/A
+         * Assumes: this->lock is held
+         */
+        void set_child(int dir, Node *node);
+    };
+
+    struct Node : Link
+    {
+        const Key data;
+
+        Node(const Key &data, Link *parent);
+    };
+
+    /**
+     * The bits of a version: a node that has been unlinked keeps the
+     *  version UNLINKED for good, and a node being rotated down has
+     *  SHRINKING set until the rotation ends and the version moves on by
+     *  CHANGE.
+     */
+    static constexpr std::uint64_t UNLINKED = 1;
+    static constexpr std::uint64_t SHRINKING = 2;
+    static constexpr std::uint64_t CHANGE = 4;
+
+    /**
+     * Returned by the attempts below when what they read changed under them
+     *  and the caller must try again from a node it can still trust.
+     */
+    static constexpr int RETRY = -1;
+
+    /**
+     * What node_condition finds a node needs, besides a new height.
+     */
+    static constexpr int UNLINK_REQUIRED = -1;
+    static constexpr int REBALANCE_REQUIRED = -2;
+    static constexpr int NOTHING_REQUIRED = -3;
+
+    /**
+     * How many times a search re-reads the version of a shrinking node
+     *  before it waits on the node's lock instead.
+     */
+    static constexpr int SPIN_COUNT = 100;
+
+    Link holder;
+
+    /**
+     * Input: Key a, b - two keys
+     * Returns: negative, 0 or positive as a is ordered before, with or after
+     *      b
+     */
+    static int compare(const Key &a, const Key &b);
+
+    /**
+     * Input: Link node - a node, or nullptr
+     * Returns: the height recorded at node; 0 for nullptr
+     */
+    static int height_of(const Link *node);
+
+    /**
+     * Input: Link node - a node whose version was seen shrinking
+     * Returns: N/A
+     * Does: waits until the rotation under way at node is over
+     */
+    static void wait_until_not_changing(Link *node);
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to search for
+     *        Node node - the node the search has reached
+     *        int dir - the side of node value lies on
+     *        uint64_t version - the version node had when it was reached
+     * Returns: the count of value, or RETRY if node changed meanwhile
+     */
+    int attempt_get(const Key &value, Node *node, int dir,
+                    std::uint64_t version) const;
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to insert or remove
+     *        int delta - 1 to insert it, -1 to remove it
+     * Returns: the count value had before
+     * Does: runs attempt_update from the root until it succeeds
+     */
+    int update(const Key &value, int delta);
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to insert or remove
+     *        int delta - 1 to insert it, -1 to remove it
+     *        Link parent - the node node was reached from
+     *        Node node - the node the update has reached
+     *        uint64_t version - the version node had when it was reached
+     * Returns: the count value had before, or RETRY if node changed
+     *      meanwhile
+     */
+    int attempt_update(const Key &value, int delta, Link *parent, Node *node,
+                       std::uint64_t version);
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        int delta - 1 to insert node's key, -1 to remove it
+     *        Link parent - the node node was reached from
+     *        Node node - the node holding the key
+     * Returns: the count node had before, or RETRY if node was moved or
+     *      unlinked meanwhile
+     */
+    int attempt_node_update(int delta, Link *parent, Node *node);
+
+    /**
+     * Input: Link parent, Node node - a node with at most one child and its
+     *            parent, both locked
+     * Returns: false if node no longer qualifies
+     * Does: splices node out of the tree and retires it
+     */
+    static bool attempt_unlink(Link *parent, Node *node);
+
+    /**
+     * Input: Link node - a node
+     * Returns: UNLINK_REQUIRED, REBALANCE_REQUIRED or NOTHING_REQUIRED, or
+     *      else the height node should have
+     */
+    static int node_condition(Link *node);
+
+    /**
+     * Input: Link node - a node an update may have left damaged, or
+     *            nullptr
+     * Returns: N/A
+     * Does: fixes heights, unlinks routing nodes and rotates, up the tree
+     *      from node, until it reaches a node that needs nothing
+     */
+    static void fix_height_and_rebalance(Link *node);
+
+    /**
+     * Input: Link node - a locked node
+     * Returns: the next node that may be damaged: node itself if it needs
+     *      more than a height, its parent if its height was fixed, or
+     *      nullptr
+     */
+    static Link *fix_height(Link *node);
+
+    /**
+     * Input: Link parent, Node node - a node and its parent, both locked
+     * Returns: the next node that may be damaged, as fix_height
+     * Does: unlinks node if it is a routing node with at most one child,
+     *      else rotates it if it is unbalanced, else fixes its height
+     */
+    static Link *rebalance(Link *parent, Node *node);
+
+    /**
+     * Input: Link parent, Node node - a node and its parent, both locked
+     *        Node left (or right) - the taller child of node
+     *        int right_height (or left_height) - the height of the other
+     * Returns: the next node that may be damaged, as fix_height
+     * Does: locks child, and its inner child if a double rotation is
+     *      needed, and rotates node towards its shorter side
+     */
+    static Link *rebalance_to_right(Link *parent, Node *node, Node *left,
+                                    int right_height);
+    static Link *rebalance_to_left(Link *parent, Node *node, Node *right,
+                                   int left_height);
+
+    /**
+     * Input: the nodes and heights rebalance_to_right or rebalance_to_left
+     *            read under their locks
+     * Returns: the next node that may be damaged, as fix_height
+     * Does: rotates node down below its child (or below its inner
+     *      grandchild), marking node, and the child for a double rotation,
+     *      as shrinking while the links change
+     */
+    static Link *rotate_right(Link *parent, Node *node, Node *left,
+                              int right_height, int left_left_height,
+                              Node *left_right, int left_right_height);
+    static Link *rotate_left(Link *parent, Node *node, int left_height,
+                             Node *right, Node *right_left,
+                             int right_left_height, int right_right_height);
+    static Link *rotate_right_over_left(Link *parent, Node *node, Node *left,
+                                        int right_height,
+                                        int left_left_height,
+                                        Node *left_right,
+                                        int left_right_left_height);
+    static Link *rotate_left_over_right(Link *parent, Node *node,
+                                        int left_height, Node *right,
+                                        Node *right_left,
+                                        int right_right_height,
+                                        int right_left_right_height);
+
+    /**
+     * Input: void *node - an unlinked Node
+     * Returns: N/A
+     * Does: frees node
+     */
+    static void reclaim(void *node);
+
+    /**
+     * Input: Node node - the root of a subtree, or nullptr
+     * Returns: N/A
+     * Does: frees every node of the subtree
+     */
+    static void destroy(Node *node);
+
+    /**
+     * Input: Node node - the root of a subtree, or nullptr
+     * Returns: the number of keys in the subtree, the total of their
+     *      counts, or its height counting a leaf as 0
+     */
+    static int node_count(const Node *node);
+    static int count_total(const Node *node);
+    static int tree_height(const Node *node);
+
+public:
+    /**
+     * Default constructor. Creates an empty tree.
+     */
+    ConcurrentAVLTree();
+
+    /**
+     * Destructor. Frees the nodes still in the tree.
+     * Assumes: no thread is reading or updating this
+     */
+    ~ConcurrentAVLTree();
+
+    ConcurrentAVLTree(const ConcurrentAVLTree &) = delete;
+    ConcurrentAVLTree &operator=(const ConcurrentAVLTree &) = delete;
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches the tree without taking a lock
+     */
+    unsigned int count_of(const Key &value) const;
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to insert
+     * Returns: N/A
+     * Does: Inserts value, or counts it once more, locking only the node it
+     *      changes and then the nodes it rebalances. Runtime: O(log n)
+     */
+    void insert(const Key &value);
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     *        Key value - value to remove
+     * Returns: N/A
+     * Does: Removes one occurrence of value, if there is one, locking only
+     *      its node, and its parent if the node is unlinked, and then the
+     *      nodes it rebalances. Runtime: O(log n)
+     */
+    void remove(const Key &value);
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     * Returns: The number of keys in this tree, not counting routing nodes
+     * Assumes: no thread is updating this
+     */
+    int node_count() const;
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Assumes: no thread is updating this
+     */
+    int count_total() const;
+
+    /**
+     * Input: ConcurrentAVLTree this - the tree
+     * Returns: the height of this, routing nodes included. (An empty tree
+     *      has height -1.)
+     * Assumes: no thread is updating this
+     */
+    int tree_height() const;
+};
+
+#include "ConcurrentAVLTree.tpp"
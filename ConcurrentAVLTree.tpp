@@ -0,0 +1,1041 @@
+/*
+ * Filename: ConcurrentAVLTree.tpp
+ * Contains: Implementation of Concurrent AVL Trees
+ */
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Links are read with acquire and written with release, under the lock of
+ *  the node they belong to. A rotation sets SHRINKING before it changes any
+ *  link, so a search that reads a link the rotation wrote is bound to see
+ *  the new version when it checks the node again, and goes back.
+ */
+
+template <typename Key, typename Compare>
+ConcurrentAVLTree<Key, Compare>::Link::Link(int count, int height,
+                                            Link *parent)
+    : count(count), height(height), version(0), parent(parent),
+      left(nullptr), right(nullptr), lock()
+{
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Node *
+ConcurrentAVLTree<Key, Compare>::Link::child(int dir) const
+{
+    return (dir < 0 ? this->left : this->right)
+        .load(std::memory_order_acquire);
+}
+
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::Link::set_child(int dir, Node *node)
+{
+    (dir < 0 ? this->left : this->right)
+        .store(node, std::memory_order_release);
+}
+
+template <typename Key, typename Compare>
+ConcurrentAVLTree<Key, Compare>::Node::Node(const Key &data, Link *parent)
+    : Link(1, 1, parent), data(data)
+{
+}
+
+/******************************************
+ * BEGIN PUBLIC CONCURRENTAVLTREE SECTION *
+ ******************************************/
+
+template <typename Key, typename Compare>
+ConcurrentAVLTree<Key, Compare>::ConcurrentAVLTree() : holder(0, 0, nullptr)
+{
+}
+
+template <typename Key, typename Compare>
+ConcurrentAVLTree<Key, Compare>::~ConcurrentAVLTree()
+{
+    destroy(this->holder.right.load(std::memory_order_relaxed));
+}
+
+/*
+ * Parameters: ConcurrentAVLTree this - the tree
+ *             Key value - value to search for
+ * Returns: the count of value
+ * Purpose: the root is checked like any other node: if a rotation is moving
+ *      it down, the search waits, and if it has been replaced, the search
+ *      starts over from the new one.
+ */
+template <typename Key, typename Compare>
+unsigned int ConcurrentAVLTree<Key, Compare>::count_of(const Key &value) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    while (true)
+    {
+        Node *root = this->holder.right.load(std::memory_order_acquire);
+        if (!root)
+        {
+            return 0;
+        }
+        int dir = compare(value, root->data);
+        if (dir == 0)
+        {
+            return root->count.load(std::memory_order_acquire);
+        }
+        std::uint64_t version = root->version.load(std::memory_order_acquire);
+        if (version & (SHRINKING | UNLINKED))
+        {
+            wait_until_not_changing(root);
+        }
+        else if (root == this->holder.right.load(std::memory_order_acquire))
+        {
+            int count = this->attempt_get(value, root, dir, version);
+            if (count != RETRY)
+            {
+                return count;
+            }
+        }
+    }
+}
+
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::insert(const Key &value)
+{
+    this->update(value, 1);
+}
+
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::remove(const Key &value)
+{
+    this->update(value, -1);
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::node_count() const
+{
+    return node_count(this->holder.right.load(std::memory_order_acquire));
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::count_total() const
+{
+    return count_total(this->holder.right.load(std::memory_order_acquire));
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::tree_height() const
+{
+    return tree_height(this->holder.right.load(std::memory_order_acquire));
+}
+
+/*******************************************
+ * BEGIN PRIVATE CONCURRENTAVLTREE SECTION *
+ *******************************************/
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::compare(const Key &a, const Key &b)
+{
+    Compare less;
+    if (less(a, b))
+    {
+        return -1;
+    }
+    return less(b, a) ? 1 : 0;
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::height_of(const Link *node)
+{
+    return node ? node->height.load(std::memory_order_seq_cst) : 0;
+}
+
+/*
+ * Parameters: Link node - the node
+ * Returns: N/A
+ * Purpose: rotations are short, so the search spins for a while first; if
+ *      the version still has not moved on, the node's lock, which the
+ *      rotation holds, is taken and dropped to wait for it.
+ */
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::wait_until_not_changing(Link *node)
+{
+    std::uint64_t version = node->version.load(std::memory_order_acquire);
+    if (!(version & SHRINKING))
+    {
+        return;
+    }
+    for (int spin = 0; spin < SPIN_COUNT; spin++)
+    {
+        if (node->version.load(std::memory_order_acquire) != version)
+        {
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> wait(node->lock);
+}
+
+/*
+ * Parameters: ConcurrentAVLTree this - the tree
+ *             Key value - value to search for
+ *             Node node - the node the search has reached
+ *             int dir - the side of node value lies on
+ *             uint64_t version - node's version when it was reached
+ * Returns: the count of value, or RETRY
+ * Purpose: a child is only trusted once node is seen to have kept its
+ *      version after the child was read, which shows the child was still
+ *      the root of the subtree value lies in. If the search below the child
+ *      fails, the child is read again before node is given up on.
+ */
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::attempt_get(const Key &value, Node *node,
+                                                 int dir,
+                                                 std::uint64_t version) const
+{
+    while (true)
+    {
+        Node *child = node->child(dir);
+        if (!child)
+        {
+            if (node->version.load(std::memory_order_acquire) != version)
+            {
+                return RETRY;
+            }
+            return 0;
+        }
+        int child_dir = compare(value, child->data);
+        if (child_dir == 0)
+        {
+            return child->count.load(std::memory_order_acquire);
+        }
+        std::uint64_t child_version =
+            child->version.load(std::memory_order_acquire);
+        if (child_version & (SHRINKING | UNLINKED))
+        {
+            wait_until_not_changing(child);
+            if (node->version.load(std::memory_order_acquire) != version)
+            {
+                return RETRY;
+            }
+        }
+        else if (child != node->child(dir))
+        {
+            if (node->version.load(std::memory_order_acquire) != version)
+            {
+                return RETRY;
+            }
+        }
+        else
+        {
+            if (node->version.load(std::memory_order_acquire) != version)
+            {
+                return RETRY;
+            }
+            int count =
+                this->attempt_get(value, child, child_dir, child_version);
+            if (count != RETRY)
+            {
+                return count;
+            }
+        }
+    }
+}
+
+/*
+ * Parameters: ConcurrentAVLTree this - the tree
+ *             Key value - value to insert or remove
+ *             int delta - 1 or -1
+ * Returns: the count value had before
+ * Purpose: an empty tree gets its root under the holder's lock. The whole
+ *      update, rebalancing included, runs in one Guard, since it may come
+ *      back to nodes that were unlinked while it ran.
+ */
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::update(const Key &value, int delta)
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    while (true)
+    {
+        Node *root = this->holder.right.load(std::memory_order_acquire);
+        if (!root)
+        {
+            if (delta < 0)
+            {
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(this->holder.lock);
+            if (!this->holder.right.load(std::memory_order_relaxed))
+            {
+                this->holder.set_child(1, new Node(value, &this->holder));
+                return 0;
+            }
+        }
+        else
+        {
+            std::uint64_t version =
+                root->version.load(std::memory_order_acquire);
+            if (version & (SHRINKING | UNLINKED))
+            {
+                wait_until_not_changing(root);
+            }
+            else if (root ==
+                     this->holder.right.load(std::memory_order_acquire))
+            {
+                int count = this->attempt_update(value, delta, &this->holder,
+                                                 root, version);
+                if (count != RETRY)
+                {
+                    return count;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Parameters: ConcurrentAVLTree this - the tree
+ *             Key value - value to insert or remove
+ *             int delta - 1 or -1
+ *             Link parent - the node node was reached from
+ *             Node node - the node the update has reached
+ *             uint64_t version - node's version when it was reached
+ * Returns: the count value had before, or RETRY
+ * Purpose: descends as attempt_get does. A new leaf is linked in under the
+ *      lock of its parent alone, once the parent is seen to have kept its
+ *      version and to still have no child there.
+ */
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::attempt_update(const Key &value,
+                                                    int delta, Link *parent,
+                                                    Node *node,
+                                                    std::uint64_t version)
+{
+    int dir = compare(value, node->data);
+    if (dir == 0)
+    {
+        return this->attempt_node_update(delta, parent, node);
+    }
+    while (true)
+    {
+        Node *child = node->child(dir);
+        if (node->version.load(std::memory_order_acquire) != version)
+        {
+            return RETRY;
+        }
+        if (!child)
+        {
+            if (delta < 0)
+            {
+                return 0;
+            }
+            Link *damaged;
+            {
+                std::lock_guard<std::mutex> lock(node->lock);
+                if (node->version.load(std::memory_order_relaxed) != version)
+                {
+                    return RETRY;
+                }
+                if (node->child(dir))
+                {
+                    continue;
+                }
+                node->set_child(dir, new Node(value, node));
+                damaged = fix_height(node);
+            }
+            fix_height_and_rebalance(damaged);
+            return 0;
+        }
+        std::uint64_t child_version =
+            child->version.load(std::memory_order_acquire);
+        if (child_version & (SHRINKING | UNLINKED))
+        {
+            wait_until_not_changing(child);
+        }
+        else if (child == node->child(dir))
+        {
+            if (node->version.load(std::memory_order_acquire) != version)
+            {
+                return RETRY;
+            }
+            int count = this->attempt_update(value, delta, node, child,
+                                             child_version);
+            if (count != RETRY)
+            {
+                return count;
+            }
+        }
+    }
+}
+
+/*
+ * Parameters: ConcurrentAVLTree this - the tree
+ *             int delta - 1 or -1
+ *             Link parent - the node node was reached from
+ *             Node node - the node holding the key
+ * Returns: the count node had before, or RETRY
+ * Purpose: most updates only change the count, under node's lock. Removing
+ *      the last occurrence from a node with at most one child unlinks it
+ *      instead, which takes its parent's lock first, so locks are always
+ *      taken from the top down; a node with two children is left as a
+ *      routing node.
+ */
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::attempt_node_update(int delta,
+                                                         Link *parent,
+                                                         Node *node)
+{
+    if (delta < 0)
+    {
+        int count = node->count.load(std::memory_order_acquire);
+        if (count == 0)
+        {
+            return 0;
+        }
+        if (count == 1 && (!node->left.load(std::memory_order_acquire) ||
+                           !node->right.load(std::memory_order_acquire)))
+        {
+            Link *damaged;
+            {
+                std::lock_guard<std::mutex> parent_lock(parent->lock);
+                if ((parent->version.load(std::memory_order_relaxed) &
+                     UNLINKED) ||
+                    node->parent.load(std::memory_order_relaxed) != parent)
+                {
+                    return RETRY;
+                }
+                {
+                    std::lock_guard<std::mutex> node_lock(node->lock);
+                    count = node->count.load(std::memory_order_relaxed);
+                    if (count != 1)
+                    {
+                        if (count > 1)
+                        {
+                            node->count.store(count - 1,
+                                              std::memory_order_release);
+                        }
+                        return count;
+                    }
+                    if (!attempt_unlink(parent, node))
+                    {
+                        return RETRY;
+                    }
+                }
+                damaged = fix_height(parent);
+            }
+            fix_height_and_rebalance(damaged);
+            return 1;
+        }
+    }
+    std::lock_guard<std::mutex> lock(node->lock);
+    if (node->version.load(std::memory_order_relaxed) & UNLINKED)
+    {
+        return RETRY;
+    }
+    int count = node->count.load(std::memory_order_relaxed);
+    if (delta < 0)
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+        if (count == 1 && (!node->left.load(std::memory_order_relaxed) ||
+                           !node->right.load(std::memory_order_relaxed)))
+        {
+            return RETRY;
+        }
+    }
+    node->count.store(count + delta, std::memory_order_release);
+    return count;
+}
+
+/*
+ * Parameters: Link parent - node's parent, locked
+ *             Node node - the node to unlink, locked
+ * Returns: false if node is no longer parent's child or has two children
+ * Purpose: node's one child, if any, takes its place. node keeps its own
+ *      links, so a search that is still on it can carry on down, but its
+ *      version tells every other thread it is gone. It is retired while
+ *      still locked, which is safe since this thread's Guard keeps it from
+ *      being freed.
+ */
+template <typename Key, typename Compare>
+bool ConcurrentAVLTree<Key, Compare>::attempt_unlink(Link *parent, Node *node)
+{
+    Node *parent_left = parent->left.load(std::memory_order_relaxed);
+    Node *parent_right = parent->right.load(std::memory_order_relaxed);
+    if (parent_left != node && parent_right != node)
+    {
+        return false;
+    }
+    Node *left = node->left.load(std::memory_order_relaxed);
+    Node *right = node->right.load(std::memory_order_relaxed);
+    if (left && right)
+    {
+        return false;
+    }
+    Node *splice = left ? left : right;
+    parent->set_child(parent_left == node ? -1 : 1, splice);
+    if (splice)
+    {
+        splice->parent.store(parent, std::memory_order_seq_cst);
+    }
+    node->version.store(UNLINKED, std::memory_order_release);
+    node->count.store(0, std::memory_order_release);
+    EpochReclaimer::shared().retire(node, &ConcurrentAVLTree::reclaim);
+    return true;
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::node_condition(Link *node)
+{
+    Node *left = node->left.load(std::memory_order_acquire);
+    Node *right = node->right.load(std::memory_order_acquire);
+    if ((!left || !right) && node->count.load(std::memory_order_acquire) == 0)
+    {
+        return UNLINK_REQUIRED;
+    }
+    int height = node->height.load(std::memory_order_seq_cst);
+    int left_height = height_of(left);
+    int right_height = height_of(right);
+    int balance = left_height - right_height;
+    if (balance < -1 || balance > 1)
+    {
+        return REBALANCE_REQUIRED;
+    }
+    int repaired = 1 + std::max(left_height, right_height);
+    return height != repaired ? repaired : NOTHING_REQUIRED;
+}
+
+/*
+ * Parameters: Link node - the node to start from
+ * Returns: N/A
+ * Purpose: a height alone is fixed under the node's lock. Anything more
+ *      takes the parent's lock too, after which the parent is checked to
+ *      still be the node's parent. The loop stops at the holder, which has
+ *      no parent, and at a node that has been unlinked, whose unlinker
+ *      repairs its old parent.
+ *
+ *      A node that seems to need nothing is still locked to make sure: a
+ *      rotation may be under way at it that read the height of a child
+ *      before this thread changed it, and will write a height for the node
+ *      made from the stale one once it is done.
+ *
+ *      A step that rebalances a node goes on from the lowest node it leaves
+ *      damaged, which need not lead back up through the node and its parent
+ *      (a routing node it leaves behind may be unlinked without changing
+ *      any height, for one), so both are kept to be checked again once
+ *      the repairs below them are done.
+ */
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::fix_height_and_rebalance(Link *node)
+{
+    std::vector<Link *> pending;
+    while (true)
+    {
+        if (!node || !node->parent.load(std::memory_order_acquire) ||
+            (node->version.load(std::memory_order_acquire) & UNLINKED))
+        {
+            if (pending.empty())
+            {
+                return;
+            }
+            node = pending.back();
+            pending.pop_back();
+            continue;
+        }
+        int condition = node_condition(node);
+        if (condition != UNLINK_REQUIRED && condition != REBALANCE_REQUIRED)
+        {
+            std::lock_guard<std::mutex> lock(node->lock);
+            node = fix_height(node);
+        }
+        else
+        {
+            Link *parent = node->parent.load(std::memory_order_acquire);
+            std::lock_guard<std::mutex> parent_lock(parent->lock);
+            if (!(parent->version.load(std::memory_order_relaxed) &
+                  UNLINKED) &&
+                node->parent.load(std::memory_order_relaxed) == parent)
+            {
+                std::lock_guard<std::mutex> node_lock(node->lock);
+                Link *next = rebalance(parent, static_cast<Node *>(node));
+                if (next && (pending.empty() || pending.back() != node))
+                {
+                    pending.push_back(parent);
+                    pending.push_back(node);
+                }
+                node = next;
+            }
+        }
+    }
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::fix_height(Link *node)
+{
+    int condition = node_condition(node);
+    switch (condition)
+    {
+    case REBALANCE_REQUIRED:
+    case UNLINK_REQUIRED:
+        return node;
+    case NOTHING_REQUIRED:
+        return nullptr;
+    default:
+        node->height.store(condition, std::memory_order_seq_cst);
+        return node->parent.load(std::memory_order_seq_cst);
+    }
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rebalance(Link *parent, Node *node)
+{
+    Node *left = node->left.load(std::memory_order_relaxed);
+    Node *right = node->right.load(std::memory_order_relaxed);
+    if ((!left || !right) && node->count.load(std::memory_order_relaxed) == 0)
+    {
+        if (attempt_unlink(parent, node))
+        {
+            return fix_height(parent);
+        }
+        return node;
+    }
+    int height = node->height.load(std::memory_order_seq_cst);
+    int left_height = height_of(left);
+    int right_height = height_of(right);
+    int repaired = 1 + std::max(left_height, right_height);
+    int balance = left_height - right_height;
+    if (balance > 1)
+    {
+        return rebalance_to_right(parent, node, left, right_height);
+    }
+    if (balance < -1)
+    {
+        return rebalance_to_left(parent, node, right, left_height);
+    }
+    if (repaired != height)
+    {
+        node->height.store(repaired, std::memory_order_seq_cst);
+        return fix_height(parent);
+    }
+    return nullptr;
+}
+
+/*
+ * Parameters: Link parent, Node node - the node to rotate and its parent
+ *             Node left - node's left child
+ *             int right_height - the height of node's right child
+ * Returns: the next node that may be damaged
+ * Purpose: the heights read before left was locked may be stale, so they
+ *      are read again under its lock. A single rotation does if left leans
+ *      left, or not at all; otherwise its right child is locked as well for
+ *      a double rotation, unless that would leave left unbalanced, in which
+ *      case left itself is first rotated the other way, if it needs it, and
+ *      node is come back to later (see fix_height_and_rebalance).
+ */
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rebalance_to_right(Link *parent, Node *node,
+                                                    Node *left,
+                                                    int right_height)
+{
+    std::lock_guard<std::mutex> left_lock(left->lock);
+    int left_height = left->height.load(std::memory_order_seq_cst);
+    if (left_height - right_height <= 1)
+    {
+        return node;
+    }
+    Node *left_right = left->right.load(std::memory_order_relaxed);
+    int left_left_height =
+        height_of(left->left.load(std::memory_order_relaxed));
+    int left_right_height = height_of(left_right);
+    if (left_left_height >= left_right_height)
+    {
+        return rotate_right(parent, node, left, right_height,
+                            left_left_height, left_right, left_right_height);
+    }
+    {
+        std::lock_guard<std::mutex> left_right_lock(left_right->lock);
+        left_right_height = left_right->height.load(std::memory_order_seq_cst);
+        if (left_left_height >= left_right_height)
+        {
+            return rotate_right(parent, node, left, right_height,
+                                left_left_height, left_right,
+                                left_right_height);
+        }
+        int left_right_left_height =
+            height_of(left_right->left.load(std::memory_order_relaxed));
+        int balance = left_left_height - left_right_left_height;
+        if (balance >= -1 && balance <= 1)
+        {
+            return rotate_right_over_left(parent, node, left, right_height,
+                                          left_left_height, left_right,
+                                          left_right_left_height);
+        }
+    }
+    return rebalance_to_left(node, left, left_right, left_left_height);
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rebalance_to_left(Link *parent, Node *node,
+                                                   Node *right,
+                                                   int left_height)
+{
+    std::lock_guard<std::mutex> right_lock(right->lock);
+    int right_height = right->height.load(std::memory_order_seq_cst);
+    if (left_height - right_height >= -1)
+    {
+        return node;
+    }
+    Node *right_left = right->left.load(std::memory_order_relaxed);
+    int right_left_height = height_of(right_left);
+    int right_right_height =
+        height_of(right->right.load(std::memory_order_relaxed));
+    if (right_right_height >= right_left_height)
+    {
+        return rotate_left(parent, node, left_height, right, right_left,
+                           right_left_height, right_right_height);
+    }
+    {
+        std::lock_guard<std::mutex> right_left_lock(right_left->lock);
+        right_left_height = right_left->height.load(std::memory_order_seq_cst);
+        if (right_right_height >= right_left_height)
+        {
+            return rotate_left(parent, node, left_height, right, right_left,
+                               right_left_height, right_right_height);
+        }
+        int right_left_right_height =
+            height_of(right_left->right.load(std::memory_order_relaxed));
+        int balance = right_right_height - right_left_right_height;
+        if (balance >= -1 && balance <= 1)
+        {
+            return rotate_left_over_right(parent, node, left_height, right,
+                                          right_left, right_right_height,
+                                          right_left_right_height);
+        }
+    }
+    return rebalance_to_right(node, right, right_left, right_right_height);
+}
+
+/*
+ * Parameters: Link parent, Node node, Node left, Node left_right - the
+ *                 nodes the rotation moves, all but left_right locked
+ *             int right_height, left_left_height, left_right_height - the
+ *                 heights of the subtrees that do not change
+ * Returns: node if it is still unbalanced or is now a routing node that can
+ *      be unlinked, left if it is, or else parent, whose height may now be
+ *      wrong
+ * Purpose: node is the only node that moves down, so it alone is marked as
+ *      shrinking; left moves up, which can only make more keys reachable
+ *      from it.
+ *
+ *      left_right changes parents without being locked, and the height read
+ *      for it may have been changed since by a thread fixing heights, which
+ *      then goes on to what it takes to be left_right's parent. Parents and
+ *      heights are written and read in sequential consistency, so either
+ *      that thread sees that the parent is now node, or the height read
+ *      again here after the move is the new one.
+ */
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rotate_right(Link *parent, Node *node,
+                                              Node *left, int right_height,
+                                              int left_left_height,
+                                              Node *left_right,
+                                              int left_right_height)
+{
+    std::uint64_t version = node->version.load(std::memory_order_relaxed);
+    Node *parent_left = parent->left.load(std::memory_order_relaxed);
+    node->version.store(version | SHRINKING, std::memory_order_relaxed);
+
+    node->left.store(left_right, std::memory_order_release);
+    if (left_right)
+    {
+        left_right->parent.store(node, std::memory_order_seq_cst);
+    }
+    left->right.store(node, std::memory_order_release);
+    node->parent.store(left, std::memory_order_seq_cst);
+    parent->set_child(parent_left == node ? -1 : 1, left);
+    left->parent.store(parent, std::memory_order_seq_cst);
+
+    // left_right changed parents: see the comment above
+    left_right_height = height_of(left_right);
+    int node_height = 1 + std::max(left_right_height, right_height);
+    node->height.store(node_height, std::memory_order_seq_cst);
+    left->height.store(1 + std::max(left_left_height, node_height),
+                       std::memory_order_seq_cst);
+    node->version.store(version + CHANGE, std::memory_order_release);
+
+    int node_balance = left_right_height - right_height;
+    if (node_balance < -1 || node_balance > 1)
+    {
+        return node;
+    }
+    if ((!left_right || right_height == 0) &&
+        node->count.load(std::memory_order_relaxed) == 0)
+    {
+        return node;
+    }
+    int left_balance = left_left_height - node_height;
+    if (left_balance < -1 || left_balance > 1)
+    {
+        return left;
+    }
+    if (left_left_height == 0 &&
+        left->count.load(std::memory_order_relaxed) == 0)
+    {
+        return left;
+    }
+    return fix_height(parent);
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rotate_left(Link *parent, Node *node,
+                                             int left_height, Node *right,
+                                             Node *right_left,
+                                             int right_left_height,
+                                             int right_right_height)
+{
+    std::uint64_t version = node->version.load(std::memory_order_relaxed);
+    Node *parent_left = parent->left.load(std::memory_order_relaxed);
+    node->version.store(version | SHRINKING, std::memory_order_relaxed);
+
+    node->right.store(right_left, std::memory_order_release);
+    if (right_left)
+    {
+        right_left->parent.store(node, std::memory_order_seq_cst);
+    }
+    right->left.store(node, std::memory_order_release);
+    node->parent.store(right, std::memory_order_seq_cst);
+    parent->set_child(parent_left == node ? -1 : 1, right);
+    right->parent.store(parent, std::memory_order_seq_cst);
+
+    // right_left changed parents: see the comment on rotate_right
+    right_left_height = height_of(right_left);
+    int node_height = 1 + std::max(left_height, right_left_height);
+    node->height.store(node_height, std::memory_order_seq_cst);
+    right->height.store(1 + std::max(node_height, right_right_height),
+                        std::memory_order_seq_cst);
+    node->version.store(version + CHANGE, std::memory_order_release);
+
+    int node_balance = right_left_height - left_height;
+    if (node_balance < -1 || node_balance > 1)
+    {
+        return node;
+    }
+    if ((!right_left || left_height == 0) &&
+        node->count.load(std::memory_order_relaxed) == 0)
+    {
+        return node;
+    }
+    int right_balance = right_right_height - node_height;
+    if (right_balance < -1 || right_balance > 1)
+    {
+        return right;
+    }
+    if (right_right_height == 0 &&
+        right->count.load(std::memory_order_relaxed) == 0)
+    {
+        return right;
+    }
+    return fix_height(parent);
+}
+
+/*
+ * Parameters: Link parent, Node node, Node left, Node left_right - the
+ *                 nodes the rotation moves, all locked
+ *             int right_height, left_left_height, left_right_left_height -
+ *                 the heights of the subtrees the rotation keeps whole
+ * Returns: the next node that may be damaged, as rotate_right
+ * Purpose: left_right moves up above both node and left, which both move
+ *      down, so both are marked as shrinking. If left is a routing node, it
+ *      may be left with one child, and is returned to be unlinked.
+ */
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rotate_right_over_left(
+    Link *parent, Node *node, Node *left, int right_height,
+    int left_left_height, Node *left_right, int left_right_left_height)
+{
+    std::uint64_t version = node->version.load(std::memory_order_relaxed);
+    std::uint64_t left_version = left->version.load(std::memory_order_relaxed);
+    Node *parent_left = parent->left.load(std::memory_order_relaxed);
+    Node *left_right_left = left_right->left.load(std::memory_order_relaxed);
+    Node *left_right_right = left_right->right.load(std::memory_order_relaxed);
+    node->version.store(version | SHRINKING, std::memory_order_relaxed);
+    left->version.store(left_version | SHRINKING, std::memory_order_relaxed);
+
+    node->left.store(left_right_right, std::memory_order_release);
+    if (left_right_right)
+    {
+        left_right_right->parent.store(node, std::memory_order_seq_cst);
+    }
+    left->right.store(left_right_left, std::memory_order_release);
+    if (left_right_left)
+    {
+        left_right_left->parent.store(left, std::memory_order_seq_cst);
+    }
+    left_right->left.store(left, std::memory_order_release);
+    left->parent.store(left_right, std::memory_order_seq_cst);
+    left_right->right.store(node, std::memory_order_release);
+    node->parent.store(left_right, std::memory_order_seq_cst);
+    parent->set_child(parent_left == node ? -1 : 1, left_right);
+    left_right->parent.store(parent, std::memory_order_seq_cst);
+
+    // the children of left_right changed parents: see rotate_right
+    left_right_left_height = height_of(left_right_left);
+    int left_right_right_height = height_of(left_right_right);
+    int node_height = 1 + std::max(left_right_right_height, right_height);
+    node->height.store(node_height, std::memory_order_seq_cst);
+    int left_height = 1 + std::max(left_left_height, left_right_left_height);
+    left->height.store(left_height, std::memory_order_seq_cst);
+    left_right->height.store(1 + std::max(left_height, node_height),
+                             std::memory_order_seq_cst);
+    node->version.store(version + CHANGE, std::memory_order_release);
+    left->version.store(left_version + CHANGE, std::memory_order_release);
+
+    int node_balance = left_right_right_height - right_height;
+    if (node_balance < -1 || node_balance > 1)
+    {
+        return node;
+    }
+    if ((!left_right_right || right_height == 0) &&
+        node->count.load(std::memory_order_relaxed) == 0)
+    {
+        return node;
+    }
+    if ((left_left_height == 0 || !left_right_left) &&
+        left->count.load(std::memory_order_relaxed) == 0)
+    {
+        return left;
+    }
+    int left_right_balance = left_height - node_height;
+    if (left_right_balance < -1 || left_right_balance > 1)
+    {
+        return left_right;
+    }
+    return fix_height(parent);
+}
+
+template <typename Key, typename Compare>
+typename ConcurrentAVLTree<Key, Compare>::Link *
+ConcurrentAVLTree<Key, Compare>::rotate_left_over_right(
+    Link *parent, Node *node, int left_height, Node *right, Node *right_left,
+    int right_right_height, int right_left_right_height)
+{
+    std::uint64_t version = node->version.load(std::memory_order_relaxed);
+    std::uint64_t right_version =
+        right->version.load(std::memory_order_relaxed);
+    Node *parent_left = parent->left.load(std::memory_order_relaxed);
+    Node *right_left_left = right_left->left.load(std::memory_order_relaxed);
+    Node *right_left_right = right_left->right.load(std::memory_order_relaxed);
+    node->version.store(version | SHRINKING, std::memory_order_relaxed);
+    right->version.store(right_version | SHRINKING, std::memory_order_relaxed);
+
+    node->right.store(right_left_left, std::memory_order_release);
+    if (right_left_left)
+    {
+        right_left_left->parent.store(node, std::memory_order_seq_cst);
+    }
+    right->left.store(right_left_right, std::memory_order_release);
+    if (right_left_right)
+    {
+        right_left_right->parent.store(right, std::memory_order_seq_cst);
+    }
+    right_left->right.store(right, std::memory_order_release);
+    right->parent.store(right_left, std::memory_order_seq_cst);
+    right_left->left.store(node, std::memory_order_release);
+    node->parent.store(right_left, std::memory_order_seq_cst);
+    parent->set_child(parent_left == node ? -1 : 1, right_left);
+    right_left->parent.store(parent, std::memory_order_seq_cst);
+
+    // the children of right_left changed parents: see rotate_right
+    right_left_right_height = height_of(right_left_right);
+    int right_left_left_height = height_of(right_left_left);
+    int node_height = 1 + std::max(left_height, right_left_left_height);
+    node->height.store(node_height, std::memory_order_seq_cst);
+    int right_height =
+        1 + std::max(right_left_right_height, right_right_height);
+    right->height.store(right_height, std::memory_order_seq_cst);
+    right_left->height.store(1 + std::max(node_height, right_height),
+                             std::memory_order_seq_cst);
+    node->version.store(version + CHANGE, std::memory_order_release);
+    right->version.store(right_version + CHANGE, std::memory_order_release);
+
+    int node_balance = right_left_left_height - left_height;
+    if (node_balance < -1 || node_balance > 1)
+    {
+        return node;
+    }
+    if ((!right_left_left || left_height == 0) &&
+        node->count.load(std::memory_order_relaxed) == 0)
+    {
+        return node;
+    }
+    if ((right_right_height == 0 || !right_left_right) &&
+        right->count.load(std::memory_order_relaxed) == 0)
+    {
+        return right;
+    }
+    int right_left_balance = right_height - node_height;
+    if (right_left_balance < -1 || right_left_balance > 1)
+    {
+        return right_left;
+    }
+    return fix_height(parent);
+}
+
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::reclaim(void *node)
+{
+    delete static_cast<Node *>(node);
+}
+
+template <typename Key, typename Compare>
+void ConcurrentAVLTree<Key, Compare>::destroy(Node *node)
+{
+    if (node)
+    {
+        destroy(node->left.load(std::memory_order_relaxed));
+        destroy(node->right.load(std::memory_order_relaxed));
+        delete node;
+    }
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::node_count(const Node *node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    return (node->count.load(std::memory_order_acquire) > 0) +
+           node_count(node->left.load(std::memory_order_acquire)) +
+           node_count(node->right.load(std::memory_order_acquire));
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::count_total(const Node *node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    return node->count.load(std::memory_order_acquire) +
+           count_total(node->left.load(std::memory_order_acquire)) +
+           count_total(node->right.load(std::memory_order_acquire));
+}
+
+template <typename Key, typename Compare>
+int ConcurrentAVLTree<Key, Compare>::tree_height(const Node *node)
+{
+    if (!node)
+    {
+        return -1;
+    }
+    return 1 + std::max(
+                   tree_height(node->left.load(std::memory_order_acquire)),
+                   tree_height(node->right.load(std::memory_order_acquire)));
+}
@@ -0,0 +1,190 @@
+/*
+ * Filename: EpochReclaimer.cpp
+ * Contains: Implementation of the epoch-based reclaimer that frees what a
+ *      writer unlinks once no reader can still be looking at it
+ */
+
+#include "EpochReclaimer.h"
+
+using namespace std;
+
+thread_local EpochReclaimer::ThreadSlot EpochReclaimer::this_thread = {
+    nullptr};
+
+EpochReclaimer::EpochReclaimer()
+    : epoch(1), slots(nullptr), mutex(), retired() {}
+
+/*
+ * Parameters: EpochReclaimer this - the reclaimer
+ * Returns: N/A
+ * Purpose: the threads are gone by now, so everything retired is freed,
+ *      and so are the slots.
+ */
+EpochReclaimer::~EpochReclaimer()
+{
+    for (const Retired &entry : this->retired)
+    {
+        entry.reclaim(entry.object);
+    }
+    Slot *slot = this->slots.load(memory_order_acquire);
+    while (slot)
+    {
+        Slot *next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+/*
+ * Parameters: N/A
+ * Returns: the shared reclaimer
+ * Purpose: a function-local static, so it is made on first use and
+ *      destroyed at exit, after the thread_local slot of the main thread has
+ *      been given back.
+ */
+EpochReclaimer &EpochReclaimer::shared()
+{
+    static EpochReclaimer reclaimer;
+    return reclaimer;
+}
+
+EpochReclaimer::ThreadSlot::~ThreadSlot()
+{
+    if (this->slot)
+    {
+        this->slot->taken.store(false, memory_order_release);
+    }
+}
+
+/*
+ * Parameters: EpochReclaimer this - the reclaimer
+ * Returns: the slot of the calling thread
+ * Purpose: a slot given back by a thread that exited is reused before a new
+ *      one is added. Slots are never unlinked, so walking the list needs no
+ *      lock, and a new slot is pushed at the front with a CAS.
+ */
+EpochReclaimer::Slot *EpochReclaimer::slot_of_this_thread()
+{
+    if (this_thread.slot)
+    {
+        return this_thread.slot;
+    }
+    for (Slot *slot = this->slots.load(memory_order_acquire); slot;
+         slot = slot->next)
+    {
+        bool taken = false;
+        if (!slot->taken.load(memory_order_relaxed) &&
+            slot->taken.compare_exchange_strong(taken, true,
+                                                memory_order_acquire))
+        {
+            this_thread.slot = slot;
+            return slot;
+        }
+    }
+    Slot *slot = new Slot();
+    slot->epoch.store(0, memory_order_relaxed);
+    slot->taken.store(true, memory_order_relaxed);
+    slot->depth = 0;
+    slot->next = this->slots.load(memory_order_relaxed);
+    while (!this->slots.compare_exchange_weak(slot->next, slot,
+                                              memory_order_release,
+                                              memory_order_relaxed))
+    {
+    }
+    this_thread.slot = slot;
+    return slot;
+}
+
+/*
+ * Parameters: EpochReclaimer reclaimer - the reclaimer
+ * Returns: a guard for the calling thread
+ * Purpose: the fence orders the announcement before every load the reader
+ *      makes inside the guard. A writer that moves the epoch on either sees
+ *      the announcement, and waits for it, or moved on before the reader's
+ *      fence, in which case the reader sees the writer's unlinks and can no
+ *      longer reach what was retired. The announcement is an exchange, not
+ *      a store, so that it continues the release sequence of the reader's
+ *      last exit from a Guard.
+ */
+EpochReclaimer::Guard::Guard(EpochReclaimer &reclaimer)
+    : slot(reclaimer.slot_of_this_thread())
+{
+    if (this->slot->depth++ == 0)
+    {
+        this->slot->epoch.exchange(reclaimer.epoch.load(memory_order_relaxed),
+                                   memory_order_release);
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+EpochReclaimer::Guard::~Guard()
+{
+    if (--this->slot->depth == 0)
+    {
+        this->slot->epoch.store(0, memory_order_release);
+    }
+}
+
+/*
+ * Parameters: EpochReclaimer this - the reclaimer
+ *             void *object - the object to free
+ *             void reclaim(void *) - the function that frees it
+ * Returns: N/A
+ * Purpose: an object retired in epoch e may still be read by a reader that
+ *      announced e, or e - 1, but not by one that announced e + 1, so it is
+ *      freed once the epoch is e + 2. The objects that are due are freed
+ *      outside the lock, since freeing one may take a while.
+ */
+void EpochReclaimer::retire(void *object, void (*reclaim)(void *))
+{
+    vector<Retired> due;
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+        this->retired.push_back(
+            Retired{this->epoch.load(memory_order_relaxed), object, reclaim});
+        this->try_advance();
+
+        uint64_t now = this->epoch.load(memory_order_relaxed);
+        size_t kept = 0;
+        for (const Retired &entry : this->retired)
+        {
+            if (entry.epoch + 2 <= now)
+            {
+                due.push_back(entry);
+            }
+            else
+            {
+                this->retired[kept++] = entry;
+            }
+        }
+        this->retired.resize(kept);
+    }
+    for (const Retired &entry : due)
+    {
+        entry.reclaim(entry.object);
+    }
+}
+
+/*
+ * Parameters: EpochReclaimer this - the reclaimer
+ * Returns: N/A
+ * Purpose: the fence pairs with the one in Guard; a slot that is not in a
+ *      Guard (epoch 0) does not hold the epoch back. Each slot is read with
+ *      acquire, so that what its reader read before leaving its last Guard
+ *      happens before anything this frees.
+ */
+void EpochReclaimer::try_advance()
+{
+    uint64_t now = this->epoch.load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    for (Slot *slot = this->slots.load(memory_order_acquire); slot;
+         slot = slot->next)
+    {
+        uint64_t announced = slot->epoch.load(memory_order_acquire);
+        if (announced != 0 && announced != now)
+        {
+            return;
+        }
+    }
+    this->epoch.store(now + 1, memory_order_release);
+}
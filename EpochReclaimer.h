@@ -0,0 +1,144 @@
+/*
+ * Filename: EpochReclaimer.h
+ * Contains: Interface of the epoch-based reclaimer that frees what a writer
+ *      unlinks once no reader can still be looking at it
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Epoch Reclaimer:
+ *    - readers wrap each lock-free read in a Guard, which announces the
+ *      global epoch in a slot of the reader's thread; a Guard costs an
+ *      exchange, a fence and a store on that slot, and nothing shared is written
+ *    - writers unlink an object from what readers can reach, then retire()
+ *      it, tagged with the epoch it was retired in
+ *    - the epoch only moves on once every reader inside a Guard has
+ *      announced it, so once it has moved on twice since an object was
+ *      retired, every reader that could have reached the object has left
+ *      its Guard, and the object is freed
+ *
+ * Slots are handed out to threads on first use and taken back when the
+ *  thread exits. Guards may nest. There is only the one shared reclaimer,
+ *  which serves every structure that needs one.
+ */
+class EpochReclaimer
+{
+private:
+    struct Slot;
+
+public:
+    /**
+     * Input: N/A
+     * Returns: the reclaimer shared by the whole program, started on first
+     *      use
+     */
+    static EpochReclaimer &shared();
+
+    /**
+     * Destructor. Frees every object still retired.
+     * Assumes: no Guard is alive and no thread will take one
+     */
+    ~EpochReclaimer();
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    /**
+     * Input: EpochReclaimer this - the reclaimer
+     *        void *object - an object no reader can reach any more, though
+     *            readers that reached it before may still be reading it
+     *        void reclaim(void *) - the function that frees object
+     * Returns: N/A
+     * Does: keeps object until no reader can still be reading it, then
+     *      calls reclaim(object), here or in a later call on any thread.
+     *      Runtime: O(number of threads that have taken a Guard)
+     */
+    void retire(void *object, void (*reclaim)(void *));
+
+    /**
+     * RAII guard that marks the calling thread as reading, so that nothing
+     *  retired after it was made is freed before it is destroyed.
+     */
+    class Guard
+    {
+    public:
+        explicit Guard(EpochReclaimer &reclaimer);
+        ~Guard();
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        Slot *slot;
+    };
+
+private:
+    /**
+     * The epoch announced by one thread, on a cache line of its own so
+     *  that readers never write to the same line. 0 means the thread is
+     *  not inside a Guard.
+     */
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint64_t> epoch;
+        std::atomic<bool> taken;
+        unsigned int depth;
+        Slot *next;
+    };
+
+    /**
+     * The slot the calling thread holds, which it gives back when it exits.
+     */
+    struct ThreadSlot
+    {
+        Slot *slot;
+        ~ThreadSlot();
+    };
+
+    static thread_local ThreadSlot this_thread;
+
+    /**
+     * An object waiting to be freed, with the epoch it was retired in.
+     */
+    struct Retired
+    {
+        std::uint64_t epoch;
+        void *object;
+        void (*reclaim)(void *);
+    };
+
+    /**
+     * Input: N/A
+     * Returns: a new reclaimer at epoch 1 with no slots. Only shared() makes
+     *      one, since each thread holds a single slot.
+     */
+    EpochReclaimer();
+
+    /**
+     * Input: EpochReclaimer this - the reclaimer
+     * Returns: the slot of the calling thread, taking a free one, or adding
+     *      one, on first use
+     */
+    Slot *slot_of_this_thread();
+
+    /**
+     * Input: EpochReclaimer this - the reclaimer
+     * Returns: N/A
+     * Does: moves the epoch on if every thread inside a Guard has announced
+     *      it
+     * Assumes: this->mutex is held
+     */
+    void try_advance();
+
+    std::atomic<std::uint64_t> epoch;
+    // Pushed at the front, never removed until the reclaimer is destroyed
+    std::atomic<Slot *> slots;
+    std::mutex mutex;
+    std::vector<Retired> retired;
+};
@@ -0,0 +1,142 @@
+/*
+ * Filename: ForkJoinPool.cpp
+ * Contains: Implementation of the thread pool that runs the two halves of a
+ *      divide-and-conquer algorithm in parallel
+ */
+
+#include "ForkJoinPool.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+ForkJoinPool::ForkJoinPool(unsigned int workers)
+    : mutex(), wake(), tasks(), stopping(false), workers()
+{
+    this->workers.reserve(workers);
+    for (unsigned int i = 0; i < workers; i++)
+    {
+        this->workers.emplace_back(&ForkJoinPool::work, this);
+    }
+}
+
+ForkJoinPool::~ForkJoinPool()
+{
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (thread &worker : this->workers)
+    {
+        worker.join();
+    }
+}
+
+/*
+ * Parameters: N/A
+ * Returns: the shared pool
+ * Purpose: the calling thread takes part in every fork_join, so one worker
+ *      per remaining hardware thread keeps every core busy. The pool is
+ *      started on first use, by one thread only, and never destroyed: a
+ *      tree with static storage may be destroyed after any function-local
+ *      static, and still need the pool then. Its workers sleep until exit.
+ */
+ForkJoinPool &ForkJoinPool::shared()
+{
+    static ForkJoinPool &pool =
+        *new ForkJoinPool(max(thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+unsigned int ForkJoinPool::worker_count() const
+{
+    return (unsigned int)this->workers.size();
+}
+
+/*
+ * Parameters: ForkJoinPool this - the pool
+ *             Task task - the task to queue
+ * Returns: N/A
+ * Purpose: queues task at the back, where its owner will look for it first,
+ *      while workers take from the front
+ */
+void ForkJoinPool::push(Task *task)
+{
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(task);
+    }
+    this->wake.notify_one();
+}
+
+/*
+ * Parameters: ForkJoinPool this - the pool
+ *             Task task - a task queued by this thread
+ * Returns: N/A
+ * Purpose: fork_joins nest, so every task the first half forked has been
+ *      joined by now, and task is the only one of this thread's that can
+ *      still be queued. It is looked for from the back, where it was
+ *      pushed; other threads' tasks are left to the workers. The worker
+ *      that took it sets done and notifies under the mutex, so once this
+ *      wakes and gets the mutex back, the worker is done with task and it
+ *      may be destroyed.
+ */
+void ForkJoinPool::wait_for(Task *task)
+{
+    unique_lock<std::mutex> lock(this->mutex);
+    deque<Task *>::reverse_iterator queued =
+        find(this->tasks.rbegin(), this->tasks.rend(), task);
+    if (queued != this->tasks.rend())
+    {
+        this->tasks.erase(next(queued).base());
+        lock.unlock();
+        execute(task);
+    }
+    else
+    {
+        task->finished.wait(lock, [task]() { return task->done; });
+        lock.unlock();
+    }
+    if (task->error)
+    {
+        rethrow_exception(task->error);
+    }
+}
+
+void ForkJoinPool::execute(Task *task)
+{
+    try
+    {
+        task->run(task);
+    }
+    catch (...)
+    {
+        task->error = current_exception();
+    }
+}
+
+void ForkJoinPool::work()
+{
+    while (true)
+    {
+        Task *task;
+        {
+            unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this]() {
+                return this->stopping || !this->tasks.empty();
+            });
+            if (this->tasks.empty())
+            {
+                return;
+            }
+            task = this->tasks.front();
+            this->tasks.pop_front();
+        }
+        execute(task);
+        lock_guard<std::mutex> lock(this->mutex);
+        task->done = true;
+        task->finished.notify_one();
+    }
+}
@@ -0,0 +1,202 @@
+/*
+ * Filename: ForkJoinPool.h
+ * Contains: Interface of the thread pool that runs the two halves of a
+ *      divide-and-conquer algorithm in parallel
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Fork-Join Pool:
+ *    - a fixed set of worker threads sharing one queue of tasks
+ *    - fork_join(first, second) queues second, runs first on the calling
+ *      thread, then takes second back and runs it too, if no worker has
+ *      taken it yet. Otherwise the caller sleeps until the worker is done.
+ *      The caller only ever runs its own task, so a join is never held up
+ *      behind another caller's work; and since every task it waits for is
+ *      running, recursive forks cannot deadlock
+ *    - workers take the oldest task, which in a divide-and-conquer algorithm
+ *      is the biggest one left, so each steal hands over a large share of
+ *      the work
+ *
+ * Tasks live on the stack of the fork_join call that queued them, so queuing
+ *  one allocates nothing. A pool with no workers runs both halves in turn.
+ */
+class ForkJoinPool
+{
+public:
+    /**
+     * Input: unsigned int workers - the number of threads to start, not
+     *            counting the threads that call fork_join
+     * Returns: a new pool with its workers waiting for tasks
+     */
+    explicit ForkJoinPool(unsigned int workers);
+
+    /**
+     * Destructor. Waits for the workers to finish their current tasks, then
+     *  joins them.
+     * Assumes: no fork_join on this is still running
+     */
+    ~ForkJoinPool();
+
+    ForkJoinPool(const ForkJoinPool &) = delete;
+    ForkJoinPool &operator=(const ForkJoinPool &) = delete;
+
+    /**
+     * Input: N/A
+     * Returns: the pool shared by the whole program, with one worker fewer
+     *      than there are hardware threads, started on first use and never
+     *      destroyed
+     */
+    static ForkJoinPool &shared();
+
+    /**
+     * Input: ForkJoinPool this - the pool
+     * Returns: the number of worker threads of this
+     */
+    unsigned int worker_count() const;
+
+    /**
+     * Input: ForkJoinPool this - the pool
+     *        F first, G second - callables taking no arguments
+     * Returns: N/A
+     * Does: runs first on the calling thread and second on whichever thread
+     *      gets to it first, and returns once both are done. If either
+     *      throws, the exception is rethrown here once both are done (first's,
+     *      if both throw).
+     * Assumes: first and second touch disjoint data, or synchronize
+     */
+    template <typename F, typename G>
+    void fork_join(F &&first, G &&second);
+
+private:
+    /**
+     * A queued half of a fork_join, type-erased so that one queue can hold
+     *  any callable.
+     */
+    struct Task
+    {
+        void (*run)(Task *task);
+        std::exception_ptr error;
+
+        /**
+         * Set, and finished notified, under the pool's mutex by the worker
+         *  that ran the task, so that its owner can wait for it.
+         */
+        bool done;
+        std::condition_variable finished;
+
+        explicit Task(void (*run)(Task *))
+            : run(run), error(), done(false), finished()
+        {
+        }
+    };
+
+    /**
+     * The Task that calls a G.
+     */
+    template <typename G>
+    struct TaskFor : Task
+    {
+        G &callable;
+
+        explicit TaskFor(G &callable) : Task(&TaskFor::call), callable(callable)
+        {
+        }
+
+        static void call(Task *task)
+        {
+            static_cast<TaskFor *>(task)->callable();
+        }
+    };
+
+    /**
+     * Input: ForkJoinPool this - the pool
+     *        Task task - the task to queue
+     * Returns: N/A
+     * Does: queues task and wakes a worker to take it
+     */
+    void push(Task *task);
+
+    /**
+     * Input: ForkJoinPool this - the pool
+     *        Task task - a task queued by this thread
+     * Returns: N/A
+     * Does: takes task back off the queue and runs it, if no worker has
+     *      taken it yet, or else sleeps until the worker is done with it;
+     *      then rethrows its exception, if it threw one
+     */
+    void wait_for(Task *task);
+
+    /**
+     * Input: Task task - a task taken off the queue
+     * Returns: N/A
+     * Does: runs task, keeping any exception it throws
+     */
+    static void execute(Task *task);
+
+    /**
+     * Input: ForkJoinPool this - the pool
+     * Returns: N/A
+     * Does: the loop of each worker: takes the oldest task, runs it and
+     *      wakes its owner, sleeping while the queue is empty, until the pool
+     *      is destroyed
+     */
+    void work();
+
+    /**
+     * Guards the queue, stopping and the done flag of every task.
+     */
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Task *> tasks;
+    bool stopping;
+    std::vector<std::thread> workers;
+};
+
+/*
+ * Parameters: ForkJoinPool this - the pool
+ *             F first, G second - the two halves
+ * Returns: N/A
+ * Purpose: second is only queued if someone can take it. If first throws,
+ *      second is still waited for, since its task lives in this frame and
+ *      must not outlive it.
+ */
+template <typename F, typename G>
+void ForkJoinPool::fork_join(F &&first, G &&second)
+{
+    if (this->workers.empty())
+    {
+        first();
+        second();
+        return;
+    }
+
+    TaskFor<typename std::remove_reference<G>::type> task(second);
+    this->push(&task);
+    try
+    {
+        first();
+    }
+    catch (...)
+    {
+        try
+        {
+            this->wait_for(&task);
+        }
+        catch (...)
+        {
+        }
+        throw;
+    }
+    this->wait_for(&task);
+}
@@ -0,0 +1,339 @@
+/*
+ * Filename: FrozenTree.cpp
+ * Contains: Implementation of Frozen Trees
+ */
+
+#include "FrozenTree.h"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+using namespace std;
+
+/*
+ * The size of a cache line, in bytes, and in keys.
+ */
+static const size_t CACHE_LINE = 64;
+static const size_t KEYS_PER_LINE = CACHE_LINE / sizeof(int);
+
+/*
+ * Parameters: Node root - the root of a tree
+ *             vector nodes - receives the non-empty nodes of the tree
+ * Returns: N/A
+ * Purpose: appends the nodes of the tree to nodes in order. An explicit stack
+ *      is used rather than recursion, since a naive BST may be as deep as it
+ *      is large.
+ */
+static void collect_in_order(const BSTNode<int> *root,
+                             vector<const BSTNode<int> *> &nodes)
+{
+    vector<const BSTNode<int> *> stack;
+    const BSTNode<int> *curr = root;
+    while (!curr->is_empty() || !stack.empty())
+    {
+        while (!curr->is_empty())
+        {
+            stack.push_back(curr);
+            curr = curr->left;
+        }
+        curr = stack.back();
+        stack.pop_back();
+        nodes.push_back(curr);
+        curr = curr->right;
+    }
+}
+
+/*
+ * Parameters: size_t k - a BFS index reached by a descent
+ * Returns: the number of 1 bits at the bottom of k
+ * Purpose: each step of a descent appends one bit to the BFS index, 1 for
+ *      right and 0 for left, so this is the number of right turns since the
+ *      last left turn.
+ */
+static inline size_t trailing_ones(size_t k)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzl((unsigned long)~k);
+#else
+    size_t ones = 0;
+    while (k & 1)
+    {
+        k >>= 1;
+        ones++;
+    }
+    return ones;
+#endif
+}
+
+FrozenTree::FrozenTree()
+    : order(EYTZINGER), n(0), slots(0), keys(nullptr), counts(1, 0),
+      minimum(0), maximum(0)
+{
+    this->allocate(0);
+}
+
+/*
+ * Parameters: Node root - the root of the tree to freeze
+ *             Layout layout - the order to store the values in
+ * Returns: a snapshot of the tree rooted at root
+ * Purpose: an in-order walk of the implicit tree visits its nodes in sorted
+ *      order, so walking it alongside the sorted values fills in every key.
+ *      path[d] holds the position of the node at depth d on the way down,
+ *      which is all a van Emde Boas position depends on. The walk is only as
+ *      deep as the implicit tree, which is balanced.
+ */
+FrozenTree::FrozenTree(const BSTNode<int> *root, Layout layout)
+    : order(layout), n(0), slots(0), keys(nullptr), minimum(0), maximum(0)
+{
+    vector<const BSTNode<int> *> sorted;
+    collect_in_order(root, sorted);
+    this->n = sorted.size();
+    if (this->n > 0)
+    {
+        this->minimum = sorted.front()->data;
+        this->maximum = sorted.back()->data;
+    }
+
+    size_t height = 0;
+    while (((size_t)1 << height) - 1 < this->n)
+    {
+        height++;
+    }
+    if (layout == EYTZINGER)
+    {
+        this->allocate(this->n);
+    }
+    else
+    {
+        // Depth 0 has no top tree, which makes the root's position path[0]
+        this->allocate(((size_t)1 << height) - 1);
+        this->splits.assign(height, Split{0, 0, 0});
+        this->split_van_emde_boas(0, height);
+    }
+    this->counts.assign(this->slots + 1, 0);
+
+    struct Pending
+    {
+        size_t index;
+        size_t depth;
+    };
+
+    // Explicit stack of implicit-tree nodes whose left subtrees are pending
+    vector<Pending> stack;
+    vector<size_t> path(height + 1, 1);
+    size_t next = 0;
+    size_t index = 1;
+    size_t depth = 0;
+    while (index <= this->slots || !stack.empty())
+    {
+        while (index <= this->slots)
+        {
+            if (layout == EYTZINGER)
+            {
+                path[depth] = index;
+            }
+            else
+            {
+                const Split &split = this->splits[depth];
+                path[depth] = path[split.top_depth] + split.top_size +
+                              (index & split.top_size) * split.bottom_size;
+            }
+            stack.push_back({index, depth});
+            index = 2 * index;
+            depth++;
+        }
+        Pending curr = stack.back();
+        stack.pop_back();
+
+        size_t k = path[curr.depth];
+        if (next < this->n)
+        {
+            this->keys[k] = sorted[next]->data;
+            this->counts[k] = (unsigned int)sorted[next]->count;
+        }
+        else
+        {
+            this->keys[k] = numeric_limits<int>::max();
+        }
+        next++;
+
+        index = 2 * curr.index + 1;
+        depth = curr.depth + 1;
+    }
+}
+
+FrozenTree::FrozenTree(const FrozenTree &source)
+    : order(source.order), n(source.n), slots(0), keys(nullptr),
+      counts(source.counts), minimum(source.minimum), maximum(source.maximum),
+      splits(source.splits)
+{
+    this->allocate(source.slots);
+    copy(source.keys, source.keys + source.slots + 1, this->keys);
+}
+
+FrozenTree::~FrozenTree()
+{
+    ::operator delete[](this->keys, align_val_t(CACHE_LINE));
+}
+
+/*
+ * Parameters: the source snapshot that needs to be copied
+ * Returns: a pointer to the snapshot
+ * Purpose:  Assignment overload. Assigns rhs to this by deep copy.
+ */
+FrozenTree &FrozenTree::operator=(const FrozenTree &source)
+{
+    // Check for self-assignment
+    if (this != &source)
+    {
+        if (this->slots != source.slots)
+        {
+            ::operator delete[](this->keys, align_val_t(CACHE_LINE));
+            this->keys = nullptr;
+            this->allocate(source.slots);
+        }
+        copy(source.keys, source.keys + source.slots + 1, this->keys);
+        this->order = source.order;
+        this->n = source.n;
+        this->counts = source.counts;
+        this->minimum = source.minimum;
+        this->maximum = source.maximum;
+        this->splits = source.splits;
+    }
+    return *this;
+}
+
+int FrozenTree::minimum_value() const
+{
+    return this->minimum;
+}
+
+int FrozenTree::maximum_value() const
+{
+    return this->maximum;
+}
+
+/*
+ * Parameters: FrozenTree this - the snapshot
+ *             int value - value to search for
+ * Returns: the number of occurences of value in this, or 0 if value is not
+ *      in this
+ * Purpose: counts[0] is 0, as is the count of every padding key, so a miss
+ *      needs no special case.
+ */
+unsigned int FrozenTree::count_of(int value) const
+{
+    size_t k = this->order == EYTZINGER
+                   ? this->eytzinger_lower_bound(value)
+                   : this->van_emde_boas_lower_bound(value);
+    return this->keys[k] == value ? this->counts[k] : 0;
+}
+
+int FrozenTree::node_count() const
+{
+    return (int)this->n;
+}
+
+FrozenTree::Layout FrozenTree::layout() const
+{
+    return this->order;
+}
+
+/*
+ * Parameters: FrozenTree this - an EYTZINGER snapshot
+ *             int value - value to search for
+ * Returns: the index of the smallest key not less than value, or 0 if every
+ *      key is less than value
+ * Purpose: the comparison feeds the next index arithmetically instead of
+ *      choosing a branch, so there is nothing to mispredict and every search
+ *      takes the same number of steps. The 16 nodes four levels below k
+ *      start at index 16k and fill one cache line, which is fetched while the
+ *      intervening levels are compared. Prefetching past the end of the array
+ *      is harmless, since a prefetch never faults.
+ */
+size_t FrozenTree::eytzinger_lower_bound(int value) const
+{
+    size_t k = 1;
+    while (k <= this->slots)
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(this->keys + KEYS_PER_LINE * k);
+#endif
+        k = 2 * k + (this->keys[k] < value);
+    }
+    // The answer is the node where the descent last went left
+    return k >> (trailing_ones(k) + 1);
+}
+
+/*
+ * Parameters: FrozenTree this - a VAN_EMDE_BOAS snapshot
+ *             int value - value to search for
+ * Returns: the index of the smallest key not less than value, or 0 if every
+ *      key is less than value
+ * Purpose: the descent tracks the BFS index of the current node, exactly as
+ *      in the Eytzinger layout, and the tables turn it into a position given
+ *      the position of one ancestor on the path. The tree is perfect, so
+ *      every search goes exactly height levels deep.
+ */
+size_t FrozenTree::van_emde_boas_lower_bound(int value) const
+{
+    size_t height = this->splits.size();
+    size_t path[sizeof(size_t) * 8];
+    path[0] = 1;
+
+    size_t index = 1;
+    for (size_t depth = 0; depth < height; depth++)
+    {
+        const Split &split = this->splits[depth];
+        size_t k = path[split.top_depth] + split.top_size +
+                   (index & split.top_size) * split.bottom_size;
+        path[depth] = k;
+        index = 2 * index + (this->keys[k] < value);
+    }
+
+    // The answer is the node where the descent last went left, if it did
+    size_t right_turns = trailing_ones(index);
+    return right_turns < height ? path[height - 1 - right_turns] : 0;
+}
+
+/*
+ * Parameters: FrozenTree this - a VAN_EMDE_BOAS snapshot
+ *             size_t depth - the depth of the root of a subtree
+ *             size_t height - the height of that subtree
+ * Returns: N/A
+ * Purpose: the subtree's top tree ends just above depth + height / 2, so the
+ *      nodes at that depth are the roots of its bottom trees. Every other
+ *      depth inside the subtree is split by a smaller subtree.
+ */
+void FrozenTree::split_van_emde_boas(size_t depth, size_t height)
+{
+    if (height <= 1)
+    {
+        return;
+    }
+    size_t top_height = height / 2;
+    size_t bottom_height = height - top_height;
+    size_t bottom_depth = depth + top_height;
+
+    this->splits[bottom_depth].top_depth = depth;
+    this->splits[bottom_depth].top_size = ((size_t)1 << top_height) - 1;
+    this->splits[bottom_depth].bottom_size = ((size_t)1 << bottom_height) - 1;
+
+    this->split_van_emde_boas(depth, top_height);
+    this->split_van_emde_boas(bottom_depth, bottom_height);
+}
+
+/*
+ * Parameters: size_t slots - the number of keys
+ * Returns: N/A
+ * Purpose: allocates keys[0..slots] on a cache line boundary, so that
+ *      keys[16k] starts a line for every k.
+ */
+void FrozenTree::allocate(size_t slots)
+{
+    this->slots = slots;
+    this->keys = static_cast<int *>(
+        ::operator new[]((slots + 1) * sizeof(int), align_val_t(CACHE_LINE)));
+    this->keys[0] = 0;
+}
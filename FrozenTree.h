@@ -0,0 +1,176 @@
+/*
+ * Filename: FrozenTree.h
+ * Contains: Interface of Frozen Trees, immutable read-optimized snapshots of
+ *      a tree
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "BSTNode.h"
+
+/**
+ * Frozen Tree:
+ *    - keys[1..slots] holds the distinct values of the tree in one of two
+ *      layouts of an implicit binary search tree; keys[0] is unused
+ *    - counts[k] is the number of occurrences of keys[k]; counts[0] is 0
+ *    - n is the number of distinct values
+ *    - minimum, maximum are the first and last values in order
+ *
+ * EYTZINGER is BFS order: keys[1] is the root and the children of keys[k]
+ *  are keys[2k] and keys[2k + 1], so slots == n. keys is aligned to a cache
+ *  line, so the 16 descendants of keys[k] four levels down share one line
+ *  and can be prefetched together. This is the better layout while the
+ *  snapshot fits in cache.
+ *
+ * VAN_EMDE_BOAS is recursive order: a tree of height h is split into a top
+ *  tree of height h / 2 and the bottom trees hanging from it, and the top
+ *  tree is stored first, followed by each bottom tree, each laid out the
+ *  same way. Any subtree small enough to fit in a block of memory is then
+ *  stored contiguously, whatever the block size, so searches of a snapshot
+ *  much larger than the cache touch O(log_B n) blocks. The implicit tree is
+ *  perfect, so the keys after the first n in order are padding: INT_MAX
+ *  with count 0.
+ *  For a node at depth d, splits[d].top_depth is the depth of the root of
+ *  the top tree it hangs from, and splits[d].top_size, bottom_size are the
+ *  sizes of
+ *  that top tree and of each of its bottom trees.
+ *
+ * A snapshot is independent of the tree it was frozen from: later changes
+ *  to that tree are not reflected in it, and it may outlive the tree.
+ */
+class FrozenTree
+{
+public:
+    /**
+     * The order in which the implicit search tree is stored.
+     */
+    enum Layout
+    {
+        EYTZINGER,
+        VAN_EMDE_BOAS
+    };
+
+    /**
+     * Default constructor. Creates a snapshot of an empty tree.
+     */
+    FrozenTree();
+
+    /**
+     * Input: Node root - the root of the tree to freeze
+     *        Layout layout - the order to store the values in
+     * Returns: a snapshot of the tree rooted at root
+     * Does: collects the tree's values in order, then lays them out in
+     *      layout. Runtime: O(n)
+     */
+    explicit FrozenTree(const BSTNode<int> *root, Layout layout = EYTZINGER);
+
+    /**
+     * Copy constructor. Creates a new snapshot as a deep copy of source
+     */
+    FrozenTree(const FrozenTree &source);
+
+    /**
+     * Destructor. Frees all memory owned by this.
+     */
+    ~FrozenTree();
+
+    /**
+     * Assignment overload. Assigns rhs to this by deep copy.
+     */
+    FrozenTree &operator=(const FrozenTree &rhs);
+
+    /**
+     * Input: FrozenTree this - the snapshot
+     * Returns: the minimum value in this. Behavior is undefined if this is
+     *      empty
+     */
+    int minimum_value() const;
+
+    /**
+     * Input: FrozenTree this - the snapshot
+     * Returns: the maximum value in this. Behavior is undefined if this is
+     *      empty
+     */
+    int maximum_value() const;
+
+    /**
+     * Input: FrozenTree this - the snapshot
+     *        int value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: a branch-free descent that always runs to the bottom of the
+     *      implicit tree
+     */
+    unsigned int count_of(int value) const;
+
+    /**
+     * Input: FrozenTree this - the snapshot
+     * Returns: The number of distinct values in this
+     */
+    int node_count() const;
+
+    /**
+     * Input: FrozenTree this - the snapshot
+     * Returns: the layout this is stored in
+     */
+    Layout layout() const;
+
+private:
+    /**
+     * Where the van Emde Boas layout splits off the subtree rooted at a
+     *  given depth, and the sizes of the pieces.
+     */
+    struct Split
+    {
+        std::size_t top_depth;
+        std::size_t top_size;
+        std::size_t bottom_size;
+    };
+
+    /**
+     * Input: FrozenTree this - an EYTZINGER snapshot
+     *        int value - value to search for
+     * Returns: the index of the smallest key not less than value, or 0 if
+     *      every key is less than value
+     * Does: prefetches four levels ahead while descending
+     */
+    std::size_t eytzinger_lower_bound(int value) const;
+
+    /**
+     * Input: FrozenTree this - a VAN_EMDE_BOAS snapshot
+     *        int value - value to search for
+     * Returns: the index of the smallest key not less than value, or 0 if
+     *      every key is less than value
+     * Does: descends by BFS index, turning each into its position in the
+     *      layout with the per-depth tables
+     */
+    std::size_t van_emde_boas_lower_bound(int value) const;
+
+    /**
+     * Input: FrozenTree this - a VAN_EMDE_BOAS snapshot
+     *        size_t depth - the depth of the root of a subtree
+     *        size_t height - the height of that subtree
+     * Returns: N/A
+     * Does: fills in the per-depth tables for the splits inside the subtree
+     */
+    void split_van_emde_boas(std::size_t depth, std::size_t height);
+
+    /**
+     * Input: size_t slots - the number of keys
+     * Returns: N/A
+     * Does: allocates cache-line-aligned storage for keys[0..slots]
+     */
+    void allocate(std::size_t slots);
+
+    Layout order;
+    std::size_t n;
+    std::size_t slots;
+    int *keys;
+    std::vector<unsigned int> counts;
+    int minimum;
+    int maximum;
+    std::vector<Split> splits;
+};
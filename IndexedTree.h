@@ -0,0 +1,363 @@
+/*
+ * Filename: IndexedTree.h
+ * Contains: Interface of Indexed Trees, Red-Black Trees whose nodes live in
+ *      one contiguous vector and link to each other by 32-bit index
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A Red-Black Tree of keys and their counts, like RBTree, stored the way a
+ *  PackedTree is but kept in that form while it is searched and updated:
+ *    - every node is an element of one vector, and its links are 32-bit
+ *      indices into it rather than pointers. Index 0 is the nil sentinel,
+ *      which is BLACK and links to nothing, so an empty child or a missing
+ *      parent is 0
+ *    - a node's parent index and color share one word, as parent_meta does
+ *      in a BSTNode, so a node of int keys takes 20 bytes where a BSTNode
+ *      takes 40
+ *    - removing a node moves the last node of the vector into its slot, so
+ *      the vector holds exactly node_count() + 1 nodes, with no holes
+ *
+ * Nothing in a tree is an address, and Key must be trivially copyable, so
+ *  the node vector can be copied with memcpy, written out and read back as
+ *  it is, with no pointer fix-ups. The price is that any insertion may move
+ *  every node, so nothing may hold on to a node across an update; the tree
+ *  itself only ever refers to nodes by index.
+ *
+ * A tree holds at most 2^31 - 1 nodes, since one bit of the parent word is
+ *  the color.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class IndexedTree
+{
+    static_assert(std::is_trivially_copyable<Key>::value,
+                  "an IndexedTree's nodes are copied as raw bytes");
+
+public:
+    enum Color
+    {
+        BLACK,
+        RED
+    };
+
+    enum Direction
+    {
+        LEFT,
+        RIGHT,
+        ROOT
+    };
+
+    /**
+     * Indexed Node:
+     *    - data, count are the key and the number of times it occurs
+     *    - left, right are the indices of the children, or 0 if empty
+     *    - parent_meta is the index of the parent (0 for the root) shifted
+     *      left by one, with the color in the low bit
+     */
+    struct Node
+    {
+        Key data;
+        int count;
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t parent_meta;
+    };
+
+private:
+    static constexpr std::uint32_t COLOR_BIT = 1;
+    static constexpr std::uint32_t MAX_NODES = 0x7fffffff;
+
+    /**
+     * How many nodes read() takes from the stream at a time, so that the
+     *  node count in an image's header is never trusted with an allocation
+     *  before the nodes it promises have arrived.
+     */
+    static constexpr std::uint32_t READ_CHUNK = 1 << 16;
+
+    /**
+     * The nodes, nil sentinel first, and the index of the root (0 if this
+     *  is empty).
+     */
+    std::vector<Node> nodes;
+    std::uint32_t root;
+
+    /**
+     * The accessors of BSTNode, on indices. Setting a child also sets the
+     *  child's parent, unless the child is the nil sentinel, which is never
+     *  written to.
+     */
+    std::uint32_t parent(std::uint32_t node) const;
+    void set_parent(std::uint32_t node, std::uint32_t parent);
+    Color color(std::uint32_t node) const;
+    void set_color(std::uint32_t node, Color color);
+    std::uint32_t child(std::uint32_t node, Direction dir) const;
+    void set_child(std::uint32_t node, Direction dir, std::uint32_t child);
+    void swap_colors(std::uint32_t a, std::uint32_t b);
+    static bool key_less(const Key &a, const Key &b);
+    static Direction opposite_direction(Direction dir);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Node node - the index of a node of this
+     * Returns: the direction of node from its parent, or ROOT
+     */
+    Direction direction_of(std::uint32_t node) const;
+
+    enum Shape
+    {
+        SHAPE_NONE,
+        LL,
+        LR,
+        RL,
+        RR
+    };
+
+    /**
+     * The neighborhood of a node with a possible red-red violation, as in
+     *  BSTNode: the violation is between [p] and [x], and y is p's sibling.
+     *  See BSTNode::RRVNeighborhood for the four shapes.
+     */
+    struct RRVNeighborhood
+    {
+        std::uint32_t g;
+        std::uint32_t p;
+        std::uint32_t x;
+        std::uint32_t y;
+        Shape shape;
+
+        /**
+         * Input: IndexedTree tree - the tree
+         *        Node g - the index of the root of the neighborhood
+         * Returns: the neighborhood rooted at g. If g is not BLACK, or is
+         *  empty, or there is not exactly one red-red violation below it,
+         *  its shape is SHAPE_NONE and p, x and y are undefined.
+         */
+        RRVNeighborhood(const IndexedTree &tree, std::uint32_t g);
+    };
+
+    enum Case
+    {
+        CASE_NONE,
+        CASE_1,
+        CASE_2,
+        CASE_3,
+        CASE_4,
+        CASE_5,
+        CASE_6
+    };
+
+    /**
+     * The neighborhood of a node with a possible black-height violation, as
+     *  in BSTNode: n is the node, p its parent, s its sibling, and c and d
+     *  the children of s nearest to and furthest from n. See
+     *  BSTNode::BHVNeighborhood for the six cases.
+     */
+    struct BHVNeighborhood
+    {
+        std::uint32_t n;
+        std::uint32_t p;
+        std::uint32_t s;
+        std::uint32_t c;
+        std::uint32_t d;
+        Case del_case;
+        Direction dir;
+
+        /**
+         * Input: IndexedTree tree - the tree
+         *        Node n - the index of the node about to be deleted
+         *        Direction dir - the direction of n from its parent
+         * Returns: the neighborhood of n. If n is not a BLACK node, its
+         *  case is CASE_NONE; if it has no parent, CASE_1.
+         */
+        BHVNeighborhood(const IndexedTree &tree, std::uint32_t n,
+                        Direction dir);
+
+        /**
+         * Input: Neighborhood this - a neighborhood with p and dir set
+         *        IndexedTree tree - the tree
+         * Returns: N/A
+         * Does: recomputes s, c, d and del_case from p and dir alone
+         */
+        void find_case(const IndexedTree &tree);
+    };
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Node node - the index of the root of a subtree
+     *        Direction dir - the direction in which to rotate
+     * Returns: the index of the root of the rotated subtree
+     * Does: rotates the subtree rooted at node in the direction dir, and
+     *      links the new root to node's parent (or makes it the root of
+     *      this). If dir is ROOT, does nothing.
+     * Assumes: node has a non-empty child opposite dir
+     */
+    std::uint32_t dir_rotate(std::uint32_t node, Direction dir);
+    std::uint32_t right_rotate(std::uint32_t node);
+    std::uint32_t left_rotate(std::uint32_t node);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Node node - the index of the root of a subtree
+     * Returns: the index of the root of the subtree once fixed
+     * Does: eliminates the red-red violation (if there is one) in the
+     *      neighborhood of node, as BSTNode::rb_eliminate_red_red_violation
+     *      does, without changing the subtree's black-height
+     */
+    std::uint32_t eliminate_red_red_violation(std::uint32_t node);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        BHVNeighborhood nb - the neighborhood of a BLACK leaf that has
+     *            just been unlinked
+     * Returns: N/A
+     * Does: eliminates the black-height violation the removal left, by
+     *      "bubbling up" from nb, as BSTNode does
+     */
+    void fix_blackheight_imbalance(BHVNeighborhood nb);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Node hole - the index of a node that is no longer linked into
+     *            this
+     * Returns: N/A
+     * Does: moves the last node of the vector into hole, relinking its
+     *      parent and children, and drops the last slot
+     */
+    void release(std::uint32_t hole);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Node node - the index of the root of a subtree
+     * Returns: the height of the subtree (-1 if empty)
+     */
+    int subtree_height(std::uint32_t node) const;
+
+    /**
+     * Input: vector<Node> image - a node vector read from a stream
+     *        Node root - the index of its root
+     * Returns: true iff image is one Red-Black Tree rooted at root, with
+     *      every link in range, every node reachable from root and every
+     *      key in order
+     * Does: walks the tree without recursion, since the image may be of
+     *      any shape
+     */
+    static bool is_valid(const std::vector<Node> &image, std::uint32_t root);
+
+public:
+    /**
+     * Default constructor. Creates an empty tree. Trees are copied and
+     *  assigned by copying their node vectors.
+     */
+    IndexedTree();
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        size_t count - the number of nodes to make room for
+     * Returns: N/A
+     * Does: reserves the vector, so that inserting up to count distinct keys
+     *      moves no node
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * Input: IndexedTree this - the tree
+     * Returns: the minimum value in this
+     * Does: Searches this for its minimum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &minimum_value() const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     * Returns: the maximum value in this
+     * Does: Searches this for its maximum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &maximum_value() const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches the tree for value
+     */
+    unsigned int count_of(const Key &value) const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Key value - value to insert
+     * Returns: N/A
+     * Does: Inserts value into this as RBTree does: a new key gets a RED
+     *      node at the end of the vector, and red-red violations are fixed
+     *      on the way back up. Runtime: O(log n), amortized
+     */
+    void insert(const Key &value);
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        Key value - value to remove
+     * Returns: N/A
+     * Does: Removes one occurrence of value from this as RBTree does, then
+     *      fills the node's slot with the last node. Runtime: O(log n)
+     */
+    void remove(const Key &value);
+
+    /**
+     * Input: IndexedTree this - the tree
+     * Returns: the height of this. (An empty tree has height -1.)
+     */
+    int tree_height() const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     * Returns: The number of nodes in this tree
+     */
+    int node_count() const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Does: adds up the counts in one pass over the vector. Runtime: O(n)
+     */
+    int count_total() const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        F visit - called as visit(key, count) for each key
+     * Returns: N/A
+     * Does: visits the keys in order, following the parent links rather
+     *      than keeping a stack. visit must not change this.
+     */
+    template <typename F>
+    void for_each(F visit) const;
+
+    /**
+     * Input: IndexedTree this - the tree
+     *        ostream out - the stream to write to
+     * Returns: N/A
+     * Does: writes the node count and the root, followed by the node vector
+     *      as it is, in the byte order of this machine
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * Input: IndexedTree this - the tree to replace
+     *        istream in - a stream positioned at the output of write()
+     * Returns: true iff a well-formed tree was read. On failure this is left
+     *      empty.
+     * Does: reads the node vector back in chunks, then checks that it is a
+     *      Red-Black Tree before using it. Runtime: O(n)
+     */
+    bool read(std::istream &in);
+};
+
+#include "IndexedTree.tpp"
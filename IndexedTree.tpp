@@ -0,0 +1,860 @@
+/*
+ * Filename: IndexedTree.tpp
+ * Contains: Implementation of Indexed Trees
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+/*
+ * Nodes are always reached through this->nodes by index, never through a
+ *  reference kept across a push_back, since that may move the vector.
+ */
+
+/************************************
+ * BEGIN PUBLIC INDEXEDTREE SECTION *
+ ************************************/
+
+template <typename Key, typename Compare>
+IndexedTree<Key, Compare>::IndexedTree() : nodes(1, Node()), root(0)
+{
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::reserve(std::size_t count)
+{
+    this->nodes.reserve(count + 1);
+}
+
+template <typename Key, typename Compare>
+const Key &IndexedTree<Key, Compare>::minimum_value() const
+{
+    std::uint32_t node = this->root;
+    while (this->nodes[node].left != 0)
+    {
+        node = this->nodes[node].left;
+    }
+    return this->nodes[node].data;
+}
+
+template <typename Key, typename Compare>
+const Key &IndexedTree<Key, Compare>::maximum_value() const
+{
+    std::uint32_t node = this->root;
+    while (this->nodes[node].right != 0)
+    {
+        node = this->nodes[node].right;
+    }
+    return this->nodes[node].data;
+}
+
+template <typename Key, typename Compare>
+unsigned int IndexedTree<Key, Compare>::count_of(const Key &value) const
+{
+    std::uint32_t node = this->root;
+    while (node != 0)
+    {
+        const Node &curr = this->nodes[node];
+        if (key_less(value, curr.data))
+        {
+            node = curr.left;
+        }
+        else if (key_less(curr.data, value))
+        {
+            node = curr.right;
+        }
+        else
+        {
+            return curr.count;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Parameters: IndexedTree this - the tree
+ *             Key value - value to insert
+ * Returns: N/A
+ * Purpose: the climb is the one RBBalance::after_insert makes: a red-red
+ *      violation can only be between the root of a subtree that changed
+ *      and one of its children, so once that root is BLACK there is nothing
+ *      left to fix above it.
+ */
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::insert(const Key &value)
+{
+    std::uint32_t up = 0;
+    Direction dir = ROOT;
+    std::uint32_t node = this->root;
+    while (node != 0)
+    {
+        Node &curr = this->nodes[node];
+        up = node;
+        if (key_less(value, curr.data))
+        {
+            dir = LEFT;
+            node = curr.left;
+        }
+        else if (key_less(curr.data, value))
+        {
+            dir = RIGHT;
+            node = curr.right;
+        }
+        else
+        {
+            curr.count++;
+            return;
+        }
+    }
+
+    assert(this->nodes.size() <= MAX_NODES);
+    std::uint32_t index = (std::uint32_t)this->nodes.size();
+    this->nodes.push_back({value, 1, 0, 0, (up << 1) | COLOR_BIT});
+    if (dir == ROOT)
+    {
+        this->root = index;
+    }
+    else
+    {
+        this->set_child(up, dir, index);
+    }
+
+    for (node = up; node != 0;)
+    {
+        std::uint32_t top = this->eliminate_red_red_violation(node);
+        if (this->color(top) == BLACK)
+        {
+            break;
+        }
+        node = this->parent(top);
+    }
+    this->set_color(this->root, BLACK);
+}
+
+/*
+ * Parameters: IndexedTree this - the tree
+ *             Key value - value to remove
+ * Returns: N/A
+ * Purpose: the removal of BSTNode::rb_remove_helper: a node with two
+ *      children trades entries with its successor, which is removed instead.
+ *      The neighborhood of a BLACK leaf is taken before it is unlinked, and
+ *      its slot is only filled once the fix-up is done, so that no index in
+ *      the neighborhood moves under it.
+ */
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::remove(const Key &value)
+{
+    Direction dir = ROOT;
+    std::uint32_t node = this->root;
+    while (node != 0)
+    {
+        const Node &curr = this->nodes[node];
+        if (key_less(value, curr.data))
+        {
+            dir = LEFT;
+            node = curr.left;
+        }
+        else if (key_less(curr.data, value))
+        {
+            dir = RIGHT;
+            node = curr.right;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (node == 0)
+    {
+        return;
+    }
+    if (this->nodes[node].count > 1)
+    {
+        this->nodes[node].count--;
+        return;
+    }
+
+    if (this->nodes[node].left != 0 && this->nodes[node].right != 0)
+    {
+        std::uint32_t replacement = this->nodes[node].right;
+        dir = RIGHT;
+        while (this->nodes[replacement].left != 0)
+        {
+            replacement = this->nodes[replacement].left;
+            dir = LEFT;
+        }
+        std::swap(this->nodes[node].data, this->nodes[replacement].data);
+        std::swap(this->nodes[node].count, this->nodes[replacement].count);
+        node = replacement;
+    }
+
+    std::uint32_t up = this->parent(node);
+    std::uint32_t child = this->nodes[node].left != 0
+                              ? this->nodes[node].left
+                              : this->nodes[node].right;
+    BHVNeighborhood nb(*this, child == 0 ? node : 0, dir);
+    if (child != 0)
+    {
+        // A lone child is RED under a BLACK node, and takes its place
+        this->set_color(child, this->color(node));
+    }
+    if (dir == ROOT)
+    {
+        this->root = child;
+        if (child != 0)
+        {
+            this->set_parent(child, 0);
+        }
+    }
+    else
+    {
+        this->set_child(up, dir, child);
+    }
+
+    this->fix_blackheight_imbalance(nb);
+    this->release(node);
+    this->set_color(this->root, BLACK);
+}
+
+template <typename Key, typename Compare>
+int IndexedTree<Key, Compare>::tree_height() const
+{
+    return this->subtree_height(this->root);
+}
+
+template <typename Key, typename Compare>
+int IndexedTree<Key, Compare>::node_count() const
+{
+    return (int)(this->nodes.size() - 1);
+}
+
+template <typename Key, typename Compare>
+int IndexedTree<Key, Compare>::count_total() const
+{
+    int total = 0;
+    for (std::size_t i = 1; i < this->nodes.size(); i++)
+    {
+        total += this->nodes[i].count;
+    }
+    return total;
+}
+
+/*
+ * Parameters: IndexedTree this - the tree
+ *             F visit - the function to call on each key and its count
+ * Returns: N/A
+ * Purpose: the next node is the leftmost of the right subtree if there is
+ *      one, or else the first ancestor reached from its left.
+ */
+template <typename Key, typename Compare>
+template <typename F>
+void IndexedTree<Key, Compare>::for_each(F visit) const
+{
+    std::uint32_t node = this->root;
+    if (node == 0)
+    {
+        return;
+    }
+    while (this->nodes[node].left != 0)
+    {
+        node = this->nodes[node].left;
+    }
+    while (node != 0)
+    {
+        visit(this->nodes[node].data, this->nodes[node].count);
+        if (this->nodes[node].right != 0)
+        {
+            node = this->nodes[node].right;
+            while (this->nodes[node].left != 0)
+            {
+                node = this->nodes[node].left;
+            }
+        }
+        else
+        {
+            std::uint32_t up = this->parent(node);
+            while (up != 0 && this->nodes[up].right == node)
+            {
+                node = up;
+                up = this->parent(up);
+            }
+            node = up;
+        }
+    }
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::write(std::ostream &out) const
+{
+    std::uint32_t size = (std::uint32_t)this->nodes.size();
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char *>(&this->root), sizeof(this->root));
+    out.write(reinterpret_cast<const char *>(this->nodes.data()),
+              size * sizeof(Node));
+}
+
+/*
+ * Parameters: IndexedTree this - the tree to replace
+ *             istream in - a stream positioned at the output of write()
+ * Returns: true iff a well-formed tree was read
+ * Purpose: the size in the header is only a promise, so the vector grows a
+ *      chunk at a time as nodes actually arrive; a short or corrupt stream
+ *      fails the read rather than an allocation.
+ */
+template <typename Key, typename Compare>
+bool IndexedTree<Key, Compare>::read(std::istream &in)
+{
+    this->nodes.assign(1, Node());
+    this->root = 0;
+
+    std::uint32_t size = 0;
+    std::uint32_t root = 0;
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    in.read(reinterpret_cast<char *>(&root), sizeof(root));
+    if (!in || size == 0 || size > MAX_NODES + 1)
+    {
+        return false;
+    }
+
+    std::vector<Node> image;
+    while (image.size() < size)
+    {
+        std::size_t have = image.size();
+        image.resize(std::min<std::size_t>(size, have + READ_CHUNK));
+        in.read(reinterpret_cast<char *>(image.data() + have),
+                (image.size() - have) * sizeof(Node));
+        if (!in)
+        {
+            return false;
+        }
+    }
+
+    if (!is_valid(image, root))
+    {
+        return false;
+    }
+    this->nodes.swap(image);
+    this->root = root;
+    return true;
+}
+
+/*************************************
+ * BEGIN PRIVATE INDEXEDTREE SECTION *
+ *************************************/
+
+template <typename Key, typename Compare>
+std::uint32_t IndexedTree<Key, Compare>::parent(std::uint32_t node) const
+{
+    return this->nodes[node].parent_meta >> 1;
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::set_parent(std::uint32_t node,
+                                           std::uint32_t parent)
+{
+    assert(node != 0);
+    Node &curr = this->nodes[node];
+    curr.parent_meta = (parent << 1) | (curr.parent_meta & COLOR_BIT);
+}
+
+template <typename Key, typename Compare>
+typename IndexedTree<Key, Compare>::Color
+IndexedTree<Key, Compare>::color(std::uint32_t node) const
+{
+    return (this->nodes[node].parent_meta & COLOR_BIT) ? RED : BLACK;
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::set_color(std::uint32_t node, Color color)
+{
+    assert(node != 0 || color == BLACK);
+    if (color == RED)
+    {
+        this->nodes[node].parent_meta |= COLOR_BIT;
+    }
+    else if (this->nodes[node].parent_meta & COLOR_BIT)
+    {
+        this->nodes[node].parent_meta &= ~COLOR_BIT;
+    }
+}
+
+template <typename Key, typename Compare>
+std::uint32_t IndexedTree<Key, Compare>::child(std::uint32_t node,
+                                               Direction dir) const
+{
+    return dir == LEFT ? this->nodes[node].left : this->nodes[node].right;
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::set_child(std::uint32_t node, Direction dir,
+                                          std::uint32_t child)
+{
+    assert(node != 0 && dir != ROOT);
+    if (dir == LEFT)
+    {
+        this->nodes[node].left = child;
+    }
+    else
+    {
+        this->nodes[node].right = child;
+    }
+    if (child != 0)
+    {
+        this->set_parent(child, node);
+    }
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::swap_colors(std::uint32_t a, std::uint32_t b)
+{
+    Color color = this->color(a);
+    this->set_color(a, this->color(b));
+    this->set_color(b, color);
+}
+
+template <typename Key, typename Compare>
+bool IndexedTree<Key, Compare>::key_less(const Key &a, const Key &b)
+{
+    return Compare()(a, b);
+}
+
+template <typename Key, typename Compare>
+typename IndexedTree<Key, Compare>::Direction
+IndexedTree<Key, Compare>::opposite_direction(Direction dir)
+{
+    return dir == LEFT ? RIGHT : dir == RIGHT ? LEFT : ROOT;
+}
+
+template <typename Key, typename Compare>
+typename IndexedTree<Key, Compare>::Direction
+IndexedTree<Key, Compare>::direction_of(std::uint32_t node) const
+{
+    std::uint32_t up = this->parent(node);
+    if (up == 0)
+    {
+        return ROOT;
+    }
+    return this->nodes[up].left == node ? LEFT : RIGHT;
+}
+
+template <typename Key, typename Compare>
+IndexedTree<Key, Compare>::RRVNeighborhood::RRVNeighborhood(
+    const IndexedTree &tree, std::uint32_t g)
+    : g(g), p(0), x(0), y(0), shape(SHAPE_NONE)
+{
+    if (g == 0 || tree.color(g) != BLACK)
+    {
+        return;
+    }
+    std::uint32_t lc = tree.nodes[g].left;
+    std::uint32_t rc = tree.nodes[g].right;
+
+    if (tree.color(lc) == BLACK || tree.color(rc) == BLACK)
+    {
+        // If there is a red-red violation, it is below the RED child
+        bool left = tree.color(lc) == RED;
+        this->p = left ? lc : rc;
+        this->y = left ? rc : lc;
+        if (tree.color(this->p) != RED)
+        {
+            return;
+        }
+        if (tree.color(tree.nodes[this->p].left) == RED)
+        {
+            this->shape = left ? LL : RL;
+            this->x = tree.nodes[this->p].left;
+        }
+        else if (tree.color(tree.nodes[this->p].right) == RED)
+        {
+            this->shape = left ? LR : RR;
+            this->x = tree.nodes[this->p].right;
+        }
+        return;
+    }
+
+    // Both children of g are RED. Find the one red-red violation
+    struct Candidate
+    {
+        std::uint32_t p;
+        std::uint32_t x;
+        std::uint32_t y;
+        Shape shape;
+    };
+    const Candidate candidates[] = {
+        {lc, tree.nodes[lc].left, rc, LL},
+        {lc, tree.nodes[lc].right, rc, LR},
+        {rc, tree.nodes[rc].left, lc, RL},
+        {rc, tree.nodes[rc].right, lc, RR},
+    };
+    int violations = 0;
+    for (const Candidate &candidate : candidates)
+    {
+        if (tree.color(candidate.x) == RED)
+        {
+            this->p = candidate.p;
+            this->x = candidate.x;
+            this->y = candidate.y;
+            this->shape = candidate.shape;
+            violations++;
+        }
+    }
+    if (violations != 1)
+    {
+        this->shape = SHAPE_NONE;
+    }
+}
+
+template <typename Key, typename Compare>
+IndexedTree<Key, Compare>::BHVNeighborhood::BHVNeighborhood(
+    const IndexedTree &tree, std::uint32_t n, Direction dir)
+    : n(n), p(0), s(0), c(0), d(0), del_case(CASE_NONE), dir(dir)
+{
+    if (n == 0 || tree.color(n) != BLACK)
+    {
+        return;
+    }
+    this->p = tree.parent(n);
+    if (this->p == 0)
+    {
+        this->del_case = CASE_1;
+        this->dir = ROOT;
+    }
+    else
+    {
+        this->find_case(tree);
+    }
+}
+
+/*
+ * Parameters: Neighborhood this - a neighborhood with p and dir set
+ *             IndexedTree tree - the tree
+ * Returns: N/A
+ * Purpose: the cases of BSTNode::BHVNeighborhood::find_case. The children
+ *      of an empty sibling are the nil sentinel too, which is BLACK, so no
+ *      link needs checking before its color is read.
+ */
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::BHVNeighborhood::find_case(
+    const IndexedTree &tree)
+{
+    assert(this->p != 0 && this->dir != ROOT);
+    this->s = tree.child(this->p, opposite_direction(this->dir));
+    this->c = tree.child(this->s, this->dir);
+    this->d = tree.child(this->s, opposite_direction(this->dir));
+
+    Color p_color = tree.color(this->p);
+    Color s_color = tree.color(this->s);
+    Color c_color = tree.color(this->c);
+    Color d_color = tree.color(this->d);
+    if (p_color == BLACK && s_color == BLACK && c_color == BLACK &&
+        d_color == BLACK)
+    {
+        this->del_case = CASE_2;
+    }
+    else if (p_color == BLACK && s_color == RED)
+    {
+        this->del_case = CASE_3;
+    }
+    else if (p_color == RED && s_color == BLACK && c_color == BLACK &&
+             d_color == BLACK)
+    {
+        this->del_case = CASE_4;
+    }
+    else if (s_color == BLACK && c_color == RED && d_color == BLACK)
+    {
+        this->del_case = CASE_5;
+    }
+    else if (s_color == BLACK && d_color == RED)
+    {
+        this->del_case = CASE_6;
+    }
+    else
+    {
+        this->del_case = CASE_NONE;
+    }
+}
+
+template <typename Key, typename Compare>
+std::uint32_t IndexedTree<Key, Compare>::dir_rotate(std::uint32_t node,
+                                                    Direction dir)
+{
+    if (dir == LEFT)
+    {
+        return this->left_rotate(node);
+    }
+    if (dir == RIGHT)
+    {
+        return this->right_rotate(node);
+    }
+    return node;
+}
+
+/*
+ * Parameters: IndexedTree this - the tree
+ *             Node node - the index of the root of a subtree
+ * Returns: the index of the root of the rotated subtree
+ * Purpose: the same three links change as in BSTNode::right_rotate, each
+ *      an index written into one node of the vector.
+ */
+template <typename Key, typename Compare>
+std::uint32_t IndexedTree<Key, Compare>::right_rotate(std::uint32_t node)
+{
+    std::uint32_t newroot = this->nodes[node].left;
+    std::uint32_t up = this->parent(node);
+    Direction dir = this->direction_of(node);
+
+    std::uint32_t moved = this->nodes[newroot].right;
+    this->nodes[node].left = moved;
+    if (moved != 0)
+    {
+        this->set_parent(moved, node);
+    }
+    this->set_child(newroot, RIGHT, node);
+    this->set_parent(newroot, up);
+    if (dir == ROOT)
+    {
+        this->root = newroot;
+    }
+    else
+    {
+        this->set_child(up, dir, newroot);
+    }
+    return newroot;
+}
+
+template <typename Key, typename Compare>
+std::uint32_t IndexedTree<Key, Compare>::left_rotate(std::uint32_t node)
+{
+    std::uint32_t newroot = this->nodes[node].right;
+    std::uint32_t up = this->parent(node);
+    Direction dir = this->direction_of(node);
+
+    std::uint32_t moved = this->nodes[newroot].left;
+    this->nodes[node].right = moved;
+    if (moved != 0)
+    {
+        this->set_parent(moved, node);
+    }
+    this->set_child(newroot, LEFT, node);
+    this->set_parent(newroot, up);
+    if (dir == ROOT)
+    {
+        this->root = newroot;
+    }
+    else
+    {
+        this->set_child(up, dir, newroot);
+    }
+    return newroot;
+}
+
+template <typename Key, typename Compare>
+std::uint32_t
+IndexedTree<Key, Compare>::eliminate_red_red_violation(std::uint32_t node)
+{
+    RRVNeighborhood nb(*this, node);
+    if (nb.shape == SHAPE_NONE)
+    {
+        return node;
+    }
+    if (this->color(nb.y) == RED)
+    {
+        this->set_color(nb.g, RED);
+        this->set_color(nb.y, BLACK);
+        this->set_color(nb.p, BLACK);
+        return node;
+    }
+
+    switch (nb.shape)
+    {
+    case LL:
+        this->right_rotate(nb.g);
+        this->swap_colors(nb.g, nb.p);
+        return nb.p;
+    case RR:
+        this->left_rotate(nb.g);
+        this->swap_colors(nb.g, nb.p);
+        return nb.p;
+    case LR:
+        this->left_rotate(nb.p);
+        this->right_rotate(nb.g);
+        this->swap_colors(nb.g, nb.x);
+        return nb.x;
+    default:
+        this->right_rotate(nb.p);
+        this->left_rotate(nb.g);
+        this->swap_colors(nb.g, nb.x);
+        return nb.x;
+    }
+}
+
+/*
+ * Parameters: IndexedTree this - the tree
+ *             BHVNeighborhood nb - the neighborhood of the unlinked leaf
+ * Returns: N/A
+ * Purpose: the loop of BSTNode::BHVNeighborhood::fix_blackheight_imbalance.
+ *      The rotations here relink the grandparent themselves, so the cases
+ *      that rotate at p need not.
+ */
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::fix_blackheight_imbalance(BHVNeighborhood nb)
+{
+    while (nb.p != 0)
+    {
+        switch (nb.del_case)
+        {
+        case CASE_2:
+            this->set_color(nb.s, RED);
+            nb = BHVNeighborhood(*this, nb.p, this->direction_of(nb.p));
+            break;
+        case CASE_3:
+            nb.s = this->dir_rotate(nb.p, nb.dir);
+            this->swap_colors(nb.p, nb.s);
+            nb.find_case(*this);
+            assert(nb.del_case >= CASE_4);
+            break;
+        case CASE_4:
+            this->swap_colors(nb.p, nb.s);
+            return;
+        case CASE_5:
+            this->dir_rotate(nb.s, opposite_direction(nb.dir));
+            this->swap_colors(nb.c, nb.s);
+            nb.find_case(*this);
+            assert(nb.del_case == CASE_6);
+            break;
+        case CASE_6:
+            nb.s = this->dir_rotate(nb.p, nb.dir);
+            this->swap_colors(nb.p, nb.s);
+            this->set_color(nb.d, BLACK);
+            return;
+        default:
+            // CASE_NONE or CASE_1 (should never happen; nb.p is not nil)
+            assert(false);
+            return;
+        }
+    }
+}
+
+template <typename Key, typename Compare>
+void IndexedTree<Key, Compare>::release(std::uint32_t hole)
+{
+    std::uint32_t last = (std::uint32_t)(this->nodes.size() - 1);
+    if (hole != last)
+    {
+        this->nodes[hole] = this->nodes[last];
+        Direction dir = this->direction_of(last);
+        if (dir == ROOT)
+        {
+            this->root = hole;
+        }
+        else
+        {
+            this->set_child(this->parent(hole), dir, hole);
+        }
+        for (std::uint32_t child : {this->nodes[hole].left,
+                                    this->nodes[hole].right})
+        {
+            if (child != 0)
+            {
+                this->set_parent(child, hole);
+            }
+        }
+    }
+    this->nodes.pop_back();
+}
+
+template <typename Key, typename Compare>
+int IndexedTree<Key, Compare>::subtree_height(std::uint32_t node) const
+{
+    if (node == 0)
+    {
+        return -1;
+    }
+    return 1 + std::max(this->subtree_height(this->nodes[node].left),
+                        this->subtree_height(this->nodes[node].right));
+}
+
+/*
+ * Parameters: vector<Node> image - a node vector read from a stream
+ *             Node root - the index of its root
+ * Returns: true iff image is one Red-Black Tree rooted at root
+ * Purpose: each pending node carries the nodes whose keys bound it and the
+ *      number of BLACK nodes above it, so one pass checks the order, the
+ *      links both ways and the colors. Every node names one parent, and
+ *      the root none, so a walk down the links can only reach each node
+ *      once; if it reaches them all, there is nothing else in the image.
+ */
+template <typename Key, typename Compare>
+bool IndexedTree<Key, Compare>::is_valid(const std::vector<Node> &image,
+                                         std::uint32_t root)
+{
+    std::uint32_t size = (std::uint32_t)image.size();
+    const Node &nil = image[0];
+    if (root >= size || nil.count != 0 || nil.left != 0 || nil.right != 0 ||
+        nil.parent_meta != 0 || (root == 0) != (size == 1))
+    {
+        return false;
+    }
+    if (root == 0)
+    {
+        return true;
+    }
+    if (image[root].parent_meta != 0)
+    {
+        // The root has no parent, and is BLACK
+        return false;
+    }
+
+    struct Pending
+    {
+        std::uint32_t node;
+        std::uint32_t lo;
+        std::uint32_t hi;
+        int blacks;
+    };
+
+    std::vector<Pending> stack(1, {root, 0, 0, 0});
+    std::uint32_t visited = 0;
+    int black_height = -1;
+    while (!stack.empty())
+    {
+        Pending next = stack.back();
+        stack.pop_back();
+        if (next.node == 0)
+        {
+            if (black_height == -1)
+            {
+                black_height = next.blacks;
+            }
+            if (next.blacks != black_height)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const Node &node = image[next.node];
+        bool red = node.parent_meta & COLOR_BIT;
+        if (++visited >= size || node.count <= 0 ||
+            (next.lo != 0 && !key_less(image[next.lo].data, node.data)) ||
+            (next.hi != 0 && !key_less(node.data, image[next.hi].data)))
+        {
+            return false;
+        }
+        for (std::uint32_t child : {node.left, node.right})
+        {
+            if (child >= size ||
+                (child != 0 &&
+                 ((image[child].parent_meta >> 1) != next.node ||
+                  (red && (image[child].parent_meta & COLOR_BIT)))))
+            {
+                return false;
+            }
+        }
+        int blacks = next.blacks + (red ? 0 : 1);
+        stack.push_back({node.right, next.node, next.hi, blacks});
+        stack.push_back({node.left, next.lo, next.node, blacks});
+    }
+    return visited == size - 1;
+}
@@ -0,0 +1,205 @@
+/*
+ * Filename: NodePool.cpp
+ * Contains: Implementation of the slab allocator that owns the nodes of a
+ *      tree
+ */
+
+#include "NodePool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <new>
+
+using namespace std;
+
+/*
+ * Chunks start small so that tiny trees stay tiny, and double in size up to
+ *  a cap so that large trees are carved from a handful of big allocations.
+ */
+static const size_t FIRST_CHUNK_SLOTS = 32;
+static const size_t MAX_CHUNK_SLOTS = 4096;
+
+/*
+ * The pool made current on this thread by the innermost NodePool::Scope.
+ */
+static thread_local NodePool *current_pool = nullptr;
+
+/*
+ * Parameters: shared_ptr a, b - two chunks
+ * Returns: true iff a is at a lower address than b
+ */
+static bool chunk_before(const shared_ptr<char> &a, const shared_ptr<char> &b)
+{
+    return less<char *>()(a.get(), b.get());
+}
+
+/*
+ * Parameters: size_t size - the requested slot size
+ *             size_t align - the requested slot alignment
+ * Returns: size rounded up so that every slot can hold a free-list link and
+ *      every slot in a chunk is aligned to align
+ */
+static size_t round_slot_size(size_t size, size_t align)
+{
+    if (size < sizeof(void *))
+    {
+        size = sizeof(void *);
+    }
+    return (size + align - 1) / align * align;
+}
+
+/*
+ * Slots are never aligned more loosely than a pointer, since a free slot
+ *  holds one.
+ */
+NodePool::NodePool(size_t slot_size, size_t slot_align)
+    : slot_bytes(round_slot_size(slot_size, max(slot_align, alignof(void *)))),
+      slot_alignment(max(slot_align, alignof(void *))), chunks(),
+      next_slot(nullptr), chunk_end(nullptr),
+      next_chunk_slots(FIRST_CHUNK_SLOTS), free_list(nullptr) {}
+
+NodePool::~NodePool()
+{
+    this->release();
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ * Returns: a pointer to an uninitialized slot of slot_size() bytes
+ * Purpose: pops the free list, or carves the next slot from the current
+ *      chunk, allocating a new (larger) chunk when it is full
+ */
+void *NodePool::allocate()
+{
+    if (this->free_list)
+    {
+        FreeSlot *slot = this->free_list;
+        this->free_list = slot->next;
+        return slot;
+    }
+
+    if (this->next_slot == this->chunk_end)
+    {
+        size_t bytes = this->next_chunk_slots * this->slot_bytes;
+        char *chunk = this->add_chunk(bytes);
+        this->next_slot = chunk;
+        this->chunk_end = chunk + bytes;
+        if (this->next_chunk_slots < MAX_CHUNK_SLOTS)
+        {
+            this->next_chunk_slots *= 2;
+        }
+    }
+
+    void *slot = this->next_slot;
+    this->next_slot += this->slot_bytes;
+    return slot;
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ *             size_t count - the number of slots wanted
+ * Returns: a pointer to count uninitialized slots, one after the other
+ * Purpose: the block gets a chunk of its own, however big, so that a whole
+ *      tree can be laid out in one allocation; the pool keeps carving from
+ *      the chunk it was carving before
+ */
+void *NodePool::allocate_block(size_t count)
+{
+    assert(count > 0);
+    return this->add_chunk(count * this->slot_bytes);
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ *             size_t bytes - the size of the chunk, a multiple of the slot
+ *                  size
+ * Returns: the new chunk
+ * Purpose: allocates a chunk owned by this, keeping the chunks ordered by
+ *      address
+ */
+char *NodePool::add_chunk(size_t bytes)
+{
+    char *chunk = static_cast<char *>(
+        ::operator new(bytes, align_val_t(this->slot_alignment)));
+    shared_ptr<char> owned(chunk, ChunkDeleter{this->slot_alignment});
+    this->chunks.insert(upper_bound(this->chunks.begin(), this->chunks.end(),
+                                    owned, chunk_before),
+                        owned);
+    return chunk;
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ *             void *slot - a slot previously returned by allocate() or
+ *                  allocate_block()
+ * Returns: N/A
+ * Purpose: pushes slot onto the free list so it can be reused
+ */
+void NodePool::deallocate(void *slot)
+{
+    FreeSlot *freed = static_cast<FreeSlot *>(slot);
+    freed->next = this->free_list;
+    this->free_list = freed;
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ * Returns: N/A
+ * Purpose: lets go of every chunk in one pass; the chunks no other pool
+ *      shares are freed. No destructors are run.
+ */
+void NodePool::release()
+{
+    this->chunks.clear();
+    this->next_slot = nullptr;
+    this->chunk_end = nullptr;
+    this->next_chunk_slots = FIRST_CHUNK_SLOTS;
+    this->free_list = nullptr;
+}
+
+/*
+ * Parameters: NodePool this - the pool
+ *             NodePool other - the pool whose chunks to share
+ * Returns: N/A
+ * Purpose: both lists of chunks are ordered by address, so they are merged
+ *      in one pass, keeping one copy of each chunk. Only other's chunks are
+ *      shared: its free list and the rest of the chunk it is carving stay
+ *      with it, and this keeps carving from its own.
+ */
+void NodePool::share_chunks(const NodePool &other)
+{
+    assert(this->slot_bytes == other.slot_bytes &&
+           this->slot_alignment == other.slot_alignment);
+    vector<shared_ptr<char>> merged;
+    merged.reserve(this->chunks.size() + other.chunks.size());
+    set_union(this->chunks.begin(), this->chunks.end(), other.chunks.begin(),
+              other.chunks.end(), back_inserter(merged), chunk_before);
+    this->chunks.swap(merged);
+}
+
+size_t NodePool::slot_size() const
+{
+    return this->slot_bytes;
+}
+
+void NodePool::ChunkDeleter::operator()(char *chunk) const
+{
+    ::operator delete(chunk, align_val_t(this->alignment));
+}
+
+NodePool *NodePool::current()
+{
+    return current_pool;
+}
+
+NodePool::Scope::Scope(NodePool &pool) : previous(current_pool)
+{
+    current_pool = &pool;
+}
+
+NodePool::Scope::~Scope()
+{
+    current_pool = this->previous;
+}
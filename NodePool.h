@@ -0,0 +1,160 @@
+/*
+ * Filename: NodePool.h
+ * Contains: Interface of the slab allocator that owns the nodes of a tree
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Node Pool:
+ *    - hands out fixed-size slots carved from contiguous chunks, so that
+ *      the nodes of one tree sit next to each other in memory
+ *    - freed slots are kept on an intrusive free list and reused before a
+ *      new chunk is carved
+ *    - release() returns every chunk at once; the objects living in the
+ *      slots are NOT destroyed, so only trivially-droppable objects (such as
+ *      BSTNodes, which own nothing but other nodes of the same pool) may be
+ *      stored here
+ *    - pools may share chunks (see share_chunks), so that the nodes of one
+ *      tree can be handed to another without being copied; a chunk is
+ *      freed by the last pool to let go of it
+ *
+ * A pool is made "current" for the calling thread with a NodePool::Scope.
+ *  While a scope is active, `new BSTNode(...)` and `delete node` allocate
+ *  from and return to that pool instead of the global heap.
+ */
+class NodePool
+{
+public:
+    /**
+     * Input: size_t slot_size - the size of each slot handed out
+     *        size_t slot_align - the alignment of each slot handed out; a
+     *            power of two
+     * Returns: a new pool with no chunks
+     */
+    explicit NodePool(std::size_t slot_size,
+                      std::size_t slot_align = alignof(void *));
+
+    /**
+     * Destructor. Releases every chunk owned by this.
+     */
+    ~NodePool();
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    /**
+     * Input: NodePool this - the pool
+     * Returns: a pointer to an uninitialized slot of slot_size() bytes
+     * Does: pops the free list, or carves the next slot from the current
+     *      chunk, allocating a new (larger) chunk when it is full
+     */
+    void *allocate();
+
+    /**
+     * Input: NodePool this - the pool
+     *        size_t count - the number of slots wanted; at least one
+     * Returns: a pointer to count uninitialized slots, one after the other
+     * Does: allocates a chunk of exactly count slots for them alone; the
+     *      chunk being carved and the free list are left as they are, and
+     *      each of the slots may later be deallocated on its own
+     */
+    void *allocate_block(std::size_t count);
+
+    /**
+     * Input: NodePool this - the pool
+     *        void *slot - a slot previously returned by allocate() or
+     *            allocate_block()
+     * Returns: N/A
+     * Does: pushes slot onto the free list so it can be reused
+     */
+    void deallocate(void *slot);
+
+    /**
+     * Input: NodePool this - the pool
+     * Returns: N/A
+     * Does: lets go of every chunk in one pass, freeing those that no other
+     *      pool shares and invalidating the slots handed out from them. No
+     *      destructors are run.
+     */
+    void release();
+
+    /**
+     * Input: NodePool this - the pool
+     *        NodePool other - a pool with the same slot size and alignment
+     * Returns: N/A
+     * Does: makes this a co-owner of every chunk of other, so that the slots
+     *      other has handed out stay valid for as long as this lives, and may
+     *      be deallocated to this. Chunks this already owns are skipped.
+     *      Runtime: O(number of chunks of both)
+     */
+    void share_chunks(const NodePool &other);
+
+    /**
+     * Input: NodePool this - the pool
+     * Returns: the size of each slot handed out by this
+     */
+    std::size_t slot_size() const;
+
+    /**
+     * Input: N/A
+     * Returns: the pool made current on this thread by the innermost active
+     *      Scope, or nullptr if there is none
+     */
+    static NodePool *current();
+
+    /**
+     * RAII guard that makes a pool current for the calling thread, and
+     *  restores the previously current pool when it goes out of scope.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(NodePool &pool);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        NodePool *previous;
+    };
+
+private:
+    /**
+     * A freed slot; its first bytes are reused to link the free list.
+     */
+    struct FreeSlot
+    {
+        FreeSlot *next;
+    };
+
+    /**
+     * Frees a chunk once the last pool that shares it lets go of it.
+     */
+    struct ChunkDeleter
+    {
+        std::size_t alignment;
+        void operator()(char *chunk) const;
+    };
+
+    /**
+     * Input: NodePool this - the pool
+     *        size_t bytes - the size of the chunk
+     * Returns: a new chunk of bytes bytes, owned by this
+     */
+    char *add_chunk(std::size_t bytes);
+
+    std::size_t slot_bytes;
+    std::size_t slot_alignment;
+    // Ordered by address, so that sharing can skip chunks already owned
+    std::vector<std::shared_ptr<char>> chunks;
+    char *next_slot;
+    char *chunk_end;
+    std::size_t next_chunk_slots;
+    FreeSlot *free_list;
+};
@@ -0,0 +1,539 @@
+/*
+ * Filename: OrderedTree.h
+ * Contains: Interface of Ordered Trees, the binary search trees behind
+ *      BSTree, AVLTree and RBTree
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+#include "BSTNode.h"
+#include "ForkJoinPool.h"
+#include "FrozenTree.h"
+#include "NodePool.h"
+#include "PackedTree.h"
+
+/**
+ * Keys are ordered by Compare. Each distinct key has one node, which also
+ *  holds a Value constructed when the key is first inserted (no storage at
+ *  all for the default NoValue).
+ *
+ * Sum is KeySum for a tree that keeps the sum of the keys in every subtree,
+ *  which sum_in_range needs. It costs a word in every node, so the default
+ *  NoSum keeps none.
+ *
+ * BalancePolicy (see BalancePolicy.h) decides how the tree is kept balanced.
+ *  Its steps are called from the one insertion and removal descent in
+ *  BSTNode, and are resolved at compile time, so each policy gets a copy of
+ *  that descent with its rebalancing inlined and nothing is dispatched at
+ *  run time.
+ */
+template <typename BalancePolicy, typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>, typename Sum = NoSum>
+class OrderedTree
+{
+private:
+    typedef BSTNode<Key, Value, Compare, Sum> Node;
+
+    /**
+     * The slab allocator that owns every node of this tree.
+     */
+    NodePool pool;
+
+    /**
+     * The root of this tree.
+     */
+    Node *root;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        size_t batch - the number of keys in a batch
+     * Returns: true iff the batch should be merged into this by rebuilding
+     *      it, rather than applied one key at a time
+     */
+    bool merges_batch(std::size_t batch) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        OrderedTree other - another tree
+     * Returns: the root of other, whose nodes now belong to this
+     * Does: makes this a co-owner of the chunks of other's pool, then
+     *      leaves other empty
+     */
+    Node *take_nodes(OrderedTree &other);
+
+    /**
+     * Input: OrderedTree this - an empty tree
+     *        OrderedTree source - the tree to copy
+     * Returns: N/A
+     * Does: makes this a deep copy of source, laid out in pre-order in one
+     *      block of this's pool, with big subtrees copied in parallel
+     */
+    void copy_nodes(const OrderedTree &source);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        SetOperation op - the operation to apply
+     *        OrderedTree other - the other tree
+     * Returns: N/A
+     * Does: replaces this with the result of BSTNode::combine on this and
+     *      other, run on ForkJoinPool::shared(), leaves other empty, and
+     *      deletes the nodes that are in neither
+     */
+    void combine_with(typename Node::SetOperation op, OrderedTree &other);
+
+public:
+    /**
+     * The keys, and the order they are kept in, for wrappers that need to
+     *  order keys as this does.
+     */
+    typedef Key key_type;
+    typedef Compare key_compare;
+
+    /**
+     * The type of sum_in_range: a 64-bit integer for integral keys, or a
+     *  double for floating-point ones.
+     */
+    typedef typename Node::sum_type sum_type;
+
+    /**
+     * In-order iterator over the distinct keys of an OrderedTree. Each node is
+     *  visited once, and count() tells how many times its key occurs. Steps
+     *  follow the parent pointers, so iterating takes no extra memory, and
+     *  end() can be decremented to reach the maximum.
+     *
+     * Insertions leave iterators valid. A removal that deletes a node
+     *  invalidates iterators to the removed key and to the key after it,
+     *  whose entry may move into the removed key's node.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Key value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Key *pointer;
+        typedef const Key &reference;
+
+        /**
+         * Default constructor. Creates an iterator into no tree, which may
+         *  only be assigned to.
+         */
+        const_iterator();
+
+        /**
+         * Input: const_iterator this - an iterator before end()
+         * Returns: the key this is at
+         */
+        reference operator*() const;
+        pointer operator->() const;
+
+        /**
+         * Input: const_iterator this - an iterator before end()
+         * Returns: the number of occurrences of the key this is at
+         */
+        unsigned int count() const;
+
+        /**
+         * Input: const_iterator this - an iterator before end()
+         * Returns: the payload stored with the key this is at
+         */
+        const Value &value() const;
+
+        /**
+         * Input: const_iterator this - an iterator before end() (for ++) or
+         *      after begin() (for --)
+         * Returns: this (or, for the postfix forms, a copy of this from
+         *      before the step)
+         * Does: moves this to the next or previous key in order. Runtime:
+         *      O(1) amortized
+         */
+        const_iterator &operator++();
+        const_iterator operator++(int);
+        const_iterator &operator--();
+        const_iterator operator--(int);
+
+        /**
+         * Input: const_iterator this, other - iterators into the same tree
+         * Returns: whether this and other are at the same key
+         */
+        bool operator==(const const_iterator &other) const;
+        bool operator!=(const const_iterator &other) const;
+
+    private:
+        friend class OrderedTree;
+
+        const_iterator(const Node *node, Node *const *root);
+
+        /**
+         * The node this is at, or the nil sentinel at end()
+         */
+        const Node *node;
+
+        /**
+         * The root of the tree, which rotations may change, for stepping
+         *  back from end()
+         */
+        Node *const *root;
+    };
+
+    /**
+     * Keys cannot be changed in place, so there is no mutable iterator.
+     */
+    typedef const_iterator iterator;
+
+    /**
+     * Default constructor. Creates an empty tree.
+     */
+    OrderedTree();
+
+    /**
+     * Copy constructor. Creates a new tree as a deep copy of source, laid
+     *  out in one block, copying big subtrees on the shared ForkJoinPool
+     */
+    OrderedTree(const OrderedTree &source);
+
+    /**
+     * Destructor. Frees all memory owned by this. Keys and payloads that
+     *  need destroying are destroyed on the shared ForkJoinPool.
+     */
+    ~OrderedTree();
+
+    /**
+     * Assignment overload. Assigns rhs to this by deep copy, as the copy
+     *  constructor does.
+     */
+    OrderedTree &operator=(const OrderedTree &rhs);
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: the minimum value in this
+     * Does: Searches this for its minimum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &minimum_value() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: the maximum value in this
+     * Does: Searches this for its maximum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &maximum_value() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches the tree for value
+     */
+    unsigned int count_of(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - value to search for
+     * Returns: a pointer to the payload stored with value, or nullptr if value
+     *      is not in this
+     * Does: searches the tree for value. The pointer is good until value's
+     *      node is removed.
+     */
+    Value *value_of(const Key &value);
+    const Value *value_of(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - value to insert
+     *        Args args - the arguments to construct value's payload with
+     * Returns: N/A
+     * Does: Inserts value into this, either by creating a new node or, if
+     *      value is already in this, by incrementing that node's count. A
+     *      new node's key is moved from value if it is an rvalue, and its
+     *      payload is built in place from args; neither is touched if value
+     *      is already in this.
+     */
+    template <typename K, typename... Args>
+    void insert(K &&value, Args &&...args);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        ForwardIt first, last - a range of values sorted by Compare,
+     *              possibly with duplicates
+     * Returns: N/A
+     * Does: replaces the contents of this with the values of the range,
+     *      building a perfectly balanced tree directly, with no rotations.
+     *      Runs of equal values become one node with their count.
+     *      Runtime: O(n)
+     * Assumes: the range is sorted; if it is not, this is not a search tree
+     */
+    template <typename ForwardIt>
+    void assign_sorted(ForwardIt first, ForwardIt last);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        InputIt first, last - a batch of values, in any order, possibly
+     *              with duplicates
+     * Returns: N/A
+     * Does: inserts every value of the batch, as insert would. The batch is
+     *      sorted first. A batch that is large next to this is merged with
+     *      this in one in-order pass that rebuilds it perfectly balanced,
+     *      so the tree is rebalanced once for the whole batch; a small one
+     *      is inserted in order, one value at a time. Runtime:
+     *      O(m log m + min(n + m, m log n)) for m values
+     */
+    template <typename InputIt>
+    void insert_batch(InputIt first, InputIt last);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        InputIt first, last - a batch of values, in any order, possibly
+     *              with duplicates
+     * Returns: N/A
+     * Does: removes every value of the batch, as remove would, choosing
+     *      between one rebuilding pass and removing one value at a time as
+     *      insert_batch does.
+     */
+    template <typename InputIt>
+    void remove_batch(InputIt first, InputIt last);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the value to remove
+     * Returns: N/A
+     * Does: Removes value from the tree. If a node's count is greater than
+     *      1, the count is decremented and the node is not removed. Nodes
+     *      with a count of 1 are removed according to the algorithm
+     *      discussed in class, with arbitrary decisions made in the same way
+     *      as the reference implementation.
+     */
+    void remove(const Key &value);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - a value ordered after every value in this
+     *        OrderedTree greater - a tree whose values are all ordered after
+     *              value
+     * Returns: N/A
+     * Does: moves every value of greater into this, along with one
+     *      occurrence of value, leaving greater empty. The nodes of greater
+     *      are relinked, not copied, and this takes a share of the memory
+     *      they live in. Runtime: O(log n) for balanced trees
+     * Assumes: the order above; if it does not hold, this is not a search
+     *      tree. greater is not this
+     */
+    void join(const Key &value, OrderedTree &greater);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        OrderedTree greater - a tree whose values are all ordered after
+     *              every value in this
+     * Returns: N/A
+     * Does: moves every value of greater into this, as above, joining the
+     *      two at the minimum of greater. Runtime: O(log n) for balanced
+     *      trees
+     * Assumes: greater is not this
+     */
+    void join(OrderedTree &greater);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the value to split at
+     *        OrderedTree greater - the tree to move the upper part into
+     * Returns: N/A
+     * Does: replaces the contents of greater with the values of this that
+     *      are not ordered before value, and leaves the rest in this, so
+     *      that joining greater back into this restores it. The nodes are
+     *      relinked, not copied, and greater takes a share of the memory
+     *      they live in. If greater is this, nothing is done. Runtime:
+     *      O(log n) for balanced trees
+     */
+    void split(const Key &value, OrderedTree &greater);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        OrderedTree other - another tree
+     * Returns: N/A
+     * Does: adds every value of other to this, summing the counts of values
+     *      in both, and leaves other empty. The nodes of other are relinked,
+     *      not copied, and this keeps its own payload for a value in both.
+     *      The trees are split and joined recursively, running the halves in
+     *      parallel on ForkJoinPool::shared(). Work: O(m log(n/m + 1)) for
+     *      trees of m <= n nodes; span: O(log^2 n). Only AVL and Red-Black
+     *      trees have this.
+     */
+    void union_with(OrderedTree &other);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        OrderedTree other - another tree
+     * Returns: N/A
+     * Does: keeps only the values of this that are also in other, summing
+     *      their counts, and leaves other empty, as union_with does
+     */
+    void intersect_with(OrderedTree &other);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        OrderedTree other - another tree
+     * Returns: N/A
+     * Does: removes one occurrence of a value from this for each time it
+     *      occurs in other (values that run out are removed entirely, as
+     *      remove_batch does), and leaves other empty, as union_with does
+     */
+    void difference_with(OrderedTree &other);
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: the height of this
+     * Does: computes and returns the height of this tree, as BalancePolicy
+     *      knows best how to. (An empty tree has height -1.)
+     */
+    int tree_height() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: The number of nodes in this tree
+     * Does: reads the size kept at the root. Runtime: O(1)
+     */
+    int node_count() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Does: reads the total kept at the root. Runtime: O(1)
+     */
+    int count_total() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the value to rank
+     * Returns: the number of values in this, including duplicates, that are
+     *      ordered before value. value need not be in this.
+     * Does: searches the tree for value, using the subtree totals.
+     *      Runtime: O(log n) for balanced trees
+     */
+    unsigned int rank(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        unsigned int k - a position, counting from 0
+     * Returns: the k-th smallest value in this, including duplicates, so
+     *      that select(rank(v)) is v for every v in this. Behavior is
+     *      undefined if k is not less than count_total()
+     * Does: searches the tree by position, using the subtree totals.
+     *      Runtime: O(log n) for balanced trees
+     */
+    const Key &select(unsigned int k) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        double q - the quantile, from 0 to 1
+     * Returns: the smallest value in this such that at least a q fraction
+     *      of the values in this, including duplicates, are no greater than
+     *      it (the nearest-rank method), so 0 gives the minimum and 1 the
+     *      maximum. Behavior is undefined if this is empty
+     * Does: select()s the position q stands for. Runtime: O(log n) for
+     *      balanced trees
+     */
+    const Key &quantile(double q) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the number of values in this, including duplicates, from lo
+     *      to hi, or 0 if hi is ordered before lo
+     * Does: ranks both bounds, using the subtree totals. Runtime: O(log n)
+     *      for balanced trees
+     */
+    unsigned int count_in_range(const Key &lo, const Key &hi) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the sum of the values in this from lo to hi, each added as
+     *      many times as it occurs, or 0 if hi is ordered before lo. Only
+     *      trees whose Sum is KeySum have sums.
+     * Does: adds up the subtree sums before each bound. Runtime: O(log n)
+     *      for balanced trees
+     */
+    sum_type sum_in_range(const Key &lo, const Key &hi) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: an iterator at the minimum of this, or end() if this is empty
+     */
+    const_iterator begin() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: the iterator past the maximum of this
+     */
+    const_iterator end() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the key to search for
+     * Returns: an iterator at the first key in this that is not ordered
+     *      before value, or end() if there is none
+     */
+    const_iterator lower_bound(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the key to search for
+     * Returns: an iterator at the first key in this that is ordered after
+     *      value, or end() if there is none
+     */
+    const_iterator upper_bound(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Key value - the key to search for
+     * Returns: lower_bound(value) and upper_bound(value), which are either
+     *      equal or one step apart
+     */
+    std::pair<const_iterator, const_iterator>
+    equal_range(const Key &value) const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: N/A
+     * Does: Pretty-prints the tree
+     */
+    void print_tree() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     * Returns: a relocatable image of this, whose links are 32-bit indices
+     * Does: packs this into one contiguous vector that can be copied with
+     *      memcpy or written to disk without fixing up any pointers. Only
+     *      OrderedTree<BalancePolicy, int> can be
+     *      packed.
+     */
+    PackedTree pack() const;
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        PackedTree packed - the image to load
+     * Returns: N/A
+     * Does: replaces the contents of this with a copy of packed
+     * Assumes: packed was produced by a tree with the same BalancePolicy
+     */
+    void unpack(const PackedTree &packed);
+
+    /**
+     * Input: OrderedTree this - the tree
+     *        Layout layout - the order to store the snapshot in
+     * Returns: an immutable snapshot of this, laid out for fast lookups
+     * Does: copies the values of this into flat arrays in layout order.
+     *      The snapshot does not change when this does. Only
+     *      OrderedTree<BalancePolicy, int> can be frozen.
+     */
+    FrozenTree freeze(FrozenTree::Layout layout = FrozenTree::EYTZINGER) const;
+};
+
+#include "OrderedTree.tpp"
@@ -0,0 +1,689 @@
+/*
+ * Filename: OrderedTree.tpp
+ * Contains: Implementation of Ordered Trees
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "pretty_print.h"
+
+/************************************
+ * BEGIN PUBLIC ORDEREDTREE SECTION *
+ ************************************/
+
+/*
+ * Every node of the tree is carved from this->pool, so each operation that may
+ *  create or delete nodes makes the pool current for its duration. Destroying
+ *  the tree releases the pool's chunks in one pass instead of running the
+ *  recursive ~BSTNode. An empty tree is just the shared nil sentinel.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::OrderedTree()
+    : pool(sizeof(Node), alignof(Node)), root(Node::nil()) {}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::OrderedTree(
+    const OrderedTree &source)
+    : pool(sizeof(Node), alignof(Node)), root(Node::nil())
+{
+    this->copy_nodes(source);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::~OrderedTree()
+{
+    // this->pool frees every node when it is destroyed
+    Node::destroy_in_pool(this->root, Node::destroy_workers(this->root));
+}
+
+/*
+ * Parameters: the source tree that needs to be copied
+ * Returns: a pointer to the tree
+ * Purpose:  Assignment overload. Assigns rhs to this by deep copy.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum> &
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::operator=(
+    const OrderedTree &source)
+{
+    // Check for self-assignment
+    if (this != &source)
+    {
+        // Drop the existing tree all at once, then copy into the empty pool
+        Node::destroy_in_pool(this->root, Node::destroy_workers(this->root));
+        this->pool.release();
+        this->root = Node::nil();
+
+        this->copy_nodes(source);
+    }
+    return *this;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key &
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::minimum_value() const
+{
+    return this->root->minimum_value()->data;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key &
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::maximum_value() const
+{
+    return this->root->maximum_value()->data;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+unsigned int
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::count_of(
+    const Key &value) const
+{
+    return this->root->search(value)->count;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+Value *
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::value_of(const Key &value)
+{
+    Node *node = (Node *)this->root->search(value);
+    return node->is_empty() ? nullptr : &node->value;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Value *
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::value_of(
+    const Key &value) const
+{
+    const Node *node = this->root->search(value);
+    return node->is_empty() ? nullptr : &node->value;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+template <typename K, typename... Args>
+void
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::insert(
+    K &&value, Args &&...args)
+{
+    NodePool::Scope scope(this->pool);
+    this->root = BalancePolicy::insert(this->root, std::forward<K>(value),
+                                       std::forward<Args>(args)...);
+    BalancePolicy::fix_root(this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+template <typename ForwardIt>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::assign_sorted(
+    ForwardIt first, ForwardIt last)
+{
+    // Drop the existing tree all at once, then build into the empty pool
+    Node::destroy_in_pool(this->root, Node::destroy_workers(this->root));
+    this->pool.release();
+
+    NodePool::Scope scope(this->pool);
+    this->root = Node::template build_sorted<BalancePolicy>(first, last);
+    BalancePolicy::fix_root(this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+template <typename InputIt>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::insert_batch(
+    InputIt first, InputIt last)
+{
+    std::vector<Key> batch(first, last);
+    std::sort(batch.begin(), batch.end(), Compare());
+    if (this->merges_batch(batch.size()))
+    {
+        NodePool::Scope scope(this->pool);
+        this->root = Node::template merge_sorted<BalancePolicy>(
+            this->root, batch.begin(), batch.end());
+        BalancePolicy::fix_root(this->root);
+    }
+    else
+    {
+        for (const Key &value : batch)
+        {
+            this->insert(value);
+        }
+    }
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+template <typename InputIt>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::remove_batch(
+    InputIt first, InputIt last)
+{
+    std::vector<Key> batch(first, last);
+    std::sort(batch.begin(), batch.end(), Compare());
+    if (this->merges_batch(batch.size()))
+    {
+        NodePool::Scope scope(this->pool);
+        this->root = Node::template subtract_sorted<BalancePolicy>(
+            this->root, batch.begin(), batch.end());
+        BalancePolicy::fix_root(this->root);
+    }
+    else
+    {
+        for (const Key &value : batch)
+        {
+            this->remove(value);
+        }
+    }
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::remove(
+    const Key &value)
+{
+    NodePool::Scope scope(this->pool);
+    this->root = BalancePolicy::remove(this->root, value);
+    BalancePolicy::fix_root(this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::join(
+    const Key &value, OrderedTree &greater)
+{
+    assert(&greater != this);
+    Node *middle;
+    {
+        NodePool::Scope scope(this->pool);
+        middle = new Node(value);
+    }
+    this->root = Node::template join<BalancePolicy>(
+        this->root, middle, this->take_nodes(greater));
+    BalancePolicy::fix_root(this->root);
+}
+
+/*
+ * The minimum of greater is split off to serve as the middle node, so that
+ *  no node is allocated and no key is copied. Taking the nodes of this
+ *  itself would release the pool they live in, so a self-join is caught
+ *  here rather than left to corrupt the tree.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::join(
+    OrderedTree &greater)
+{
+    assert(&greater != this);
+    Node *right = this->take_nodes(greater);
+    if (right->is_empty())
+    {
+        return;
+    }
+    Node *less;
+    Node *middle = Node::template split<BalancePolicy>(
+        right, right->minimum_value()->data, less, right);
+    this->root = Node::template join<BalancePolicy>(this->root, middle, right);
+    BalancePolicy::fix_root(this->root);
+}
+
+/*
+ * A node holding value itself goes to greater, joined in as its minimum.
+ *  greater is emptied first, so a split into this itself would destroy the
+ *  tree it is about to split; it returns at once instead.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::split(
+    const Key &value, OrderedTree &greater)
+{
+    if (&greater == this)
+    {
+        return;
+    }
+    Node::destroy_in_pool(greater.root, Node::destroy_workers(greater.root));
+    greater.pool.release();
+    greater.root = Node::nil();
+
+    Node *less;
+    Node *more;
+    Node *found =
+        Node::template split<BalancePolicy>(this->root, value, less, more);
+    if (!found->is_empty())
+    {
+        more = Node::template join<BalancePolicy>(Node::nil(), found, more);
+    }
+    this->root = less;
+    BalancePolicy::fix_root(this->root);
+    greater.root = more;
+    BalancePolicy::fix_root(greater.root);
+    greater.pool.share_chunks(this->pool);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::union_with(
+    OrderedTree &other)
+{
+    this->combine_with(Node::UNION, other);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::intersect_with(
+    OrderedTree &other)
+{
+    this->combine_with(Node::INTERSECTION, other);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::difference_with(
+    OrderedTree &other)
+{
+    this->combine_with(Node::DIFFERENCE, other);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+int OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::tree_height() const
+{
+    return BalancePolicy::height(this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+int OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::node_count() const
+{
+    return this->root->node_count();
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+int OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::count_total() const
+{
+    return this->root->count_total();
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+unsigned int
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::rank(
+    const Key &value) const
+{
+    return this->root->rank(value);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key &
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::select(
+    unsigned int k) const
+{
+    return this->root->select(k)->data;
+}
+
+/*
+ * Parameters: OrderedTree this - the tree
+ *             double q - the quantile, from 0 to 1
+ * Returns: the value at the nearest rank to q
+ * Purpose: with n values in all, the value q stands for is the ceil(q * n)-th
+ *      smallest, counting from 1; q is clamped so that out-of-range and
+ *      rounding errors still land on a value of this.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key &
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::quantile(double q) const
+{
+    unsigned int total = this->root->count_total();
+    double position = std::ceil(q * total);
+    unsigned int k = 0;
+    if (position > total)
+    {
+        k = total - 1;
+    }
+    else if (position > 1)
+    {
+        k = (unsigned int)position - 1;
+    }
+    return this->root->select(k)->data;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+unsigned int
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::count_in_range(
+    const Key &lo, const Key &hi) const
+{
+    return this->root->count_in_range(lo, hi);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::sum_type
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::sum_in_range(
+    const Key &lo, const Key &hi) const
+{
+    return this->root->sum_in_range(lo, hi);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::begin() const
+{
+    return const_iterator(this->root->minimum_value(), &this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::end() const
+{
+    return const_iterator(Node::nil(), &this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::lower_bound(
+    const Key &value) const
+{
+    return const_iterator(this->root->lower_bound(value), &this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::upper_bound(
+    const Key &value) const
+{
+    return const_iterator(this->root->upper_bound(value), &this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+std::pair<
+    typename OrderedTree<BalancePolicy, Key, Value, Compare,
+                         Sum>::const_iterator,
+    typename OrderedTree<BalancePolicy, Key, Value, Compare,
+                         Sum>::const_iterator>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::equal_range(
+    const Key &value) const
+{
+    return std::make_pair(this->lower_bound(value), this->upper_bound(value));
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::print_tree() const
+{
+    print_pretty(*this->root, 1, 0, std::cout);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+PackedTree OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::pack() const
+{
+    return PackedTree(this->root);
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::unpack(
+    const PackedTree &packed)
+{
+    Node::destroy_in_pool(this->root, Node::destroy_workers(this->root));
+    this->pool.release();
+
+    NodePool::Scope scope(this->pool);
+    this->root = packed.unpack();
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+FrozenTree
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::freeze(
+    FrozenTree::Layout layout) const
+{
+    return FrozenTree(this->root, layout);
+}
+
+/*******************************
+ * BEGIN ORDEREDTREE ITERATORS *
+ *******************************/
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator::
+    const_iterator()
+    : node(nullptr), root(nullptr) {}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator::
+    const_iterator(const Node *node, Node *const *root)
+    : node(node), root(root) {}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key &
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator*() const
+{
+    return this->node->data;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Key *
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator->() const
+{
+    return &this->node->data;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+unsigned int
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::count() const
+{
+    return this->node->count;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+const Value &
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::value() const
+{
+    return this->node->value;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator &
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator++()
+{
+    this->node = this->node->successor();
+    return *this;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator++(int)
+{
+    const_iterator before = *this;
+    ++*this;
+    return before;
+}
+
+/*
+ * Parameters: const_iterator this - an iterator after begin()
+ * Returns: this
+ * Purpose: end() is the nil sentinel, which has no parent to climb, so
+ *      stepping back from it goes down from the root to the maximum instead.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator &
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator--()
+{
+    if (this->node->is_empty())
+    {
+        this->node = (*this->root)->maximum_value();
+    }
+    else
+    {
+        this->node = this->node->predecessor();
+    }
+    return *this;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator
+OrderedTree<BalancePolicy, Key, Value, Compare,
+            Sum>::const_iterator::operator--(int)
+{
+    const_iterator before = *this;
+    --*this;
+    return before;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+bool OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator::
+operator==(const const_iterator &other) const
+{
+    return this->node == other.node;
+}
+
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+bool OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::const_iterator::
+operator!=(const const_iterator &other) const
+{
+    return this->node != other.node;
+}
+
+/*************************************
+ * BEGIN PRIVATE ORDEREDTREE SECTION *
+ *************************************/
+
+/*
+ * Parameters: OrderedTree this - the tree
+ *             OrderedTree other - the tree to take the nodes of
+ * Returns: the root of other's nodes
+ * Purpose: the chunks other's nodes live in are shared rather than moved,
+ *      since other may itself share them with a tree it was split from.
+ *      Slots other had freed, or not yet carved, are not reused until the
+ *      chunks are freed.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+typename OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::Node *
+OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::take_nodes(
+    OrderedTree &other)
+{
+    Node *taken = other.root;
+    this->pool.share_chunks(other.pool);
+    other.pool.release();
+    other.root = Node::nil();
+    return taken;
+}
+
+/*
+ * Parameters: OrderedTree this - the tree
+ *             OrderedTree source - the tree to copy
+ * Returns: N/A
+ * Purpose: the block is sized from source's node count up front, so the
+ *      workers never touch the pool, which is not thread-safe; each copies
+ *      its subtree into a range of the block no other task writes to.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::copy_nodes(
+    const OrderedTree &source)
+{
+    if (source.root->is_empty())
+    {
+        return;
+    }
+    void *slots = this->pool.allocate_block(source.root->node_count());
+    this->root = Node::copy_into(source.root, slots,
+                                 Node::fork_workers(source.root->size));
+}
+
+/*
+ * Parameters: OrderedTree this - the tree
+ *             SetOperation op - the operation to apply
+ *             OrderedTree other - the other tree
+ * Returns: N/A
+ * Purpose: the recursion is as deep as the trees, which only balanced trees
+ *      keep logarithmic. A tree combined with itself is combined with a copy
+ *      instead, since taking its own nodes would empty it. The dropped nodes
+ *      are deleted here, on this thread, once the workers are done.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+void OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::combine_with(
+    typename Node::SetOperation op, OrderedTree &other)
+{
+    static_assert(!std::is_same<BalancePolicy, NaiveBalance>::value,
+                  "set operations need a balanced tree");
+    if (this == &other)
+    {
+        OrderedTree copy(other);
+        this->combine_with(op, copy);
+        return;
+    }
+
+    std::vector<Node *> dropped;
+    Node *taken = this->take_nodes(other);
+    ForkJoinPool *workers = Node::fork_workers(this->root->size + taken->size);
+    this->root = Node::template combine<BalancePolicy>(
+        op, this->root, taken, dropped, workers);
+    BalancePolicy::fix_root(this->root);
+
+    NodePool::Scope scope(this->pool);
+    for (Node *node : dropped)
+    {
+        delete node;
+    }
+}
+
+/*
+ * Parameters: OrderedTree this - the tree
+ *             size_t batch - the number of keys in a batch
+ * Returns: whether to rebuild this around the batch
+ * Purpose: applying m sorted keys one at a time costs m searches, which
+ *      share most of their paths and so mostly hit the cache, while
+ *      rebuilding visits all n nodes. Measured on trees of 10^5 to 10^6
+ *      ints, rebuilding wins once the batch is about an eighth of the tree.
+ */
+template <typename BalancePolicy, typename Key, typename Value,
+          typename Compare, typename Sum>
+bool OrderedTree<BalancePolicy, Key, Value, Compare, Sum>::merges_batch(
+    std::size_t batch) const
+{
+    return batch * 8 >= this->root->node_count();
+}
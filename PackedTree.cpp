@@ -0,0 +1,198 @@
+/*
+ * Filename: PackedTree.cpp
+ * Contains: Implementation of Packed Trees
+ */
+
+#include "PackedTree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+using namespace std;
+
+/*
+ * Index 0 of every image: the nil sentinel, which links to nothing.
+ */
+static const PackedNode PACKED_NIL = {0, 0, 0, 0, 0, 0};
+
+/*
+ * How many nodes read() takes from the stream at a time.
+ */
+static const size_t READ_CHUNK = 1 << 16;
+
+PackedTree::PackedTree() : packed(1, PACKED_NIL) {}
+
+/*
+ * Parameters: Node root - the root of the tree to pack
+ * Returns: the image of the tree rooted at root
+ * Purpose: copies every node in pre-order. An explicit stack is used rather
+ *      than recursion, since a naive BST may be as deep as it is large.
+ */
+PackedTree::PackedTree(const BSTNode<int> *root) : packed(1, PACKED_NIL)
+{
+    struct Pending
+    {
+        const BSTNode<int> *node;
+        uint32_t parent;
+        BSTNode<int>::Direction dir;
+    };
+
+    vector<Pending> stack;
+    if (!root->is_empty())
+    {
+        stack.push_back({root, 0, BSTNode<int>::ROOT});
+    }
+    while (!stack.empty())
+    {
+        Pending next = stack.back();
+        stack.pop_back();
+
+        assert(this->packed.size() < numeric_limits<uint32_t>::max());
+        uint32_t index = (uint32_t)this->packed.size();
+        PackedNode node;
+        node.data = next.node->data;
+        node.count = next.node->count;
+        node.left = 0;
+        node.right = 0;
+        node.parent = next.parent;
+        node.meta =
+            (uint32_t)(next.node->parent_meta & BSTNode<int>::META_MASK);
+        this->packed.push_back(node);
+
+        if (next.dir == BSTNode<int>::LEFT)
+        {
+            this->packed[next.parent].left = index;
+        }
+        else if (next.dir == BSTNode<int>::RIGHT)
+        {
+            this->packed[next.parent].right = index;
+        }
+
+        // Push right first so that the left subtree is packed first
+        if (!next.node->right->is_empty())
+        {
+            stack.push_back({next.node->right, index, BSTNode<int>::RIGHT});
+        }
+        if (!next.node->left->is_empty())
+        {
+            stack.push_back({next.node->left, index, BSTNode<int>::LEFT});
+        }
+    }
+}
+
+/*
+ * Parameters: PackedTree this - the image
+ * Returns: the root of a newly-allocated copy of the image
+ * Purpose: allocates all nodes first, then turns each index into the address
+ *      of the node allocated for it. Subtree sizes and totals are not part
+ *      of the image, so they are recomputed.
+ */
+BSTNode<int> *PackedTree::unpack() const
+{
+    vector<BSTNode<int> *> nodes(this->packed.size(), BSTNode<int>::nil());
+    for (size_t i = 1; i < this->packed.size(); i++)
+    {
+        nodes[i] = new BSTNode<int>(this->packed[i].data);
+        nodes[i]->count = this->packed[i].count;
+        nodes[i]->parent_meta =
+            this->packed[i].meta & BSTNode<int>::META_MASK;
+    }
+    for (size_t i = 1; i < this->packed.size(); i++)
+    {
+        const PackedNode &node = this->packed[i];
+        nodes[i]->left = nodes[node.left];
+        nodes[i]->right = nodes[node.right];
+        nodes[i]->set_parent(node.parent ? nodes[node.parent] : nullptr);
+    }
+    // Children come after their parents in pre-order, so counting back from
+    //  the end recounts every subtree after its children
+    for (size_t i = this->packed.size() - 1; i >= 1; i--)
+    {
+        nodes[i]->make_locally_consistent();
+    }
+    return nodes.size() > 1 ? nodes[1] : BSTNode<int>::nil();
+}
+
+unsigned int PackedTree::node_count() const
+{
+    return (unsigned int)(this->packed.size() - 1);
+}
+
+const PackedNode *PackedTree::nodes() const
+{
+    return this->packed.data();
+}
+
+void PackedTree::write(ostream &out) const
+{
+    uint32_t size = (uint32_t)this->packed.size();
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char *>(this->packed.data()),
+              size * sizeof(PackedNode));
+}
+
+/*
+ * Parameters: PackedTree this - the image to replace
+ *             istream in - a stream positioned at the output of write()
+ * Returns: true iff a well-formed image was read
+ * Purpose: reads the image, then checks that it really is one tree: every
+ *      node other than the root is the child of exactly one node that comes
+ *      before it, and agrees about who its parent is. The size in the header
+ *      is only a promise, so the image grows a chunk at a time as nodes
+ *      actually arrive; a short or corrupt stream fails the read rather
+ *      than an allocation.
+ */
+bool PackedTree::read(istream &in)
+{
+    this->packed.assign(1, PACKED_NIL);
+
+    uint32_t size = 0;
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    if (!in || size == 0)
+    {
+        return false;
+    }
+
+    vector<PackedNode> image;
+    while (image.size() < size)
+    {
+        size_t have = image.size();
+        image.resize(min<size_t>(size, have + READ_CHUNK));
+        in.read(reinterpret_cast<char *>(image.data() + have),
+                (image.size() - have) * sizeof(PackedNode));
+        if (!in)
+        {
+            return false;
+        }
+    }
+
+    vector<bool> linked(size, false);
+    bool valid = image[0].count == 0 && image[0].left == 0 &&
+                 image[0].right == 0;
+    for (uint32_t i = 1; valid && i < size; i++)
+    {
+        const PackedNode &node = image[i];
+        valid = node.count > 0 &&
+                (i == 1) == (node.parent == 0) &&
+                (node.parent == 0 || linked[i]);
+        for (uint32_t child : {node.left, node.right})
+        {
+            if (child != 0)
+            {
+                valid = valid && child > i && child < size && !linked[child] &&
+                        image[child].parent == i;
+                if (valid)
+                {
+                    linked[child] = true;
+                }
+            }
+        }
+    }
+
+    if (valid)
+    {
+        this->packed.swap(image);
+    }
+    return valid;
+}
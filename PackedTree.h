@@ -0,0 +1,103 @@
+/*
+ * Filename: PackedTree.h
+ * Contains: Interface of Packed Trees, a relocatable image of a tree whose
+ *      links are 32-bit indices instead of pointers
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "BSTNode.h"
+
+/**
+ * Packed Node:
+ *    - data, count are copied from the BSTNode
+ *    - left, right, parent are indices into the PackedTree's node vector;
+ *      index 0 is the nil sentinel (the empty tree, or no parent)
+ *    - meta holds the BSTNode's color and AVL balance factor bits
+ *
+ * A packed node takes 24 bytes, and holds no pointers at all.
+ */
+struct PackedNode
+{
+    int data;
+    int count;
+    std::uint32_t left;
+    std::uint32_t right;
+    std::uint32_t parent;
+    std::uint32_t meta;
+};
+
+/**
+ * Packed Tree:
+ *    - nodes is one contiguous vector; nodes[0] is the nil sentinel and the
+ *      remaining nodes are stored in pre-order, so nodes[1] is the root
+ *
+ * Since nothing in the image is an address, a PackedTree can be copied with
+ *  memcpy, written to disk or shipped to another process and read back as is.
+ *  It is a storage format: to query or update it, unpack it into a tree, or
+ *  see IndexedTree for a tree that is kept in this form.
+ */
+class PackedTree
+{
+public:
+    /**
+     * Default constructor. Creates the image of an empty tree.
+     */
+    PackedTree();
+
+    /**
+     * Input: Node root - the root of the tree to pack
+     * Returns: the image of the tree rooted at root
+     * Does: copies every node of the tree in pre-order, replacing each link
+     *      with the index of the node it points to. Runtime: O(n)
+     */
+    explicit PackedTree(const BSTNode<int> *root);
+
+    /**
+     * Input: PackedTree this - the image
+     * Returns: the root of a newly-allocated tree that is a copy of the
+     *      image, with parent nullptr, or the nil sentinel if it is empty
+     * Does: allocates every node (from the current NodePool, if there is
+     *      one) and turns the indices back into pointers. Runtime: O(n)
+     */
+    BSTNode<int> *unpack() const;
+
+    /**
+     * Input: PackedTree this - the image
+     * Returns: the number of non-empty nodes in the image
+     */
+    unsigned int node_count() const;
+
+    /**
+     * Input: PackedTree this - the image
+     * Returns: the packed nodes, nil sentinel first; there are
+     *      node_count() + 1 of them
+     */
+    const PackedNode *nodes() const;
+
+    /**
+     * Input: PackedTree this - the image
+     *        ostream out - the stream to write to
+     * Returns: N/A
+     * Does: writes the node count followed by the raw nodes, in the byte
+     *      order of this machine
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * Input: PackedTree this - the image to replace
+     *        istream in - a stream positioned at the output of write()
+     * Returns: true iff a well-formed image was read. On failure this is
+     *      left as the image of an empty tree.
+     * Does: reads the image back in chunks, checking that every link is in
+     *      range
+     */
+    bool read(std::istream &in);
+
+private:
+    std::vector<PackedNode> packed;
+};
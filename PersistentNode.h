@@ -0,0 +1,283 @@
+/*
+ * Filename: PersistentNode.h
+ * Contains: Interface of Persistent Nodes, the shared, reference-counted
+ *      nodes of PersistentTree
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "BSTNode.h"
+
+/**
+ * Persistent Node:
+ *    - a node of an AVL tree that any number of versions of the tree may
+ *      share; it has no parent pointer, since it may have many parents
+ *    - counts the references to it (from parents and from the roots of
+ *      trees) and frees itself, and lets go of its children, when the last
+ *      one is dropped
+ *    - is never changed once it is shared: an update copies the nodes on
+ *      its path that are shared, and changes in place the ones only its own
+ *      version can reach, so a tree with no snapshots is updated without
+ *      copying anything
+ *
+ * The static functions that take a node "consume" the reference they are
+ *  passed and return a reference owned by the caller. References are counted
+ *  atomically, so versions that share nodes may be copied, read and dropped
+ *  on different threads; a single version must not be updated by two
+ *  threads at once. Nodes come from the global heap, since they outlive any
+ *  one tree.
+ */
+template <typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>>
+class PersistentNode : public BSTNodeValue<Value>
+{
+public:
+    typedef Key key_type;
+
+    /**
+     * The key stored in this node.
+     */
+    Key data;
+
+    /**
+     * The number of times data occurs in the tree. An empty tree has count
+     *  0.
+     */
+    int count;
+
+    /**
+     * The number of nodes, and the total of their counts, in the subtree
+     *  rooted at this node.
+     */
+    unsigned int size;
+    unsigned int total;
+
+    /**
+     * The height of the subtree rooted at this node; -1 for an empty tree.
+     */
+    int height;
+
+    /**
+     * The children of this node; the nil sentinel if empty. Only changed
+     *  while this node is not shared.
+     */
+    PersistentNode *left;
+    PersistentNode *right;
+
+    /**
+     * Input: N/A
+     * Returns: the nil sentinel: the single, shared empty tree that stands in
+     *      for every empty subtree of every tree. It is not reference
+     *      counted and is never freed.
+     */
+    static PersistentNode *nil();
+
+    /**
+     * Input: Node node - the root of a tree
+     * Returns: node
+     * Does: adds a reference to node, for a new parent or version
+     */
+    static PersistentNode *retain(PersistentNode *node);
+
+    /**
+     * Input: Node node - the root of a tree
+     * Returns: N/A
+     * Does: drops a reference to node, and frees it if that was the last,
+     *      dropping its references to its children in turn
+     */
+    static void release(PersistentNode *node);
+
+    /**
+     * Input: Node root - the root of a tree, whose reference is consumed
+     *        Key value - value to insert
+     *        Args args - the arguments to construct value's payload with
+     * Returns: the root of a tree that also holds value, or holds it once
+     *      more
+     * Does: inserts value as AVLTree does, copying the shared nodes on the
+     *      path to it. Runtime: O(log n)
+     */
+    template <typename K, typename... Args>
+    static PersistentNode *insert(PersistentNode *root, K &&value,
+                                  Args &&...args);
+
+    /**
+     * Input: Node root - the root of a tree, whose reference is consumed
+     *        Key value - value to remove
+     * Returns: the root of a tree that holds value once less, which is root
+     *      itself if value is not in it
+     * Does: removes value as AVLTree does, copying the shared nodes on the
+     *      path to it and to its successor. Runtime: O(log n)
+     */
+    static PersistentNode *remove(PersistentNode *root, const Key &value);
+
+    /**
+     * Input: Node this - the root of a tree
+     *        Key value - value to search for
+     * Returns: the node holding value, or an empty tree
+     */
+    const PersistentNode *search(const Key &value) const;
+
+    /**
+     * Input: Node this - the root of a non-empty tree
+     * Returns: the node with the minimum or maximum key of the tree
+     */
+    const PersistentNode *minimum_value() const;
+    const PersistentNode *maximum_value() const;
+
+    /**
+     * Input: Node this - the root of a tree
+     *        Key value - the value to rank
+     * Returns: the number of values in the tree, including duplicates, that
+     *      are ordered before value
+     */
+    unsigned int rank(const Key &value) const;
+
+    /**
+     * Input: Node this - the root of a tree
+     *        unsigned int k - a position, counting from 0
+     * Returns: the node holding the k-th smallest value, including
+     *      duplicates, or an empty tree if there is none
+     */
+    const PersistentNode *select(unsigned int k) const;
+
+    /**
+     * Input: Node this - the root of a tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the number of values in the tree, including duplicates,
+     *      that are not ordered before lo nor after hi
+     */
+    unsigned int count_in_range(const Key &lo, const Key &hi) const;
+
+    /**
+     * Input: Node this - the root of a tree
+     *        Key lo, hi - the bounds of the range, both included
+     *        F visit - called as visit(key, count) for each key in the range
+     * Returns: N/A
+     * Does: visits the keys of the tree in the range in order, skipping the
+     *      subtrees that lie outside it. Runtime: O(log n + k) for k keys
+     */
+    template <typename F>
+    void for_each_in_range(const Key &lo, const Key &hi, F &visit) const;
+
+    /**
+     * Input: Node this - the root of a tree
+     * Returns: the height of the tree; -1 if it is empty
+     */
+    int node_height() const;
+
+    /**
+     * Input: Node this - the node
+     * Returns: true iff this is an empty tree
+     */
+    bool is_empty() const;
+
+    /**
+     * Input: Node this - the node
+     * Returns: this node's key as a string, followed by '*' if its count is
+     *      more than 1; an empty string for an empty tree
+     */
+    std::string to_string() const;
+
+private:
+    /**
+     * The number of references to this node.
+     */
+    std::atomic<unsigned int> refs;
+
+    /**
+     * Input: N/A
+     * Returns: an empty tree; only used for the nil sentinel
+     */
+    PersistentNode();
+
+    /**
+     * Input: data (the key to store)
+     *        args (the arguments to construct the payload from, if any)
+     * Returns: a leaf holding data once, with one reference
+     */
+    template <typename K, typename... Args,
+              typename = typename std::enable_if<!std::is_same<
+                  typename std::decay<K>::type, PersistentNode>::value>::type>
+    explicit PersistentNode(K &&data, Args &&...args);
+
+    /**
+     * Input: other - the node to copy
+     * Returns: a node with other's key, payload and counts, sharing its
+     *      children, with one reference
+     */
+    PersistentNode(const PersistentNode &other);
+
+    PersistentNode &operator=(const PersistentNode &) = delete;
+
+    /**
+     * Input: a, b - two keys
+     * Returns: true iff a is ordered before b
+     */
+    static bool key_less(const Key &a, const Key &b);
+
+    /**
+     * Input: Node this - the root of a tree
+     *        Key bound - the key to stop at
+     *        bool inclusive - whether occurrences of bound itself are counted
+     * Returns: the number of occurrences of keys ordered before (or up to)
+     *      bound
+     */
+    unsigned int count_before(const Key &bound, bool inclusive) const;
+
+    /**
+     * Input: Node node - a non-empty node, whose reference is consumed
+     * Returns: node itself if that was its only reference, or else a copy
+     *      of it; either way a node the caller alone may change
+     */
+    static PersistentNode *own(PersistentNode *node);
+
+    /**
+     * Input: Node node - a node the caller owns (see own)
+     * Returns: N/A
+     * Does: recomputes the size, total and height of node from its children
+     */
+    static void update(PersistentNode *node);
+
+    /**
+     * Input: Node node - a node the caller owns, whose subtrees are AVL
+     *            trees whose heights differ by at most two
+     * Returns: the root of an AVL tree of the same nodes
+     * Does: updates node, then rotates once or twice if it is unbalanced
+     */
+    static PersistentNode *rebalance(PersistentNode *node);
+
+    /**
+     * Input: Node node - a node the caller owns, with a non-empty child on
+     *            the side it is rotated from
+     * Returns: the child, now owned and the root of the rotated subtree
+     */
+    static PersistentNode *rotate_left(PersistentNode *node);
+    static PersistentNode *rotate_right(PersistentNode *node);
+
+    /**
+     * Input: Node node - the root of a tree holding value, whose reference
+     *            is consumed
+     *        Key value - value to remove
+     * Returns: the root of the tree without one occurrence of value
+     */
+    static PersistentNode *remove_present(PersistentNode *node,
+                                          const Key &value);
+
+    /**
+     * Input: Node node - the root of a non-empty tree, whose reference is
+     *            consumed
+     *        Node min - set to the node with the minimum key, owned by the
+     *            caller and unlinked, with no children
+     * Returns: the root of the tree without min
+     */
+    static PersistentNode *remove_min(PersistentNode *node,
+                                      PersistentNode *&min);
+};
+
+#include "PersistentNode.tpp"
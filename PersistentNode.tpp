@@ -0,0 +1,503 @@
+/*
+ * Filename: PersistentNode.tpp
+ * Contains: Implementation of Persistent Nodes, included at the end of
+ *      PersistentNode.h since PersistentNode is a class template
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare>::PersistentNode()
+    : data(), count(0), size(0), total(0), height(-1), left(nullptr),
+      right(nullptr), refs(0) {}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename... Args, typename>
+PersistentNode<Key, Value, Compare>::PersistentNode(K &&data, Args &&...args)
+    : BSTNodeValue<Value>(std::forward<Args>(args)...),
+      data(std::forward<K>(data)), count(1), size(1), total(1), height(0),
+      left(nil()), right(nil()), refs(1) {}
+
+/*
+ * Parameters: other
+ * Returns: a copy of other alone
+ * Purpose: the copy is a new parent of other's children, so each gains a
+ *      reference
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare>::PersistentNode(const PersistentNode &other)
+    : BSTNodeValue<Value>(static_cast<const BSTNodeValue<Value> &>(other)),
+      data(other.data), count(other.count), size(other.size),
+      total(other.total), height(other.height), left(retain(other.left)),
+      right(retain(other.right)), refs(1) {}
+
+/*
+ * Parameters: N/A
+ * Returns: the shared empty tree
+ * Purpose: as BSTNode::nil, every empty subtree of every version is this
+ *      one node, so no walk needs to check for nullptr.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *PersistentNode<Key, Value, Compare>::nil()
+{
+    static PersistentNode sentinel;
+    return &sentinel;
+}
+
+/*
+ * Parameters: Node node - the root of a tree
+ * Returns: node
+ * Purpose: taking a reference needs no ordering: the caller already holds
+ *      one, so node cannot be freed meanwhile.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::retain(PersistentNode *node)
+{
+    if (!node->is_empty())
+    {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+/*
+ * Parameters: Node node - the root of a tree
+ * Returns: N/A
+ * Purpose: the thread that drops the last reference must see every write
+ *      the other holders made before dropping theirs, hence acq_rel. The
+ *      walk down only goes as deep as the tree, which is an AVL tree.
+ */
+template <typename Key, typename Value, typename Compare>
+void PersistentNode<Key, Value, Compare>::release(PersistentNode *node)
+{
+    if (node->is_empty() ||
+        node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+    release(node->left);
+    release(node->right);
+    delete node;
+}
+
+/*
+ * Parameters: Node node - a non-empty node
+ * Returns: a node the caller alone may change
+ * Purpose: the caller owns the parent node was reached from, so a single
+ *      reference is the caller's own and no other thread can add one.
+ *      Otherwise the copy is made first and the reference dropped after, so
+ *      the children stay alive in between.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::own(PersistentNode *node)
+{
+    if (node->refs.load(std::memory_order_acquire) == 1)
+    {
+        return node;
+    }
+    PersistentNode *copy = new PersistentNode(*node);
+    release(node);
+    return copy;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentNode<Key, Value, Compare>::key_less(const Key &a, const Key &b)
+{
+    return Compare()(a, b);
+}
+
+template <typename Key, typename Value, typename Compare>
+void PersistentNode<Key, Value, Compare>::update(PersistentNode *node)
+{
+    node->size = node->left->size + node->right->size + 1;
+    node->total = node->left->total + node->right->total + node->count;
+    node->height = std::max(node->left->height, node->right->height) + 1;
+}
+
+/*
+ * Parameters: Node node - the node to rotate about
+ * Returns: the new root of the subtree
+ * Purpose: the child moves up, so it is owned before it is changed; the
+ *      reference node held to it becomes the caller's, and the subtree that
+ *      changes sides keeps the one it had.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::rotate_left(PersistentNode *node)
+{
+    PersistentNode *pivot = own(node->right);
+    node->right = pivot->left;
+    pivot->left = node;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::rotate_right(PersistentNode *node)
+{
+    PersistentNode *pivot = own(node->left);
+    node->left = pivot->right;
+    pivot->right = node;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+/*
+ * Parameters: Node node - the node to rebalance
+ * Returns: the new root of the subtree
+ * Purpose: a child that leans the other way is rotated first, making the
+ *      double rotation of the AVL rules. It is owned before it is rotated,
+ *      like the child rotate_left and rotate_right move up.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::rebalance(PersistentNode *node)
+{
+    update(node);
+    int balance = node->right->height - node->left->height;
+    if (balance > 1)
+    {
+        if (node->right->left->height > node->right->right->height)
+        {
+            node->right = rotate_right(own(node->right));
+        }
+        return rotate_left(node);
+    }
+    if (balance < -1)
+    {
+        if (node->left->right->height > node->left->left->height)
+        {
+            node->left = rotate_left(own(node->left));
+        }
+        return rotate_right(node);
+    }
+    return node;
+}
+
+/*
+ * Parameters: Node root - the root of the tree
+ *             K value - the key to insert
+ *             Args args - the arguments to construct its payload with
+ * Returns: the root of the new version
+ * Purpose: every node on the path gains an occurrence, so each is owned on
+ *      the way down; the recursion is as deep as the tree, which is an AVL
+ *      tree.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename... Args>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::insert(PersistentNode *root, K &&value,
+                                            Args &&...args)
+{
+    if (root->is_empty())
+    {
+        return new PersistentNode(std::forward<K>(value),
+                                  std::forward<Args>(args)...);
+    }
+    root = own(root);
+    if (key_less(value, root->data))
+    {
+        root->left = insert(root->left, std::forward<K>(value),
+                            std::forward<Args>(args)...);
+    }
+    else if (key_less(root->data, value))
+    {
+        root->right = insert(root->right, std::forward<K>(value),
+                             std::forward<Args>(args)...);
+    }
+    else
+    {
+        root->count++;
+    }
+    return rebalance(root);
+}
+
+/*
+ * Parameters: Node root - the root of the tree
+ *             Key value - the key to remove
+ * Returns: the root of the new version
+ * Purpose: value is looked up first, so that removing a key that is not
+ *      there copies nothing.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::remove(PersistentNode *root,
+                                            const Key &value)
+{
+    if (root->search(value)->is_empty())
+    {
+        return root;
+    }
+    return remove_present(root, value);
+}
+
+/*
+ * Parameters: Node node - the root of the tree
+ *             Key value - the key to remove
+ * Returns: the root of the tree without one occurrence of value
+ * Purpose: a node with two children is replaced by its successor, which is
+ *      unlinked from the right subtree and takes over the node's children;
+ *      the node itself, with its children taken, frees only itself.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::remove_present(PersistentNode *node,
+                                                    const Key &value)
+{
+    node = own(node);
+    if (key_less(value, node->data))
+    {
+        node->left = remove_present(node->left, value);
+    }
+    else if (key_less(node->data, value))
+    {
+        node->right = remove_present(node->right, value);
+    }
+    else if (node->count > 1)
+    {
+        node->count--;
+    }
+    else
+    {
+        PersistentNode *left = node->left;
+        PersistentNode *right = node->right;
+        node->left = nil();
+        node->right = nil();
+        release(node);
+        if (left->is_empty() || right->is_empty())
+        {
+            return left->is_empty() ? right : left;
+        }
+        right = remove_min(right, node);
+        node->left = left;
+        node->right = right;
+    }
+    return rebalance(node);
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::remove_min(PersistentNode *node,
+                                                PersistentNode *&min)
+{
+    node = own(node);
+    if (node->left->is_empty())
+    {
+        PersistentNode *right = node->right;
+        node->right = nil();
+        min = node;
+        return right;
+    }
+    node->left = remove_min(node->left, min);
+    return rebalance(node);
+}
+
+template <typename Key, typename Value, typename Compare>
+const PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::search(const Key &value) const
+{
+    const PersistentNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (key_less(value, curr->data))
+        {
+            curr = curr->left;
+        }
+        else if (key_less(curr->data, value))
+        {
+            curr = curr->right;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return curr;
+}
+
+template <typename Key, typename Value, typename Compare>
+const PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::minimum_value() const
+{
+    const PersistentNode *curr = this;
+    while (!curr->left->is_empty())
+    {
+        curr = curr->left;
+    }
+    return curr;
+}
+
+template <typename Key, typename Value, typename Compare>
+const PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::maximum_value() const
+{
+    const PersistentNode *curr = this;
+    while (!curr->right->is_empty())
+    {
+        curr = curr->right;
+    }
+    return curr;
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ *             Key bound - the key to stop at
+ *             bool inclusive - whether occurrences of bound itself are
+ *                  counted
+ * Returns: the number of occurrences of keys before (or up to) bound
+ * Purpose: the same walk as BSTNode::count_before
+ */
+template <typename Key, typename Value, typename Compare>
+unsigned int
+PersistentNode<Key, Value, Compare>::count_before(const Key &bound,
+                                                  bool inclusive) const
+{
+    unsigned int before = 0;
+    const PersistentNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (inclusive ? !key_less(bound, curr->data)
+                      : key_less(curr->data, bound))
+        {
+            before += curr->left->total + curr->count;
+            curr = curr->right;
+        }
+        else
+        {
+            curr = curr->left;
+        }
+    }
+    return before;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int PersistentNode<Key, Value, Compare>::rank(const Key &value) const
+{
+    return this->count_before(value, false);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ *             unsigned int k - a position, counting from 0
+ * Returns: the node holding the k-th smallest occurrence, or an empty tree
+ * Purpose: the same walk as BSTNode::select
+ */
+template <typename Key, typename Value, typename Compare>
+const PersistentNode<Key, Value, Compare> *
+PersistentNode<Key, Value, Compare>::select(unsigned int k) const
+{
+    const PersistentNode *curr = this;
+    while (!curr->is_empty())
+    {
+        if (k < curr->left->total)
+        {
+            curr = curr->left;
+        }
+        else if (k - curr->left->total < (unsigned int)curr->count)
+        {
+            return curr;
+        }
+        else
+        {
+            k -= curr->left->total + curr->count;
+            curr = curr->right;
+        }
+    }
+    return curr;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int
+PersistentNode<Key, Value, Compare>::count_in_range(const Key &lo,
+                                                    const Key &hi) const
+{
+    if (key_less(hi, lo))
+    {
+        return 0;
+    }
+    return this->count_before(hi, true) - this->count_before(lo, false);
+}
+
+/*
+ * Parameters: Node this - the root of the tree
+ *             Key lo, hi - the bounds of the range
+ *             F visit - the function to call on each key in it
+ * Returns: N/A
+ * Purpose: a subtree is only entered if the range reaches into it; the
+ *      recursion is as deep as the tree, which is an AVL tree.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename F>
+void PersistentNode<Key, Value, Compare>::for_each_in_range(const Key &lo,
+                                                            const Key &hi,
+                                                            F &visit) const
+{
+    if (this->is_empty())
+    {
+        return;
+    }
+    bool above_lo = !key_less(this->data, lo);
+    bool below_hi = !key_less(hi, this->data);
+    if (above_lo)
+    {
+        this->left->for_each_in_range(lo, hi, visit);
+    }
+    if (above_lo && below_hi)
+    {
+        visit(this->data, (unsigned int)this->count);
+    }
+    if (below_hi)
+    {
+        this->right->for_each_in_range(lo, hi, visit);
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+int PersistentNode<Key, Value, Compare>::node_height() const
+{
+    return this->height;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentNode<Key, Value, Compare>::is_empty() const
+{
+    assert((this->count == 0) == (!this->left && !this->right));
+    return this->count == 0;
+}
+
+/*
+ * Parameters: Node node - the node to label
+ * Returns: node's key, followed by '*' if its count is more than 1, or an
+ *      empty string if node is an empty tree
+ * Purpose: print_pretty also asks the missing children of its bottom row
+ *      for a label, so node may be nullptr, as in value_string.
+ */
+template <typename Key, typename Value, typename Compare>
+std::string persistent_string(const PersistentNode<Key, Value, Compare> *node)
+{
+    std::string label = "";
+    if (node && !node->is_empty())
+    {
+        std::ostringstream out;
+        out << node->data;
+        if (node->count > 1)
+        {
+            out << "*";
+        }
+        label = out.str();
+    }
+    return label;
+}
+
+template <typename Key, typename Value, typename Compare>
+std::string PersistentNode<Key, Value, Compare>::to_string() const
+{
+    return persistent_string(this);
+}
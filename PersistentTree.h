@@ -0,0 +1,166 @@
+/*
+ * Filename: PersistentTree.h
+ * Contains: Interface of Persistent Trees, AVL trees whose copies share
+ *      their nodes
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "PersistentNode.h"
+
+/**
+ * An AVL tree with the keys, counts and payloads of AVLTree, whose versions
+ *  share every subtree they have in common:
+ *    - copying or assigning a tree takes a snapshot of it in O(1), by
+ *      adding a reference to its root
+ *    - insert and remove copy only the nodes on the path they change that
+ *      another version shares, so an update costs O(log n) memory, and
+ *      nothing at all while no snapshot of the tree is alive
+ *    - payloads may be shared by several versions, so they are read-only
+ *
+ * Snapshots may be taken, read and dropped on any thread, while the tree
+ *  they were taken from goes on being updated; see PersistentNode.
+ */
+template <typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>>
+class PersistentTree
+{
+private:
+    typedef PersistentNode<Key, Value, Compare> Node;
+
+    /**
+     * The root of this version, which holds one reference to it.
+     */
+    Node *root;
+
+public:
+    /**
+     * Default constructor. Creates an empty tree.
+     */
+    PersistentTree();
+
+    /**
+     * Copy constructor. Creates a snapshot of source, sharing all of its
+     *  nodes. Runtime: O(1)
+     */
+    PersistentTree(const PersistentTree &source);
+
+    /**
+     * Destructor. Drops this version, freeing the nodes no other version
+     *  shares.
+     */
+    ~PersistentTree();
+
+    /**
+     * Assignment overload. Makes this a snapshot of rhs, as the copy
+     *  constructor does, and drops the version this was.
+     */
+    PersistentTree &operator=(const PersistentTree &rhs);
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: the minimum value in this
+     * Does: Searches this for its minimum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &minimum_value() const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: the maximum value in this
+     * Does: Searches this for its maximum value, and returns it. Behavior is
+     *      undefined if this is empty
+     */
+    const Key &maximum_value() const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches the tree for value
+     */
+    unsigned int count_of(const Key &value) const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        Key value - value to search for
+     * Returns: a pointer to the payload stored with value, or nullptr if value
+     *      is not in this
+     * Does: searches the tree for value. The pointer is good for as long as
+     *      this version, or another that shares value's node, is alive.
+     */
+    const Value *value_of(const Key &value) const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        Key value - value to insert
+     *        Args args - the arguments to construct value's payload with
+     * Returns: N/A
+     * Does: Inserts value into this as AVLTree does. Snapshots of this are
+     *      not changed. Runtime: O(log n)
+     */
+    template <typename K, typename... Args>
+    void insert(K &&value, Args &&...args);
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        Key value - value to remove
+     * Returns: N/A
+     * Does: Removes one occurrence of value from this as AVLTree does.
+     *      Snapshots of this are not changed. Runtime: O(log n)
+     */
+    void remove(const Key &value);
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: the height of this. (An empty tree has height -1.)
+     * Does: reads the height kept at the root. Runtime: O(1)
+     */
+    int tree_height() const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: The number of nodes in this tree
+     * Does: reads the size kept at the root. Runtime: O(1)
+     */
+    int node_count() const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     * Does: reads the total kept at the root. Runtime: O(1)
+     */
+    int count_total() const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        Key value - the value to rank
+     * Returns: the number of values in this, including duplicates, that are
+     *      ordered before value. value need not be in this.
+     * Does: searches the tree for value, using the subtree totals.
+     *      Runtime: O(log n)
+     */
+    unsigned int rank(const Key &value) const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     *        unsigned int k - a position, counting from 0
+     * Returns: the k-th smallest value in this, including duplicates.
+     *      Behavior is undefined if k is not less than count_total()
+     * Does: searches the tree by position, using the subtree totals.
+     *      Runtime: O(log n)
+     */
+    const Key &select(unsigned int k) const;
+
+    /**
+     * Input: PersistentTree this - the tree
+     * Returns: N/A
+     * Does: Pretty-prints the tree
+     */
+    void print_tree() const;
+};
+
+#include "PersistentTree.tpp"
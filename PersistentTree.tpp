@@ -0,0 +1,126 @@
+/*
+ * Filename: PersistentTree.tpp
+ * Contains: Implementation of Persistent Trees
+ */
+
+#include <iostream>
+
+#include "pretty_print.h"
+
+/***************************************
+ * BEGIN PUBLIC PERSISTENTTREE SECTION *
+ ***************************************/
+
+/*
+ * A version is just a reference to its root, so taking a snapshot, or
+ *  dropping one, only counts references; nodes are freed when the last
+ *  version that reaches them is dropped.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentTree<Key, Value, Compare>::PersistentTree() : root(Node::nil()) {}
+
+template <typename Key, typename Value, typename Compare>
+PersistentTree<Key, Value, Compare>::PersistentTree(
+    const PersistentTree &source)
+    : root(Node::retain(source.root)) {}
+
+template <typename Key, typename Value, typename Compare>
+PersistentTree<Key, Value, Compare>::~PersistentTree()
+{
+    Node::release(this->root);
+}
+
+/*
+ * Parameters: the source tree to take a snapshot of
+ * Returns: a reference to this tree
+ * Purpose: rhs's root is retained before this one is released, so
+ *      assigning a tree to itself, or to a snapshot of itself, keeps its
+ *      nodes alive.
+ */
+template <typename Key, typename Value, typename Compare>
+PersistentTree<Key, Value, Compare> &
+PersistentTree<Key, Value, Compare>::operator=(const PersistentTree &rhs)
+{
+    Node *old = this->root;
+    this->root = Node::retain(rhs.root);
+    Node::release(old);
+    return *this;
+}
+
+template <typename Key, typename Value, typename Compare>
+const Key &PersistentTree<Key, Value, Compare>::minimum_value() const
+{
+    return this->root->minimum_value()->data;
+}
+
+template <typename Key, typename Value, typename Compare>
+const Key &PersistentTree<Key, Value, Compare>::maximum_value() const
+{
+    return this->root->maximum_value()->data;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int
+PersistentTree<Key, Value, Compare>::count_of(const Key &value) const
+{
+    return this->root->search(value)->count;
+}
+
+template <typename Key, typename Value, typename Compare>
+const Value *
+PersistentTree<Key, Value, Compare>::value_of(const Key &value) const
+{
+    const Node *node = this->root->search(value);
+    return node->is_empty() ? nullptr : &node->value;
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename... Args>
+void PersistentTree<Key, Value, Compare>::insert(K &&value, Args &&...args)
+{
+    this->root = Node::insert(this->root, std::forward<K>(value),
+                              std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Compare>
+void PersistentTree<Key, Value, Compare>::remove(const Key &value)
+{
+    this->root = Node::remove(this->root, value);
+}
+
+template <typename Key, typename Value, typename Compare>
+int PersistentTree<Key, Value, Compare>::tree_height() const
+{
+    return this->root->node_height();
+}
+
+template <typename Key, typename Value, typename Compare>
+int PersistentTree<Key, Value, Compare>::node_count() const
+{
+    return this->root->size;
+}
+
+template <typename Key, typename Value, typename Compare>
+int PersistentTree<Key, Value, Compare>::count_total() const
+{
+    return this->root->total;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int
+PersistentTree<Key, Value, Compare>::rank(const Key &value) const
+{
+    return this->root->rank(value);
+}
+
+template <typename Key, typename Value, typename Compare>
+const Key &PersistentTree<Key, Value, Compare>::select(unsigned int k) const
+{
+    return this->root->select(k)->data;
+}
+
+template <typename Key, typename Value, typename Compare>
+void PersistentTree<Key, Value, Compare>::print_tree() const
+{
+    print_pretty(*this->root, 1, 0, std::cout);
+}
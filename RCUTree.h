@@ -0,0 +1,176 @@
+/*
+ * Filename: RCUTree.h
+ * Contains: Interface of RCU Trees, balanced trees that any number of
+ *      threads read without locks while one thread at a time updates them
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "EpochReclaimer.h"
+#include "PersistentNode.h"
+
+/**
+ * A balanced tree with the keys and counts of AVLTree, read in the style of
+ *  read-copy-update:
+ *    - the tree is a published root of PersistentNodes that is never
+ *      changed in place; readers load it and walk it without taking a lock
+ *      or writing anything shared but their epoch slot (see EpochReclaimer)
+ *    - a writer copies the path it changes off to the side, sharing every
+ *      other node with the published tree, then publishes the new root
+ *      with one atomic store, so a reader sees either the old tree or the
+ *      new one, whole
+ *    - the old root is retired, and the nodes only it reached are freed
+ *      once no reader can still be walking them
+ *
+ * Writers are serialized by a mutex that readers never touch. The results
+ *  of reads are copied out, since the nodes they came from may be freed as
+ *  soon as the read is over.
+ */
+template <typename Key, typename Value = NoValue,
+          typename Compare = std::less<Key>>
+class RCUTree
+{
+private:
+    typedef PersistentNode<Key, Value, Compare> Node;
+
+    /**
+     * The root readers see, which holds one reference to it.
+     */
+    std::atomic<Node *> root;
+
+    /**
+     * Held by the writer while it updates this.
+     */
+    std::mutex writer;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Node next - the root of the new version of this, holding a
+     *            reference the tree takes over
+     * Returns: N/A
+     * Does: publishes next and retires the old root
+     * Assumes: this->writer is held
+     */
+    void publish(Node *next);
+
+    /**
+     * Input: void *root - the root of an old version
+     * Returns: N/A
+     * Does: drops the reference the tree held to root
+     */
+    static void reclaim(void *root);
+
+public:
+    /**
+     * Default constructor. Creates an empty tree.
+     */
+    RCUTree();
+
+    /**
+     * Destructor. Frees the nodes no retired version still shares.
+     * Assumes: no thread is reading or updating this
+     */
+    ~RCUTree();
+
+    RCUTree(const RCUTree &) = delete;
+    RCUTree &operator=(const RCUTree &) = delete;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key value - set to the minimum value in this, if it is not
+     *            empty
+     * Returns: false iff this is empty
+     * Does: reads the published tree without a lock
+     */
+    bool minimum_value(Key &value) const;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key value - set to the maximum value in this, if it is not
+     *            empty
+     * Returns: false iff this is empty
+     * Does: reads the published tree without a lock
+     */
+    bool maximum_value(Key &value) const;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: reads the published tree without a lock
+     */
+    unsigned int count_of(const Key &value) const;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key lo, hi - the bounds of the range, both included
+     * Returns: the number of values in this, including duplicates, that are
+     *      not ordered before lo nor after hi
+     * Does: reads the published tree without a lock. Runtime: O(log n)
+     */
+    unsigned int count_in_range(const Key &lo, const Key &hi) const;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key lo, hi - the bounds of the range, both included
+     *        F visit - called as visit(key, count) for each key in the range
+     * Returns: N/A
+     * Does: visits the keys of one published version of this in the range,
+     *      in order, without a lock. Updates made meanwhile are not seen.
+     *      visit must not update this.
+     */
+    template <typename F>
+    void for_each_in_range(const Key &lo, const Key &hi, F visit) const;
+
+    /**
+     * Input: RCUTree this - the tree
+     * Returns: The number of nodes in this tree
+     */
+    int node_count() const;
+
+    /**
+     * Input: RCUTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     */
+    int count_total() const;
+
+    /**
+     * Input: RCUTree this - the tree
+     * Returns: the height of this. (An empty tree has height -1.)
+     */
+    int tree_height() const;
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key value - value to insert
+     *        Args args - the arguments to construct value's payload with
+     * Returns: N/A
+     * Does: Inserts value as AVLTree does, into a copy of the path to it,
+     *      then publishes it. Runtime: O(log n)
+     */
+    template <typename K, typename... Args>
+    void insert(K &&value, Args &&...args);
+
+    /**
+     * Input: RCUTree this - the tree
+     *        Key value - value to remove
+     * Returns: N/A
+     * Does: Removes one occurrence of value as AVLTree does, from a copy of
+     *      the path to it, then publishes it. Runtime: O(log n)
+     */
+    void remove(const Key &value);
+
+    /**
+     * Input: RCUTree this - the tree
+     * Returns: N/A
+     * Does: Pretty-prints the published tree
+     */
+    void print_tree() const;
+};
+
+#include "RCUTree.tpp"
@@ -0,0 +1,178 @@
+/*
+ * Filename: RCUTree.tpp
+ * Contains: Implementation of RCU Trees
+ */
+
+#include <iostream>
+
+#include "pretty_print.h"
+
+/********************************
+ * BEGIN PUBLIC RCUTREE SECTION *
+ ********************************/
+
+/*
+ * Every read takes a Guard of the shared EpochReclaimer before it loads the
+ *  root, and copies its result out before the Guard is dropped. The root is
+ *  loaded with acquire, pairing with the release that published it, so a
+ *  reader sees every node of the version it loaded fully built.
+ */
+template <typename Key, typename Value, typename Compare>
+RCUTree<Key, Value, Compare>::RCUTree() : root(Node::nil()), writer() {}
+
+template <typename Key, typename Value, typename Compare>
+RCUTree<Key, Value, Compare>::~RCUTree()
+{
+    Node::release(this->root.load(std::memory_order_relaxed));
+}
+
+template <typename Key, typename Value, typename Compare>
+bool RCUTree<Key, Value, Compare>::minimum_value(Key &value) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    const Node *root = this->root.load(std::memory_order_acquire);
+    if (root->is_empty())
+    {
+        return false;
+    }
+    value = root->minimum_value()->data;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool RCUTree<Key, Value, Compare>::maximum_value(Key &value) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    const Node *root = this->root.load(std::memory_order_acquire);
+    if (root->is_empty())
+    {
+        return false;
+    }
+    value = root->maximum_value()->data;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int RCUTree<Key, Value, Compare>::count_of(const Key &value) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    return this->root.load(std::memory_order_acquire)->search(value)->count;
+}
+
+template <typename Key, typename Value, typename Compare>
+unsigned int RCUTree<Key, Value, Compare>::count_in_range(const Key &lo,
+                                                          const Key &hi) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    return this->root.load(std::memory_order_acquire)->count_in_range(lo, hi);
+}
+
+/*
+ * Parameters: RCUTree this - the tree
+ *             Key lo, hi - the bounds of the range
+ *             F visit - the function to call on each key in it
+ * Returns: N/A
+ * Purpose: the whole scan runs under one Guard, so it walks one version
+ *      from start to end however many updates are published meanwhile;
+ *      those only hold back the freeing of the version it walks.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename F>
+void RCUTree<Key, Value, Compare>::for_each_in_range(const Key &lo,
+                                                     const Key &hi,
+                                                     F visit) const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    this->root.load(std::memory_order_acquire)->for_each_in_range(lo, hi,
+                                                                  visit);
+}
+
+template <typename Key, typename Value, typename Compare>
+int RCUTree<Key, Value, Compare>::node_count() const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    return this->root.load(std::memory_order_acquire)->size;
+}
+
+template <typename Key, typename Value, typename Compare>
+int RCUTree<Key, Value, Compare>::count_total() const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    return this->root.load(std::memory_order_acquire)->total;
+}
+
+template <typename Key, typename Value, typename Compare>
+int RCUTree<Key, Value, Compare>::tree_height() const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    return this->root.load(std::memory_order_acquire)->node_height();
+}
+
+/*
+ * Parameters: RCUTree this - the tree
+ *             K value - the key to insert
+ *             Args args - the arguments to construct its payload with
+ * Returns: N/A
+ * Purpose: the update works on a second reference to the root, so the root,
+ *      and every node on the path below it, is shared while it runs and
+ *      PersistentNode copies it rather than changing it under the readers.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename... Args>
+void RCUTree<Key, Value, Compare>::insert(K &&value, Args &&...args)
+{
+    std::lock_guard<std::mutex> lock(this->writer);
+    Node *current = this->root.load(std::memory_order_relaxed);
+    this->publish(Node::insert(Node::retain(current), std::forward<K>(value),
+                               std::forward<Args>(args)...));
+}
+
+template <typename Key, typename Value, typename Compare>
+void RCUTree<Key, Value, Compare>::remove(const Key &value)
+{
+    std::lock_guard<std::mutex> lock(this->writer);
+    Node *current = this->root.load(std::memory_order_relaxed);
+    this->publish(Node::remove(Node::retain(current), value));
+}
+
+template <typename Key, typename Value, typename Compare>
+void RCUTree<Key, Value, Compare>::print_tree() const
+{
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    print_pretty(*this->root.load(std::memory_order_acquire), 1, 0,
+                 std::cout);
+}
+
+/*********************************
+ * BEGIN PRIVATE RCUTREE SECTION *
+ *********************************/
+
+/*
+ * Parameters: RCUTree this - the tree
+ *             Node next - the new root
+ * Returns: N/A
+ * Purpose: an update that changed nothing (removing a key that is not
+ *      there) hands back the root itself, whose second reference is simply
+ *      dropped.
+ */
+template <typename Key, typename Value, typename Compare>
+void RCUTree<Key, Value, Compare>::publish(Node *next)
+{
+    Node *old = this->root.load(std::memory_order_relaxed);
+    if (next == old)
+    {
+        Node::release(next);
+        return;
+    }
+    this->root.store(next, std::memory_order_release);
+    if (!old->is_empty())
+    {
+        EpochReclaimer::shared().retire(old, &RCUTree::reclaim);
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+void RCUTree<Key, Value, Compare>::reclaim(void *root)
+{
+    Node::release(static_cast<Node *>(root));
+}
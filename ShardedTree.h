@@ -0,0 +1,234 @@
+/*
+ * Filename: ShardedTree.h
+ * Contains: Interface of Sharded Trees, which split the int keys among
+ *      independent trees so that threads updating different keys do not
+ *      wait for each other
+ */
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * A tree of int keys split by key range into shards:
+ *    - each shard is a whole Tree (an AVLTree or RBTree of int keys) with
+ *      its own lock and its own NodePool, and holds the keys from its lower
+ *      bound up to the next shard's; a search or update locks only the
+ *      shard its key falls in
+ *    - a shard that has grown to more than twice the size of a neighbour
+ *      hands it half the difference, by splitting its tree and joining the
+ *      part to the neighbour's, then moving the bound between them. Keys
+ *      thus spread out from a hot range to the shards around it
+ *    - minimum_value, count_total, count_in_range and the like lock every
+ *      shard they need, in order, and merge what each one answers, so they
+ *      see all of those shards at one moment
+ *
+ * Threads may call any member at once. The bounds are read without a lock
+ *  to find a key's shard, and checked again once it is locked, since the
+ *  bound between two shards only moves while both are locked.
+ */
+template <typename Tree>
+class ShardedTree
+{
+    static_assert(std::is_same<decltype(std::declval<const Tree &>()
+                                            .minimum_value()),
+                               const int &>::value,
+                  "ShardedTree splits the int key space");
+
+private:
+    struct Shard
+    {
+        mutable std::mutex lock;
+        Tree tree;
+
+        /**
+         * The least key the shard may hold (INT_MIN for the first), and
+         *  its count_total(). Both change only under lock, and are read
+         *  without it only as hints.
+         */
+        std::atomic<int> lower;
+        std::atomic<int> total;
+
+        Shard();
+    };
+
+    std::vector<Shard> shards;
+
+    /**
+     * A shard is only asked to give keys away once it holds this many more
+     *  than twice its neighbour, so that small trees are left alone.
+     */
+    static constexpr int REBALANCE_SLACK = 1024;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - a key
+     * Returns: the index of the shard the bounds, as last read, send value
+     *      to
+     */
+    unsigned int shard_of(int value) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        unsigned int first, last - the indices of a run of shards
+     *        int lo, hi - a range of keys
+     * Returns: true iff the shards from first to last hold every key from
+     *      lo to hi
+     * Assumes: the shards from first to last are locked
+     */
+    bool covers(unsigned int first, unsigned int last, int lo, int hi) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - a key
+     *        unsigned int index - set to the index of value's shard
+     * Returns: the lock of the shard that holds value, held
+     */
+    std::unique_lock<std::mutex> lock_shard_of(int value,
+                                               unsigned int &index) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int lo, hi - a range of keys, lo no greater than hi
+     *        F visit - called as visit(tree) for each shard's tree
+     * Returns: N/A
+     * Does: locks, in order, every shard that holds keys from lo to hi,
+     *      and visits them in order while they are all locked
+     */
+    template <typename F>
+    void for_each_shard(int lo, int hi, F visit) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        unsigned int index - a shard that has just grown
+     * Returns: N/A
+     * Does: moves keys from the shard to its smaller neighbour if it holds
+     *      more than twice as many, plus REBALANCE_SLACK
+     */
+    void rebalance(unsigned int index);
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        Shard lower, upper - two neighbouring shards, lower first,
+     *            both locked
+     *        int count - about how many values to move from the fuller of
+     *            the two to the other
+     * Returns: N/A
+     * Does: splits the fuller shard's tree where the values to move begin
+     *      or end, joins that part to the other tree, and moves the bound
+     *      between the two. Runtime: O(log n)
+     */
+    static void move_values(Shard &lower, Shard &upper, int count);
+
+public:
+    /**
+     * Input: unsigned int count - the number of shards; at least one
+     *        int lo, hi - the keys expected, from which the initial bounds
+     *            are spread evenly; keys outside them still go to the first
+     *            or last shard
+     * Returns: an empty tree
+     */
+    explicit ShardedTree(unsigned int count, int lo = INT_MIN,
+                         int hi = INT_MAX);
+
+    ShardedTree(const ShardedTree &) = delete;
+    ShardedTree &operator=(const ShardedTree &) = delete;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - set to the minimum value in this, if it is not empty
+     * Returns: false iff this is empty
+     * Does: locks every shard, and reads the first that is not empty
+     */
+    bool minimum_value(int &value) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - set to the maximum value in this, if it is not empty
+     * Returns: false iff this is empty
+     * Does: locks every shard, and reads the last that is not empty
+     */
+    bool maximum_value(int &value) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - value to search for
+     * Returns: the number of occurences of value in this, or 0 if value is not
+     *      in this
+     * Does: searches value's shard, under its lock
+     */
+    unsigned int count_of(int value) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - value to insert
+     *        Args args - the arguments to construct value's payload with
+     * Returns: N/A
+     * Does: Inserts value into its shard, under the shard's lock, then
+     *      rebalances the shard with a neighbour if it has grown too big.
+     *      Runtime: O(log n)
+     */
+    template <typename... Args>
+    void insert(int value, Args &&...args);
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int value - value to remove
+     * Returns: N/A
+     * Does: Removes one occurrence of value from its shard, under the
+     *      shard's lock. Runtime: O(log n)
+     */
+    void remove(int value);
+
+    /**
+     * Input: ShardedTree this - the tree
+     * Returns: The number of nodes in all the shards
+     */
+    int node_count() const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     * Returns: the total of all node values, including duplicates.
+     */
+    int count_total() const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int lo, hi - the bounds of the range, both included
+     * Returns: the number of values in this, including duplicates, from lo
+     *      to hi, or 0 if hi is less than lo
+     * Does: adds up the counts of the shards the range spans
+     */
+    unsigned int count_in_range(int lo, int hi) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        int lo, hi - the bounds of the range, both included
+     *        F visit - called as visit(key, count) for each key in the range
+     * Returns: N/A
+     * Does: visits the keys in the range in order, shard by shard, while
+     *      every shard the range spans is locked. visit must not use this.
+     */
+    template <typename F>
+    void for_each_in_range(int lo, int hi, F visit) const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     * Returns: the number of shards
+     */
+    unsigned int shard_count() const;
+
+    /**
+     * Input: ShardedTree this - the tree
+     *        unsigned int index - the index of a shard
+     * Returns: the total of the shard's counts, as last updated
+     */
+    int shard_total(unsigned int index) const;
+};
+
+#include "ShardedTree.tpp"
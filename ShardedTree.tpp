@@ -0,0 +1,362 @@
+/*
+ * Filename: ShardedTree.tpp
+ * Contains: Implementation of Sharded Trees
+ */
+
+#include <algorithm>
+
+template <typename Tree>
+ShardedTree<Tree>::Shard::Shard() : lock(), tree(), lower(INT_MIN), total(0)
+{
+}
+
+/************************************
+ * BEGIN PUBLIC SHARDEDTREE SECTION *
+ ************************************/
+
+/*
+ * Parameters: unsigned int count - the number of shards
+ *             int lo, hi - the keys expected
+ * Returns: an empty tree
+ * Purpose: the bounds are worked out in 64 bits, since hi - lo overflows an
+ *      int for the default range.
+ */
+template <typename Tree>
+ShardedTree<Tree>::ShardedTree(unsigned int count, int lo, int hi)
+    : shards(count)
+{
+    long long span = static_cast<long long>(hi) - lo + 1;
+    for (unsigned int i = 1; i < count; i++)
+    {
+        this->shards[i].lower.store(
+            static_cast<int>(lo + span * i / count), std::memory_order_relaxed);
+    }
+}
+
+template <typename Tree>
+bool ShardedTree<Tree>::minimum_value(int &value) const
+{
+    bool found = false;
+    this->for_each_shard(INT_MIN, INT_MAX, [&](const Tree &tree) {
+        if (!found && tree.count_total() > 0)
+        {
+            value = tree.minimum_value();
+            found = true;
+        }
+    });
+    return found;
+}
+
+template <typename Tree>
+bool ShardedTree<Tree>::maximum_value(int &value) const
+{
+    bool found = false;
+    this->for_each_shard(INT_MIN, INT_MAX, [&](const Tree &tree) {
+        if (tree.count_total() > 0)
+        {
+            value = tree.maximum_value();
+            found = true;
+        }
+    });
+    return found;
+}
+
+template <typename Tree>
+unsigned int ShardedTree<Tree>::count_of(int value) const
+{
+    unsigned int index;
+    std::unique_lock<std::mutex> lock = this->lock_shard_of(value, index);
+    return this->shards[index].tree.count_of(value);
+}
+
+/*
+ * Parameters: ShardedTree this - the tree
+ *             int value - value to insert
+ *             Args args - the arguments to construct its payload with
+ * Returns: N/A
+ * Purpose: the shard is rebalanced after its lock is dropped, since that
+ *      takes the locks of two shards in order.
+ */
+template <typename Tree>
+template <typename... Args>
+void ShardedTree<Tree>::insert(int value, Args &&...args)
+{
+    unsigned int index;
+    {
+        std::unique_lock<std::mutex> lock = this->lock_shard_of(value, index);
+        Shard &shard = this->shards[index];
+        shard.tree.insert(value, std::forward<Args>(args)...);
+        shard.total.store(shard.tree.count_total(), std::memory_order_relaxed);
+    }
+    this->rebalance(index);
+}
+
+template <typename Tree>
+void ShardedTree<Tree>::remove(int value)
+{
+    unsigned int index;
+    std::unique_lock<std::mutex> lock = this->lock_shard_of(value, index);
+    Shard &shard = this->shards[index];
+    shard.tree.remove(value);
+    shard.total.store(shard.tree.count_total(), std::memory_order_relaxed);
+}
+
+template <typename Tree>
+int ShardedTree<Tree>::node_count() const
+{
+    int nodes = 0;
+    this->for_each_shard(INT_MIN, INT_MAX, [&](const Tree &tree) {
+        nodes += tree.node_count();
+    });
+    return nodes;
+}
+
+template <typename Tree>
+int ShardedTree<Tree>::count_total() const
+{
+    int total = 0;
+    this->for_each_shard(INT_MIN, INT_MAX, [&](const Tree &tree) {
+        total += tree.count_total();
+    });
+    return total;
+}
+
+template <typename Tree>
+unsigned int ShardedTree<Tree>::count_in_range(int lo, int hi) const
+{
+    unsigned int count = 0;
+    if (hi < lo)
+    {
+        return 0;
+    }
+    this->for_each_shard(lo, hi, [&](const Tree &tree) {
+        count += tree.count_in_range(lo, hi);
+    });
+    return count;
+}
+
+template <typename Tree>
+template <typename F>
+void ShardedTree<Tree>::for_each_in_range(int lo, int hi, F visit) const
+{
+    if (hi < lo)
+    {
+        return;
+    }
+    this->for_each_shard(lo, hi, [&](const Tree &tree) {
+        for (typename Tree::const_iterator it = tree.lower_bound(lo);
+             it != tree.end() && *it <= hi; ++it)
+        {
+            visit(*it, it.count());
+        }
+    });
+}
+
+template <typename Tree>
+unsigned int ShardedTree<Tree>::shard_count() const
+{
+    return this->shards.size();
+}
+
+template <typename Tree>
+int ShardedTree<Tree>::shard_total(unsigned int index) const
+{
+    return this->shards[index].total.load(std::memory_order_relaxed);
+}
+
+/*************************************
+ * BEGIN PRIVATE SHARDEDTREE SECTION *
+ *************************************/
+
+/*
+ * Parameters: ShardedTree this - the tree
+ *             int value - a key
+ * Returns: the index of the last shard whose lower bound is not above value
+ * Purpose: a binary search over the bounds, which are read without locks
+ *      and so may be caught halfway through a move; the caller checks the
+ *      answer once it holds the shard's lock.
+ */
+template <typename Tree>
+unsigned int ShardedTree<Tree>::shard_of(int value) const
+{
+    unsigned int lo = 0;
+    unsigned int hi = this->shards.size() - 1;
+    while (lo < hi)
+    {
+        unsigned int mid = lo + (hi - lo + 1) / 2;
+        if (this->shards[mid].lower.load(std::memory_order_relaxed) <= value)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+/*
+ * Parameters: ShardedTree this - the tree
+ *             unsigned int first, last - the run of shards
+ *             int lo, hi - the range of keys
+ * Returns: whether the run covers the range
+ * Purpose: the bounds read are first's own and the one above last, both of
+ *      which can only move while a shard of the run is locked, so the
+ *      answer holds for as long as the locks are.
+ */
+template <typename Tree>
+bool ShardedTree<Tree>::covers(unsigned int first, unsigned int last, int lo,
+                               int hi) const
+{
+    if (this->shards[first].lower.load(std::memory_order_relaxed) > lo)
+    {
+        return false;
+    }
+    return last + 1 == this->shards.size() ||
+           hi < this->shards[last + 1].lower.load(std::memory_order_relaxed);
+}
+
+template <typename Tree>
+std::unique_lock<std::mutex>
+ShardedTree<Tree>::lock_shard_of(int value, unsigned int &index) const
+{
+    while (true)
+    {
+        index = this->shard_of(value);
+        std::unique_lock<std::mutex> lock(this->shards[index].lock);
+        if (this->covers(index, index, value, value))
+        {
+            return lock;
+        }
+    }
+}
+
+/*
+ * Parameters: ShardedTree this - the tree
+ *             int lo, hi - the range of keys
+ *             F visit - the function to call on each shard's tree
+ * Returns: N/A
+ * Purpose: shards are always locked from the first up, here and in
+ *      rebalance, so no two threads wait on each other.
+ */
+template <typename Tree>
+template <typename F>
+void ShardedTree<Tree>::for_each_shard(int lo, int hi, F visit) const
+{
+    while (true)
+    {
+        unsigned int first = this->shard_of(lo);
+        unsigned int last = this->shard_of(hi);
+        if (last < first)
+        {
+            continue;
+        }
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(last - first + 1);
+        for (unsigned int i = first; i <= last; i++)
+        {
+            locks.emplace_back(this->shards[i].lock);
+        }
+        if (this->covers(first, last, lo, hi))
+        {
+            for (unsigned int i = first; i <= last; i++)
+            {
+                visit(this->shards[i].tree);
+            }
+            return;
+        }
+    }
+}
+
+/*
+ * Parameters: ShardedTree this - the tree
+ *             unsigned int index - the shard that has just grown
+ * Returns: N/A
+ * Purpose: the sizes are first compared without locks, so that an insert
+ *      into a shard that is not too big costs two loads. If the shard looks
+ *      too big, the pair is locked and compared again, and half the
+ *      difference moves to the neighbour, which leaves the two the same
+ *      size.
+ */
+template <typename Tree>
+void ShardedTree<Tree>::rebalance(unsigned int index)
+{
+    unsigned int count = this->shards.size();
+    if (count == 1)
+    {
+        return;
+    }
+    unsigned int neighbour;
+    if (index == 0)
+    {
+        neighbour = 1;
+    }
+    else if (index + 1 == count)
+    {
+        neighbour = index - 1;
+    }
+    else
+    {
+        neighbour =
+            this->shards[index - 1].total.load(std::memory_order_relaxed) <
+                    this->shards[index + 1].total.load(
+                        std::memory_order_relaxed)
+                ? index - 1
+                : index + 1;
+    }
+    Shard &shard = this->shards[index];
+    Shard &other = this->shards[neighbour];
+    if (shard.total.load(std::memory_order_relaxed) <=
+        2 * other.total.load(std::memory_order_relaxed) + REBALANCE_SLACK)
+    {
+        return;
+    }
+
+    Shard &lower = this->shards[std::min(index, neighbour)];
+    Shard &upper = this->shards[std::max(index, neighbour)];
+    std::lock_guard<std::mutex> lower_lock(lower.lock);
+    std::lock_guard<std::mutex> upper_lock(upper.lock);
+    int total = shard.tree.count_total();
+    int other_total = other.tree.count_total();
+    if (total > 2 * other_total + REBALANCE_SLACK)
+    {
+        move_values(lower, upper, (total - other_total) / 2);
+    }
+}
+
+/*
+ * Parameters: Shard lower, upper - the two shards
+ *             int count - about how many values to move
+ * Returns: N/A
+ * Purpose: the split is made at a key found by select(), and every
+ *      occurrence of that key goes the same way, so a few more or fewer
+ *      values than count may move. The part split off is joined to the
+ *      other tree, and the result handed back to it by a join into the
+ *      emptied tree, so no node is copied; the two shards' pools end up
+ *      sharing the chunks those nodes live in.
+ */
+template <typename Tree>
+void ShardedTree<Tree>::move_values(Shard &lower, Shard &upper, int count)
+{
+    if (lower.tree.count_total() > upper.tree.count_total())
+    {
+        int bound = lower.tree.select(lower.tree.count_total() - count);
+        Tree moved;
+        lower.tree.split(bound, moved);
+        moved.join(upper.tree);
+        upper.tree.join(moved);
+        upper.lower.store(bound, std::memory_order_relaxed);
+    }
+    else
+    {
+        int bound = upper.tree.select(count);
+        Tree kept;
+        upper.tree.split(bound, kept);
+        lower.tree.join(upper.tree);
+        upper.tree.join(kept);
+        upper.lower.store(bound, std::memory_order_relaxed);
+    }
+    lower.total.store(lower.tree.count_total(), std::memory_order_relaxed);
+    upper.total.store(upper.tree.count_total(), std::memory_order_relaxed);
+}
@@ -5,11 +5,12 @@
  */
 
 #include <iostream>
+#include <vector>
 #include "BSTree.h"
 
 using namespace std;
 
-void print_tree_details(BSTree &t)
+void print_tree_details(BSTree<int> &t)
 {
         t.print_tree();
         cout << "\n";
@@ -23,7 +24,7 @@ void print_tree_details(BSTree &t)
 
 int main()
 {
-        BSTree t;
+        BSTree<int> t;
         int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
         int num_values = sizeof(values) / sizeof(int);
 
@@ -36,12 +37,12 @@ int main()
         print_tree_details(t);
 
         // make a copy with copy constructor
-        BSTree t_copy_constructor = t;
+        BSTree<int> t_copy_constructor = t;
         cout << "\nPrinting copied tree (by constructor):" << endl;
         t_copy_constructor.print_tree();
 
         // make a copy with assignment overload
-        BSTree t_copy_1;
+        BSTree<int> t_copy_1;
         t_copy_1 = t;
         cout << "\nPrinting copied tree (by assignment):" << endl;
         t_copy_1.print_tree();
@@ -89,6 +90,109 @@ int main()
 
         t = t_copy_1;
 
+        // rank, select and ranges, which read the subtree sizes and totals
+        //  kept up to date through the removals
+        BSTree<int> t_ranked = t;
+        t_ranked.remove(9);
+        t_ranked.remove(5);
+        t_ranked.remove(-6);
+        cout << "Ranks and ranges after removing 9, 5 and -6:\n";
+        print_tree_details(t_ranked);
+        // only a tree whose Sum is KeySum keeps the sums sum_in_range reads
+        BSTree<int, NoValue, less<int>, KeySum> t_summed;
+        cout << "in order by select:";
+        for (int k = 0; k < t_ranked.count_total(); k++)
+        {
+                cout << " " << t_ranked.select(k);
+                t_summed.insert(t_ranked.select(k));
+        }
+        cout << "\n";
+        for (int i = 0; i < 20; i += 5)
+        {
+                cout << "rank of " << i << ": " << t_ranked.rank(i) << "\n";
+        }
+        cout << "quantiles 0, 0.5, 1: " << t_ranked.quantile(0) << ", "
+             << t_ranked.quantile(0.5) << ", " << t_ranked.quantile(1)
+             << "\n";
+        cout << "values from 2 to 13: " << t_ranked.count_in_range(2, 13)
+             << ", summing to " << t_summed.sum_in_range(2, 13) << "\n";
+        cout << "values from 13 to 2: " << t_ranked.count_in_range(13, 2)
+             << "\n\n";
+
+        // walk the tree in order, and look up the run of a key
+        cout << "In order (value x count):";
+        for (BSTree<int>::const_iterator it = t.begin(); it != t.end(); ++it)
+        {
+                cout << " " << *it << "x" << it.count();
+        }
+        cout << "\n";
+        for (int i = 5; i <= 6; i++)
+        {
+                auto range = t.equal_range(i);
+                cout << "equal_range(" << i << "): "
+                     << (range.first == range.second ? "empty" : "found")
+                     << ", next value "
+                     << (range.second == t.end() ? -1 : *range.second)
+                     << "\n";
+        }
+        cout << "\n";
+
+        // build a big tree from a sorted range, then copy it both ways
+        vector<int> sorted;
+        for (int i = 0; i < 100000; i++)
+        {
+                sorted.push_back(i / 2);
+        }
+        BSTree<int> t_big;
+        t_big.assign_sorted(sorted.begin(), sorted.end());
+        BSTree<int> t_big_copy = t_big;
+        BSTree<int> t_big_assigned;
+        t_big_assigned = t_big;
+        cout << "Big tree: " << t_big.node_count() << " nodes, "
+             << t_big.count_total() << " values, height "
+             << t_big.tree_height() << "\n";
+        bool copied = t_big_copy.count_total() == t_big.count_total() &&
+                      t_big_assigned.count_total() == t_big.count_total();
+        cout << "copies (constructed, assigned): "
+             << t_big_copy.count_total() << ", "
+             << t_big_assigned.count_total() << ", "
+             << (copied ? "equal" : "not equal") << "\n\n";
+
+        // batches of inserts and removes: a batch less than an eighth of
+        //  the tree is applied a key at a time, a bigger one by rebuilding
+        BSTree<int> t_batch;
+        for (int i = 0; i < 1000; i++)
+        {
+                t_batch.insert(i * 7 % 1000);
+        }
+        vector<int> small_batch, big_batch;
+        for (int i = 0; i < 50; i++)
+        {
+                small_batch.push_back(2000 - i);
+        }
+        for (int i = 0; i < 500; i++)
+        {
+                big_batch.push_back(i * 3 % 1500);
+        }
+        cout << "Batch tree: " << t_batch.node_count() << " nodes, "
+             << t_batch.count_total() << " values\n";
+        t_batch.insert_batch(small_batch.begin(), small_batch.end());
+        cout << "after inserting 50 values one at a time: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.insert_batch(big_batch.begin(), big_batch.end());
+        cout << "after inserting 500 values by rebuilding: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.remove_batch(small_batch.begin(), small_batch.end());
+        cout << "after removing 50 values one at a time: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.remove_batch(big_batch.begin(), big_batch.end());
+        cout << "after removing 500 values by rebuilding: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n\n";
+
         // check if the tree contains values
         for (int i = -10; i < 20; i++)
         {
@@ -0,0 +1,91 @@
+/*
+ * main_btree.cpp
+ *
+ *  Main driver for testing the BTree class
+ */
+
+#include <iostream>
+#include "BTree.h"
+
+using namespace std;
+
+void print_tree_details(BTree &t)
+{
+        t.print_tree();
+        cout << "\n";
+        cout << "min: " << t.minimum_value() << "\n";
+        cout << "max: " << t.maximum_value() << "\n";
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "tree height: " << t.tree_height() << "\n";
+        cout << endl;
+}
+
+int main()
+{
+        BTree t;
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree "
+             << "(asterisk denotes a count of more than 1):\n";
+        print_tree_details(t);
+
+        // make a copy with copy constructor
+        BTree t_copy_constructor = t;
+        cout << "\nPrinting copied tree (by constructor):" << endl;
+        t_copy_constructor.print_tree();
+
+        // make a copy with assignment overload
+        BTree t_copy_1;
+        t_copy_1 = t;
+        cout << "\nPrinting copied tree (by assignment):" << endl;
+        t_copy_1.print_tree();
+
+        // remove a value with a count of 1
+        cout << "Removing 9 from original tree:\n";
+        t.remove(9);
+        print_tree_details(t);
+
+        t = t_copy_1;
+
+        // remove a value with a count of 2
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        t = t_copy_1;
+
+        // fill the root so that it splits
+        cout << "Inserting 20 through 59 into original tree:\n";
+        for (int i = 20; i < 60; i++)
+        {
+                t.insert(i);
+        }
+        print_tree_details(t);
+
+        // remove from the leaves until nodes have to merge
+        cout << "Removing 20 through 49 from that tree:\n";
+        for (int i = 20; i < 50; i++)
+        {
+                t.remove(i);
+        }
+        print_tree_details(t);
+
+        t = t_copy_1;
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * main_cavlt.cpp
+ *
+ *  Main driver for testing the ConcurrentAVLTree class
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "ConcurrentAVLTree.h"
+
+using namespace std;
+
+void print_tree_details(ConcurrentAVLTree<int> &t)
+{
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "tree height: " << t.tree_height() << "\n";
+        cout << "\n";
+}
+
+int main()
+{
+        ConcurrentAVLTree<int> t;
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree:\n";
+        print_tree_details(t);
+
+        // remove a node with two children (it is kept as a routing node)
+        cout << "Removing 9 from original tree:\n";
+        t.remove(9);
+        print_tree_details(t);
+
+        // remove a node with one child (but the count is 2)
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        // each thread inserts its own range of keys, then removes the odd
+        //  ones, while all of them insert and remove the same shared keys
+        const int threads = 4;
+        const int range = 2000;
+        vector<thread> workers;
+        for (int w = 0; w < threads; w++)
+        {
+                workers.emplace_back([&t, w]() {
+                        int first = 100 + w * range;
+                        for (int i = first; i < first + range; i++)
+                        {
+                                t.insert(i);
+                                t.insert(-i % 50);
+                        }
+                        for (int i = first + 1; i < first + range; i += 2)
+                        {
+                                t.remove(i);
+                                t.remove(-i % 50);
+                        }
+                });
+        }
+        for (thread &worker : workers)
+        {
+                worker.join();
+        }
+        cout << "After " << threads << " threads updated it at once:\n";
+        print_tree_details(t);
+
+        int missing = 0;
+        for (int i = 100; i < 100 + threads * range; i++)
+        {
+                missing += (t.count_of(i) != (i % 2 == 0 ? 1u : 0u));
+        }
+        cout << "Keys with the wrong count: " << missing << "\n\n";
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * main_itree.cpp
+ *
+ *  Main driver for testing the IndexedTree class
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "IndexedTree.h"
+
+using namespace std;
+
+void print_tree_details(IndexedTree<int> &t)
+{
+        cout << "In order (value x count):";
+        t.for_each([](int value, int count) {
+                cout << " " << value << "x" << count;
+        });
+        cout << "\n";
+        cout << "min: " << t.minimum_value() << "\n";
+        cout << "max: " << t.maximum_value() << "\n";
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "tree height: " << t.tree_height() << "\n";
+        cout << "\n";
+}
+
+int main()
+{
+        IndexedTree<int> t;
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree (" << sizeof(IndexedTree<int>::Node)
+             << " bytes a node):\n";
+        print_tree_details(t);
+
+        // copying copies the node vector, with no links to fix up
+        IndexedTree<int> t_copy = t;
+        cout << "Copy (by constructor):\n";
+        print_tree_details(t_copy);
+
+        // remove a node with two children
+        cout << "Removing 9 from original tree:\n";
+        t.remove(9);
+        print_tree_details(t);
+
+        t = t_copy;
+
+        // remove a node with one child (but the count is 2)
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        t = t_copy;
+
+        // remove enough nodes to rotate, and move the last nodes into
+        //  their slots
+        cout << "Removing -6, 1, 3 and 4 from original tree:\n";
+        t.remove(-6);
+        t.remove(1);
+        t.remove(3);
+        t.remove(4);
+        print_tree_details(t);
+
+        t = t_copy;
+
+        // write the node vector out as it is and read it back
+        stringstream image;
+        t.write(image);
+        IndexedTree<int> t_read;
+        bool read = t_read.read(image);
+        cout << "Read tree (image " << (read ? "read" : "not read")
+             << "):\n";
+        print_tree_details(t_read);
+
+        // a cut-short image, or one whose header promises more nodes than
+        //  follow, is refused without allocating for them
+        string bytes = image.str();
+        stringstream cut(bytes.substr(0, bytes.size() - 1));
+        stringstream lying(bytes);
+        unsigned int huge = 0x7fffffff;
+        lying.write(reinterpret_cast<const char *>(&huge), sizeof(huge));
+        lying.seekg(0);
+        cout << "Cut-short image "
+             << (t_read.read(cut) ? "read" : "not read")
+             << ", nodes: " << t_read.node_count() << "\n";
+        cout << "Image claiming 2^31 - 1 nodes "
+             << (t_read.read(lying) ? "read" : "not read")
+             << ", nodes: " << t_read.node_count() << "\n\n";
+
+        // a big tree stays balanced through insertions and removals, and
+        //  its image still reads back as a Red-Black Tree
+        IndexedTree<int> t_big;
+        t_big.reserve(100000);
+        for (int i = 0; i < 100000; i++)
+        {
+                t_big.insert((i * 7919) % 100000);
+        }
+        for (int i = 0; i < 100000; i += 2)
+        {
+                t_big.remove(i);
+        }
+        stringstream big_image;
+        t_big.write(big_image);
+        cout << "Big tree after removing the even values: nodes: "
+             << t_big.node_count() << ", height: " << t_big.tree_height()
+             << ", image " << (t_read.read(big_image) ? "read" : "not read")
+             << "\n\n";
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * main_ptree.cpp
+ *
+ *  Main driver for testing the PersistentTree class
+ */
+
+#include <iostream>
+#include "PersistentTree.h"
+
+using namespace std;
+
+void print_tree_details(PersistentTree<int> &t)
+{
+        t.print_tree();
+        cout << "\n";
+        cout << "min: " << t.minimum_value() << "\n";
+        cout << "max: " << t.maximum_value() << "\n";
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "tree height: " << t.tree_height() << "\n";
+        cout << "\n";
+}
+
+int main()
+{
+        PersistentTree<int> t;
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree "
+             << "(asterisk denotes a count of more than 1):\n";
+        print_tree_details(t);
+
+        // take a snapshot with the copy constructor
+        PersistentTree<int> t_snapshot = t;
+        cout << "\nPrinting snapshot (by constructor):" << endl;
+        t_snapshot.print_tree();
+
+        // take a snapshot with assignment
+        PersistentTree<int> t_copy_1;
+        t_copy_1 = t;
+        cout << "\nPrinting snapshot (by assignment):" << endl;
+        t_copy_1.print_tree();
+
+        // remove a node with two children
+        cout << "Removing 9 from original tree:\n";
+        t.remove(9);
+        print_tree_details(t);
+
+        // the snapshots do not see the removal
+        cout << "Snapshot after removing 9 from original tree:\n";
+        print_tree_details(t_snapshot);
+
+        t = t_copy_1;
+
+        // remove a node with one child (but the count is 2)
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        t = t_copy_1;
+
+        // remove enough nodes to rotate
+        cout << "Removing -6, 1 and 3 from original tree:\n";
+        t.remove(-6);
+        t.remove(1);
+        t.remove(3);
+        print_tree_details(t);
+
+        // insert into a snapshot, leaving the original as it is
+        cout << "Inserting 7 and 8 into snapshot:\n";
+        t_snapshot.insert(7);
+        t_snapshot.insert(8);
+        print_tree_details(t_snapshot);
+        cout << "Original tree after inserting into snapshot:\n";
+        print_tree_details(t);
+
+        t = t_copy_1;
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
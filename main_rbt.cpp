@@ -5,11 +5,13 @@
  */
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 #include "RBTree.h"
 
 using namespace std;
 
-void print_tree_details(RBTree &t)
+void print_tree_details(RBTree<int> &t)
 {
         t.print_tree();
         cout << "\n";
@@ -23,7 +25,7 @@ void print_tree_details(RBTree &t)
 
 int main()
 {
-        RBTree t;
+        RBTree<int> t;
         int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
         // int values[] = {4, 2, 11, 15, 9, 1, -6};
         int num_values = sizeof(values) / sizeof(int);
@@ -39,12 +41,12 @@ int main()
         print_tree_details(t);
 
         // make a copy with copy constructor
-        RBTree t_copy_constructor = t;
+        RBTree<int> t_copy_constructor = t;
         // cout << "\nPrinting copied tree (by constructor):" << endl;
         // t_copy_constructor.print_tree();
 
         // make a copy with assignment overload
-        RBTree t_copy_1;
+        RBTree<int> t_copy_1;
         t_copy_1 = t;
         // cout << "\nPrinting copied tree (by assignment):" << endl;
         // t_copy_1.print_tree();
@@ -92,6 +94,198 @@ int main()
 
         t = t_copy_1;
 
+        // freeze the tree in both layouts, and look values up in each
+        FrozenTree eytzinger = t.freeze(FrozenTree::EYTZINGER);
+        FrozenTree van_emde_boas = t.freeze(FrozenTree::VAN_EMDE_BOAS);
+        cout << "Frozen trees (Eytzinger, van Emde Boas):\n";
+        cout << "nodes: " << eytzinger.node_count() << ", "
+             << van_emde_boas.node_count() << "\n";
+        for (int i = -6; i < 20; i += 4)
+        {
+                cout << "count of " << i << ": " << eytzinger.count_of(i)
+                     << ", " << van_emde_boas.count_of(i) << "\n";
+        }
+        cout << "\n";
+
+        // pack the tree, write the image out, read it back and unpack it
+        stringstream image;
+        t.pack().write(image);
+        PackedTree packed;
+        bool read = packed.read(image);
+        RBTree<int> t_unpacked;
+        t_unpacked.unpack(packed);
+        cout << "Unpacked tree (image " << (read ? "read" : "not read")
+             << ", " << packed.node_count() << " nodes):\n";
+        print_tree_details(t_unpacked);
+
+        // rank, select and ranges, which read the subtree sizes and totals
+        //  kept up to date through the removals
+        RBTree<int> t_ranked = t;
+        t_ranked.remove(9);
+        t_ranked.remove(5);
+        t_ranked.remove(-6);
+        cout << "Ranks and ranges after removing 9, 5 and -6:\n";
+        print_tree_details(t_ranked);
+        // only a tree whose Sum is KeySum keeps the sums sum_in_range reads
+        RBTree<int, NoValue, less<int>, RBBalance, KeySum> t_summed;
+        cout << "in order by select:";
+        for (int k = 0; k < t_ranked.count_total(); k++)
+        {
+                cout << " " << t_ranked.select(k);
+                t_summed.insert(t_ranked.select(k));
+        }
+        cout << "\n";
+        for (int i = 0; i < 20; i += 5)
+        {
+                cout << "rank of " << i << ": " << t_ranked.rank(i) << "\n";
+        }
+        cout << "quantiles 0, 0.5, 1: " << t_ranked.quantile(0) << ", "
+             << t_ranked.quantile(0.5) << ", " << t_ranked.quantile(1)
+             << "\n";
+        cout << "values from 2 to 13: " << t_ranked.count_in_range(2, 13)
+             << ", summing to " << t_summed.sum_in_range(2, 13) << "\n";
+        cout << "values from 13 to 2: " << t_ranked.count_in_range(13, 2)
+             << "\n\n";
+
+        // walk the tree in order, and look up the run of a key
+        cout << "In order (value x count):";
+        for (RBTree<int>::const_iterator it = t.begin(); it != t.end(); ++it)
+        {
+                cout << " " << *it << "x" << it.count();
+        }
+        cout << "\n";
+        for (int i = 5; i <= 6; i++)
+        {
+                auto range = t.equal_range(i);
+                cout << "equal_range(" << i << "): "
+                     << (range.first == range.second ? "empty" : "found")
+                     << ", next value "
+                     << (range.second == t.end() ? -1 : *range.second)
+                     << "\n";
+        }
+        cout << "\n";
+
+        // build a big tree from a sorted range, then copy it both ways
+        vector<int> sorted;
+        for (int i = 0; i < 100000; i++)
+        {
+                sorted.push_back(i / 2);
+        }
+        RBTree<int> t_big;
+        t_big.assign_sorted(sorted.begin(), sorted.end());
+        RBTree<int> t_big_copy = t_big;
+        RBTree<int> t_big_assigned;
+        t_big_assigned = t_big;
+        cout << "Big tree: " << t_big.node_count() << " nodes, "
+             << t_big.count_total() << " values, height "
+             << t_big.tree_height() << "\n";
+        bool copied = t_big_copy.count_total() == t_big.count_total() &&
+                      t_big_assigned.count_total() == t_big.count_total();
+        cout << "copies (constructed, assigned): "
+             << t_big_copy.count_total() << ", "
+             << t_big_assigned.count_total() << ", "
+             << (copied ? "equal" : "not equal") << "\n\n";
+
+        // batches of inserts and removes: a batch less than an eighth of
+        //  the tree is applied a key at a time, a bigger one by rebuilding
+        RBTree<int> t_batch;
+        for (int i = 0; i < 1000; i++)
+        {
+                t_batch.insert(i * 7 % 1000);
+        }
+        vector<int> small_batch, big_batch;
+        for (int i = 0; i < 50; i++)
+        {
+                small_batch.push_back(2000 - i);
+        }
+        for (int i = 0; i < 500; i++)
+        {
+                big_batch.push_back(i * 3 % 1500);
+        }
+        cout << "Batch tree: " << t_batch.node_count() << " nodes, "
+             << t_batch.count_total() << " values\n";
+        t_batch.insert_batch(small_batch.begin(), small_batch.end());
+        cout << "after inserting 50 values one at a time: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.insert_batch(big_batch.begin(), big_batch.end());
+        cout << "after inserting 500 values by rebuilding: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.remove_batch(small_batch.begin(), small_batch.end());
+        cout << "after removing 50 values one at a time: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n";
+        t_batch.remove_batch(big_batch.begin(), big_batch.end());
+        cout << "after removing 500 values by rebuilding: "
+             << t_batch.node_count() << " nodes, " << t_batch.count_total()
+             << " values, height " << t_batch.tree_height() << "\n\n";
+
+        // split a copy of the tree at 5, then join the two halves back
+        RBTree<int> t_lower = t;
+        RBTree<int> t_upper;
+        t_lower.split(5, t_upper);
+        cout << "Split at 5, the values before it:\n";
+        print_tree_details(t_lower);
+        cout << "and the rest:\n";
+        print_tree_details(t_upper);
+        t_lower.join(t_upper);
+        cout << "Joined back (the rest now has " << t_upper.count_total()
+             << " values):\n";
+        print_tree_details(t_lower);
+
+        // union, intersection and difference of the tree with another
+        int other_values[] = {5, 6, 7, 11, 11, 20};
+        RBTree<int> t_other;
+        for (int value : other_values)
+        {
+                t_other.insert(value);
+        }
+        RBTree<int> t_union = t, t_union_other = t_other;
+        t_union.union_with(t_union_other);
+        RBTree<int> t_intersection = t, t_intersection_other = t_other;
+        t_intersection.intersect_with(t_intersection_other);
+        RBTree<int> t_difference = t, t_difference_other = t_other;
+        t_difference.difference_with(t_difference_other);
+        cout << "With the values 5, 6, 7, 11, 11 and 20 (nodes, count "
+             << "total):\n";
+        cout << "union: " << t_union.node_count() << ", "
+             << t_union.count_total() << "\n";
+        cout << "intersection: " << t_intersection.node_count() << ", "
+             << t_intersection.count_total() << "\n";
+        cout << "difference: " << t_difference.node_count() << ", "
+             << t_difference.count_total() << "\n";
+        t_union.union_with(t_union);
+        cout << "union with itself: " << t_union.node_count() << ", "
+             << t_union.count_total() << "\n";
+
+        // trees big enough to be combined in parallel: the multiples of 2
+        //  and the multiples of 3 below 60000
+        RBTree<int> t_twos, t_threes;
+        for (int i = 0; i < 60000; i += 2)
+        {
+                t_twos.insert(i);
+        }
+        for (int i = 0; i < 60000; i += 3)
+        {
+                t_threes.insert(i);
+        }
+        RBTree<int> t_big_union = t_twos, t_big_union_other = t_threes;
+        t_big_union.union_with(t_big_union_other);
+        RBTree<int> t_big_intersection = t_twos;
+        RBTree<int> t_big_intersection_other = t_threes;
+        t_big_intersection.intersect_with(t_big_intersection_other);
+        RBTree<int> t_big_difference = t_twos;
+        RBTree<int> t_big_difference_other = t_threes;
+        t_big_difference.difference_with(t_big_difference_other);
+        cout << "Multiples of 2 and of 3 below 60000 (nodes, count total):\n";
+        cout << "union: " << t_big_union.node_count() << ", "
+             << t_big_union.count_total() << "\n";
+        cout << "intersection: " << t_big_intersection.node_count() << ", "
+             << t_big_intersection.count_total() << "\n";
+        cout << "difference: " << t_big_difference.node_count() << ", "
+             << t_big_difference.count_total() << "\n\n";
+
         // check if the tree contains values
         for (int i = -10; i < 20; i++)
         {
@@ -0,0 +1,126 @@
+/*
+ * main_rcutree.cpp
+ *
+ *  Main driver for testing the RCUTree class
+ */
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "RCUTree.h"
+
+using namespace std;
+
+void print_tree_details(RCUTree<int> &t)
+{
+        int min = 0;
+        int max = 0;
+        t.print_tree();
+        cout << "\n";
+        if (t.minimum_value(min) && t.maximum_value(max))
+        {
+                cout << "min: " << min << "\n";
+                cout << "max: " << max << "\n";
+        }
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "tree height: " << t.tree_height() << "\n";
+        cout << "\n";
+}
+
+// Returns: the number of even values from 1000 to 1999 in t
+unsigned int count_evens(RCUTree<int> &t)
+{
+        unsigned int evens = 0;
+        t.for_each_in_range(1000, 1999, [&](int value, unsigned int) {
+                evens += (value % 2 == 0);
+        });
+        return evens;
+}
+
+int main()
+{
+        RCUTree<int> t;
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree "
+             << "(asterisk denotes a count of more than 1):\n";
+        print_tree_details(t);
+
+        // remove a node with two children
+        cout << "Removing 9 from original tree:\n";
+        t.remove(9);
+        print_tree_details(t);
+
+        // remove a node with one child (but the count is 2)
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        // scan a range
+        cout << "Values from 2 to 13:";
+        t.for_each_in_range(2, 13, [](int value, unsigned int count) {
+                cout << " " << value << " (x" << count << ")";
+        });
+        cout << "\ncount in range: " << t.count_in_range(2, 13) << "\n\n";
+
+        // readers scan while one writer inserts and removes the odd values
+        //  from 1001 to 1999, so every read sees all of the even ones
+        const int readers = 4;
+        atomic<bool> done(false);
+        atomic<int> bad_reads(0);
+        for (int i = 1000; i < 2000; i += 2)
+        {
+                t.insert(i);
+        }
+        vector<thread> threads;
+        for (int r = 0; r < readers; r++)
+        {
+                threads.emplace_back([&]() {
+                        while (!done.load())
+                        {
+                                if (count_evens(t) != 500 ||
+                                    t.count_of(1000) != 1)
+                                {
+                                        bad_reads++;
+                                }
+                        }
+                });
+        }
+        for (int round = 0; round < 20; round++)
+        {
+                for (int i = 1001; i < 2000; i += 2)
+                {
+                        t.insert(i);
+                }
+                for (int i = 1001; i < 2000; i += 2)
+                {
+                        t.remove(i);
+                }
+        }
+        done = true;
+        for (thread &reader : threads)
+        {
+                reader.join();
+        }
+        cout << "Readers that saw a partial tree: " << bad_reads << "\n";
+        cout << "Values from 1000 to 1999: " << t.count_in_range(1000, 1999)
+             << "\n";
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
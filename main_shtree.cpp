@@ -0,0 +1,112 @@
+/*
+ * main_shtree.cpp
+ *
+ *  Main driver for testing the ShardedTree class
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "AVLTree.h"
+#include "ShardedTree.h"
+
+using namespace std;
+
+void print_tree_details(ShardedTree<AVLTree<int>> &t)
+{
+        int value;
+        if (t.minimum_value(value))
+        {
+                cout << "min: " << value << "\n";
+        }
+        if (t.maximum_value(value))
+        {
+                cout << "max: " << value << "\n";
+        }
+        cout << "nodes: " << t.node_count() << "\n";
+        cout << "count total: " << t.count_total() << "\n";
+        cout << "shard totals:";
+        for (unsigned int i = 0; i < t.shard_count(); i++)
+        {
+                cout << " " << t.shard_total(i);
+        }
+        cout << "\n\n";
+}
+
+int main()
+{
+        ShardedTree<AVLTree<int>> t(4, 0, 3999);
+        int values[] = {4, 2, 11, 15, 9, 1, -6, 5, 3, 15, 2, 5, 13, 14};
+        int num_values = sizeof(values) / sizeof(int);
+
+        for (int i = 0; i < num_values; i++)
+        {
+                t.insert(values[i]);
+        }
+        cout << "Original tree:\n";
+        print_tree_details(t);
+
+        // remove a value with a count of 2
+        cout << "Removing 5 from original tree "
+             << "(should still have one 5):\n";
+        t.remove(5);
+        print_tree_details(t);
+
+        // every key lands in the first shard, which hands keys on to the
+        //  others as it grows
+        for (int i = 100; i < 6100; i++)
+        {
+                t.insert(i % 1000);
+        }
+        cout << "After 6000 inserts into the first shard's range:\n";
+        print_tree_details(t);
+
+        // each thread inserts its own range of keys, then removes the odd
+        //  ones, while the shards rebalance under them
+        const int threads = 4;
+        const int range = 2000;
+        vector<thread> workers;
+        for (int w = 0; w < threads; w++)
+        {
+                workers.emplace_back([&t, w]() {
+                        int first = 10000 + w * range;
+                        for (int i = first; i < first + range; i++)
+                        {
+                                t.insert(i);
+                        }
+                        for (int i = first + 1; i < first + range; i += 2)
+                        {
+                                t.remove(i);
+                        }
+                });
+        }
+        for (thread &worker : workers)
+        {
+                worker.join();
+        }
+        cout << "After " << threads << " threads updated it at once:\n";
+        print_tree_details(t);
+
+        int missing = 0;
+        for (int i = 10000; i < 10000 + threads * range; i++)
+        {
+                missing += (t.count_of(i) != (i % 2 == 0 ? 1u : 0u));
+        }
+        cout << "Keys with the wrong count: " << missing << "\n";
+        cout << "Values from 0 to 999: " << t.count_in_range(0, 999) << "\n";
+        cout << "Values from 10 to 20:";
+        t.for_each_in_range(10, 20, [](int key, unsigned int count) {
+                cout << " " << key << "x" << count;
+        });
+        cout << "\n\n";
+
+        // check if the tree contains values
+        for (int i = -10; i < 20; i++)
+        {
+                cout << "Original Tree "
+                     << (t.count_of(i) > 0 ? "contains " : "does not contain ")
+                     << "the value " << i << "\n";
+        }
+        cout << "\nFinished!\n";
+        return 0;
+}
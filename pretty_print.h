@@ -1,14 +1,17 @@
 #ifndef __PRETTY_PRINT_H__
 #define __PRETTY_PRINT_H__
 
-#include "BSTNode.h"
+#include <iostream>
 
 /*
  * Input: N/A
  * Returns: N/A
- * Does: Pretty-prints the tree rooted at root. See pretty_print.cpp for
+ * Does: Pretty-prints the tree rooted at root. See pretty_print.tpp for
  *      details
  */
-void print_pretty(BSTNode &root, int level, int indent_space, std::ostream &out);
+template <typename Node>
+void print_pretty(Node &root, int level, int indent_space, std::ostream &out);
+
+#include "pretty_print.tpp"
 
 #endif
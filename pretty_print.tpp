@@ -7,41 +7,38 @@
  * 
  */
 
-#include <fstream>
-#include <iostream>
+#include <cmath>
 #include <deque>
 #include <iomanip>
-#include <sstream>
+#include <iostream>
 #include <string>
-#include <cmath>
-
-#include "pretty_print.h"
-
-using namespace std;
 
 // Print the arm branches (eg, /    \ ) on a line
+template <typename Node>
 void print_branches(int branch_len,
                     int node_space_len,
                     int start_len,
                     int nodes_in_this_level,
-                    const deque<BSTNode *> &nodes_queue,
-                    ostream &out)
+                    const std::deque<Node *> &nodes_queue,
+                    std::ostream &out)
 {
-    deque<BSTNode *>::const_iterator iter = nodes_queue.begin();
+    typename std::deque<Node *>::const_iterator iter = nodes_queue.begin();
     for (int i = 0; i < nodes_in_this_level / 2; i++)
     {
         bool has_left = (*iter) && !(*iter)->is_empty();
         iter++;
         bool has_right = (*iter) && !(*iter)->is_empty();
         iter++;
-        out << ((i == 0) ? setw(start_len - 1) : setw(node_space_len - 2))
+        out << ((i == 0) ? std::setw(start_len - 1)
+                         : std::setw(node_space_len - 2))
             << "" << ((has_left) ? "/" : " ");
-        out << setw(2 * branch_len + 2) << "" << ((has_right) ? "\\" : " ");
+        out << std::setw(2 * branch_len + 2) << "" << ((has_right) ? "\\" : " ");
     }
-    out << endl;
+    out << std::endl;
 }
 
-bool tree_has_child(BSTNode *node, bool left)
+template <typename Node>
+bool tree_has_child(Node *node, bool left)
 {
     if (left)
     {
@@ -54,37 +51,39 @@ bool tree_has_child(BSTNode *node, bool left)
 }
 
 // Print the branches and node (eg, ___10___ )
+template <typename Node>
 void print_nodes(int branch_len, int node_space_len, int start_len,
-                 int nodes_in_this_level, const deque<BSTNode *> &nodes_queue,
-                 ostream &out)
+                 int nodes_in_this_level, const std::deque<Node *> &nodes_queue,
+                 std::ostream &out)
 {
-    deque<BSTNode *>::const_iterator iter = nodes_queue.begin();
+    typename std::deque<Node *>::const_iterator iter = nodes_queue.begin();
     for (int i = 0; i < nodes_in_this_level; i++, iter++)
     {
         bool has_left = tree_has_child(*iter, true);
         bool has_right = tree_has_child(*iter, false);
-        out << setw(((i == 0) ? start_len : node_space_len))
+        out << std::setw(((i == 0) ? start_len : node_space_len))
             << ""
-            << setfill(has_left ? '_' : ' ');
-        out << setw(branch_len + 2)
+            << std::setfill(has_left ? '_' : ' ');
+        out << std::setw(branch_len + 2)
             << (*iter)->to_string();
-        out << setfill(has_right ? '_' : ' ')
-            << setw(branch_len) << "" << setfill(' ');
+        out << std::setfill(has_right ? '_' : ' ')
+            << std::setw(branch_len) << "" << std::setfill(' ');
     }
-    out << endl;
+    out << std::endl;
 }
 
 // Print the leaves only (just for the bottom row)
+template <typename Node>
 void print_leaves(int indent_space, int level, int nodes_in_this_level,
-                  const deque<BSTNode *> &nodes_queue, ostream &out)
+                  const std::deque<Node *> &nodes_queue, std::ostream &out)
 {
-    deque<BSTNode *>::const_iterator iter = nodes_queue.begin();
+    typename std::deque<Node *>::const_iterator iter = nodes_queue.begin();
     for (int i = 0; i < nodes_in_this_level; i++, iter++)
     {
-        out << setw((i == 0) ? (indent_space + 2) : (2 * level + 2))
+        out << std::setw((i == 0) ? (indent_space + 2) : (2 * level + 2))
             << (*iter)->to_string();
     }
-    out << endl;
+    out << std::endl;
 }
 
 // Pretty formatting of a binary tree to the output stream
@@ -95,24 +94,26 @@ void print_leaves(int indent_space, int level, int nodes_in_this_level,
 // indent_space  Change this to add some indent space to the left (eg,
 //     indent_space of 0 means the lowest level of the left node will stick to
 //     the left margin)
-void print_pretty(BSTNode &root, int level, int indent_space, ostream &out)
+template <typename Node>
+void print_pretty(Node &root, int level, int indent_space, std::ostream &out)
 {
     int h = root.node_height() + 1;
     int nodes_in_this_level = 1;
 
     // eq of the length of branch for each node of each level
     int branch_len =
-        2 * ((int)pow(2.0, h) - 1) - (3 - level) * (int)pow(2.0, h - 1);
+        2 * ((int)std::pow(2.0, h) - 1) -
+        (3 - level) * (int)std::pow(2.0, h - 1);
 
     // distance between left neighbor node's right arm and right neighbor
     // node's left arm
-    int node_space_len = 2 + (level + 1) * (int)pow(2.0, h);
+    int node_space_len = 2 + (level + 1) * (int)std::pow(2.0, h);
 
     // starting space to the first node to print of each level (for the left
     // most node of each level only)
     int start_len = branch_len + (3 - level) + indent_space;
 
-    deque<BSTNode *> nodes_queue;
+    std::deque<Node *> nodes_queue;
     nodes_queue.push_back(&root);
     for (int r = 1; r < h; r++)
     {
@@ -134,7 +135,7 @@ void print_pretty(BSTNode &root, int level, int indent_space, ostream &out)
 
         for (int i = 0; i < nodes_in_this_level; i++)
         {
-            BSTNode *curr_node = nodes_queue.front();
+            Node *curr_node = nodes_queue.front();
             nodes_queue.pop_front();
             if (curr_node && !curr_node->is_empty())
             {